@@ -1,16 +1,28 @@
 #version 450
 
-layout (location=0) in vec3 fragColor;
+layout (location=0) in vec4 fragColor;
+layout (location=1) in vec3 fragNormal;
 
 layout (location=0) out vec4 outColor;
 
-layout (push_constant) uniform Push
-{
-    mat4 transform;
-    vec3 color;
-} push;
+// RenderSystem::ShaderFeatures, set when the pipeline is created. Disabled features are
+// compiled out; an alpha test left in the shader would cost early depth testing even unused
+layout (constant_id = 1) const bool LIGHTING      = false;
+layout (constant_id = 2) const bool ALPHA_TEST    = false;
+layout (constant_id = 3) const float ALPHA_CUTOFF = 0.5f;
+
+// A fixed light from above, in world space where -y is up
+const vec3 LIGHT_DIRECTION = normalize(vec3(1.0f, -3.0f, -1.0f));
+const float AMBIENT        = 0.2f;
 
 void main()
 {
-    outColor = vec4(fragColor, 1.0f);
+    if (ALPHA_TEST && fragColor.a < ALPHA_CUTOFF)
+        discard;
+
+    vec3 color = fragColor.rgb;
+    if (LIGHTING)
+        color *= AMBIENT + (1.0f - AMBIENT) * max(dot(normalize(fragNormal), LIGHT_DIRECTION), 0.0f);
+
+    outColor = vec4(color, 1.0f);
 }
\ No newline at end of file
@@ -1,18 +1,93 @@
 #version 450
 
+// Built twice by compile.bat: as is for Model::Vertex, and with QUANTIZED defined for
+// Model::QuantizedVertex, whose attributes arrive as normalized integers
+#ifdef QUANTIZED
+layout (location=0) in vec4 position;  // Steps across the model bounds, w unused
+layout (location=1) in vec4 color;
+layout (location=2) in vec2 normal;    // Octahedral
+layout (location=3) in vec2 uv;
+#else
 layout (location=0) in vec3 position;
 layout (location=1) in vec3 color;
+layout (location=2) in vec3 normal;
+layout (location=3) in vec2 uv;
+#endif
 
-layout (location=0) out vec3 fragColor;
+layout (location=0) out vec4 fragColor;
+layout (location=1) out vec3 fragNormal;  // World space
+layout (location=2) out vec2 fragUv;
 
-layout (push_constant) uniform Push
+// RenderSystem::ShaderFeatures, set when the pipeline is created; off colors by the object instead
+layout (constant_id = 0) const bool VERTEX_COLOR = true;
+
+// RenderSystem::CameraData, per frame
+layout (set=0, binding=0) uniform CameraData
+{
+    mat4 projection;
+    mat4 view;
+    mat4 projectionView;
+} camera;
+
+// RenderSystem::ObjectData, indexed by instance; firstInstance places each draw's objects
+struct ObjectData
 {
     mat4 transform;
-    vec3 color;
+    vec4 color;
+    vec4 decodeScale;
+};
+
+layout (std430, set=0, binding=1) readonly buffer ObjectBuffer
+{
+    ObjectData objects[];
+} objectBuffer;
+
+layout (push_constant) uniform Push
+{
+    vec3 positionOffset;
+    vec3 positionScale;
 } push;
 
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 n  = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = max(-n.z, 0.0f);
+    n.x    += n.x >= 0.0f ? -t : t;
+    n.y    += n.y >= 0.0f ? -t : t;
+
+    return normalize(n);
+}
+
+// Inverse transpose of the object's own matrix, without the quantized decode scale Cull.comp
+// folds into transform, which would skew normals. As the cofactor matrix, which is the same
+// up to a factor that Fragment.frag's normalize removes, with the sign kept for mirroring
+mat3 normalMatrix(ObjectData object)
+{
+    mat3 linear = mat3(object.transform);
+    linear[0]  /= object.decodeScale.x;
+    linear[1]  /= object.decodeScale.y;
+    linear[2]  /= object.decodeScale.z;
+
+    mat3 cofactor = mat3(cross(linear[1], linear[2]), cross(linear[2], linear[0]), cross(linear[0], linear[1]));
+    return dot(linear[0], cofactor[0]) < 0.0f ? -cofactor : cofactor;
+}
+
 void main()
 {
-    gl_Position = push.transform * vec4(position, 1.0f);
-    fragColor   = color;
+#ifdef QUANTIZED
+    vec3 objectPosition = push.positionOffset + position.xyz * push.positionScale;
+    vec3 objectNormal   = decodeOctahedral(normal);
+    float vertexAlpha   = color.a;
+#else
+    vec3 objectPosition = position;
+    vec3 objectNormal   = normal;
+    float vertexAlpha   = 1.0f;
+#endif
+
+    ObjectData object = objectBuffer.objects[gl_InstanceIndex];
+
+    gl_Position = camera.projectionView * (object.transform * vec4(objectPosition, 1.0f));
+    fragColor   = VERTEX_COLOR ? vec4(color.rgb, vertexAlpha * object.color.a) : object.color;
+    fragNormal  = normalMatrix(object) * objectNormal;
+    fragUv      = uv;
 }
\ No newline at end of file
@@ -1,2 +1,5 @@
 C:\VulkanSDK\1.2.176.1\Bin\glslc.exe Assets\Shaders\Vertex.vert -o Assets\Shaders\Vertex.vert.spv
-C:\VulkanSDK\1.2.176.1\Bin\glslc.exe Assets\Shaders\Fragment.frag -o Assets\Shaders\Fragment.frag.spv
\ No newline at end of file
+C:\VulkanSDK\1.2.176.1\Bin\glslc.exe -DQUANTIZED Assets\Shaders\Vertex.vert -o Assets\Shaders\VertexQuantized.vert.spv
+C:\VulkanSDK\1.2.176.1\Bin\glslc.exe Assets\Shaders\Fragment.frag -o Assets\Shaders\Fragment.frag.spv
+C:\VulkanSDK\1.2.176.1\Bin\glslc.exe Assets\Shaders\Cull.comp -o Assets\Shaders\Cull.comp.spv
+C:\VulkanSDK\1.2.176.1\Bin\glslc.exe Assets\Shaders\HiZ.comp -o Assets\Shaders\HiZ.comp.spv
\ No newline at end of file
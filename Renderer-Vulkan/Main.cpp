@@ -1,13 +1,174 @@
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <stdexcept>
 
 #include <Application.hpp>
+#include <LoaderBenchmark.hpp>
+#include <UploadCheck.hpp>
+#include <Objects/ObjectLoader.h>
 
-int main()
+// The argument after a flag that takes one, which must be there
+static std::string
+nextValue(int& i, int argc, char** argv)
 {
-    Application app = Application();
+    if (i + 1 >= argc)
+        throw std::runtime_error("Missing Value for " + std::string(argv[i]) + "!");
 
+    return argv[++i];
+}
+
+// Digits only, so signs, fractions and trailing characters are rejected rather than wrapped or dropped
+static uint32_t
+parsePositive(const std::string& flag, const std::string& value)
+{
+    uint64_t number = 0;
+    for (const char c : value)
+    {
+        if (c < '0' || c > '9')
+            throw std::runtime_error("Invalid Value for " + flag + ", Expected a Positive Integer: " + value + "!");
+
+        number = number * 10 + static_cast<uint64_t>(c - '0');
+        if (number > UINT32_MAX)
+            throw std::runtime_error("Value for " + flag + " is too Large: " + value + "!");
+    }
+
+    if (value.empty() || number == 0)
+        throw std::runtime_error("Invalid Value for " + flag + ", Expected a Positive Integer: " + value + "!");
+
+    return static_cast<uint32_t>(number);
+}
+
+int main(int argc, char** argv)
+{
+    Application::Scene scene                    = Application::Scene::Test;
+    Model::VertexFormat format                  = Model::VertexFormat::Quantized;
+    bool headless                               = false;
+    VkExtent2D extent                           = { Application::WIDTH, Application::HEIGHT };
+    uint32_t frames                             = 0;
+    std::string captureDirectory                = "";
+    FrameCapture::Format captureFormat          = FrameCapture::Format::Ppm;
+    std::string present                         = "";
+    bool benchmarkLoader                        = false;
+    std::string loaderPath                      = "";
+    uint32_t loaderMegabytes                    = LoaderBenchmark::DEFAULT_MEGABYTES;
+    bool checkParser                            = false;
+    bool checkUploads                           = false;
+    bool streamModels                           = false;
+    RenderSystem::ShaderFeatures shaderFeatures = { };
+
+    // Bad arguments throw too, so they are reported like any other error
     try
     {
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::string(argv[i]) == "--benchmark-lod")
+                scene = Application::Scene::LodBenchmark;
+            else if (std::string(argv[i]) == "--benchmark-instancing")
+                scene = Application::Scene::InstancingBenchmark;
+            else if (std::string(argv[i]) == "--benchmark-culling")
+                scene = Application::Scene::CullingBenchmark;
+            else if (std::string(argv[i]) == "--benchmark-shaders")
+                scene = Application::Scene::ShaderBenchmark;
+            else if (std::string(argv[i]) == "--benchmark-loader")
+            {
+                // An optional OBJ to parse, otherwise a synthetic one is generated
+                benchmarkLoader = true;
+                if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0)
+                    loaderPath = argv[++i];
+            }
+            else if (std::string(argv[i]) == "--loader-size")
+                loaderMegabytes = parsePositive("--loader-size", nextValue(i, argc, argv));
+            else if (std::string(argv[i]) == "--check-parser")
+                checkParser = true;
+            else if (std::string(argv[i]) == "--check-uploads")
+                checkUploads = true;
+            else if (std::string(argv[i]) == "--float-vertices")
+                format = Model::VertexFormat::Float;
+            else if (std::string(argv[i]) == "--no-vertex-color")
+                shaderFeatures.vertexColor = false;
+            else if (std::string(argv[i]) == "--lighting")
+                shaderFeatures.lighting = true;
+            else if (std::string(argv[i]) == "--alpha-test")
+                shaderFeatures.alphaTest = true;
+            else if (std::string(argv[i]) == "--stream")
+                streamModels = true;
+            else if (std::string(argv[i]) == "--headless")
+                headless = true;
+            else if (std::string(argv[i]) == "--size")
+            {
+                const std::string size = nextValue(i, argc, argv);
+                const size_t separator = size.find('x');
+                if (separator == std::string::npos)
+                    throw std::runtime_error("Invalid Size, Expected WIDTHxHEIGHT: " + size + "!");
+
+                extent.width  = parsePositive("--size", size.substr(0, separator));
+                extent.height = parsePositive("--size", size.substr(separator + 1));
+            }
+            else if (std::string(argv[i]) == "--frames")
+                frames = parsePositive("--frames", nextValue(i, argc, argv));
+            else if (std::string(argv[i]) == "--capture")
+                captureDirectory = nextValue(i, argc, argv);
+            else if (std::string(argv[i]) == "--capture-png")
+            {
+                captureDirectory = nextValue(i, argc, argv);
+                captureFormat    = FrameCapture::Format::Png;
+            }
+            else if (std::string(argv[i]) == "--present")
+                present = nextValue(i, argc, argv);
+            else
+                throw std::runtime_error("Unknown Argument: " + std::string(argv[i]) + "!");
+        }
+
+        // CPU only, so no window or device is created
+        if (benchmarkLoader)
+        {
+            LoaderBenchmark benchmark = LoaderBenchmark(loaderPath, loaderMegabytes);
+            benchmark.run();
+            benchmark.print(std::cout);
+            return benchmark.meshesMatch() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        // The SIMD real parser against the scalar one, best run under an address sanitizer
+        if (checkParser)
+        {
+            std::string report      = "";
+            const size_t mismatches = tinyobj::CheckRealParser("Assets/Scenes/Test.obj", &report);
+
+            std::cout << "Real parser check: " << mismatches << " mismatches" << std::endl << report;
+            return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        // Headless, so it runs on a software ICD such as lavapipe through VK_ICD_FILENAMES
+        if (checkUploads)
+        {
+            Window window = Window(extent.width, extent.height, "Renderer in Vulkan", true);
+            Device device = Device(window);
+
+            UploadCheck check = UploadCheck(device);
+            check.run();
+            check.print(std::cout);
+            return check.passed() ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        Application app = Application(scene, format, headless, extent, frames, streamModels);
+
+        app.setShaderFeatures(shaderFeatures);
+
+        if (!captureDirectory.empty())
+            app.captureFrames(captureDirectory, captureFormat);
+
+        if (present == "vsync")
+            app.setPresentProfile(SwapChain::PresentProfile::VSync);
+        else if (present == "adaptive")
+            app.setPresentProfile(SwapChain::PresentProfile::Adaptive);
+        else if (present == "low-latency")
+            app.setPresentProfile(SwapChain::PresentProfile::LowLatency);
+        else if (present == "uncapped")
+            app.setPresentProfile(SwapChain::PresentProfile::Uncapped);
+        else if (!present.empty())
+            throw std::runtime_error("Unknown Present Profile: " + present + "!");
+
         app.run();
     }
     catch (const std::exception& e)
@@ -1,33 +1,74 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
+#include <Benchmark.hpp>
 #include <Window.hpp>
 #include <Device.hpp>
+#include <Stats.hpp>
 #include <Objects/Object.hpp>
 #include <Rendering/Renderer.hpp>
+#include <Rendering/RenderSystem.hpp>
 
 class Application
 {
-private:
-    static constexpr uint32_t WIDTH    = 800;
-    static constexpr uint32_t HEIGHT   = 600;
+public:
+    enum class Scene
+    {
+        Test,
+        LodBenchmark,         // See LodBenchmark, prints its results and exits
+        InstancingBenchmark,  // See InstancingBenchmark, likewise
+        CullingBenchmark,     // See CullingBenchmark, likewise
+        ShaderBenchmark       // See ShaderBenchmark, likewise
+    };
 
-    Window window                      = Window(WIDTH, HEIGHT, "Renderer in Vulkan");
-    Device device                      = Device(window);
-    Renderer renderer                  = { window, device };
+    static constexpr uint32_t WIDTH             = 800;
+    static constexpr uint32_t HEIGHT            = 600;
+    static constexpr uint32_t HEADLESS_FRAMES   = 300;  // The test scene's frame limit headless, unless given one
+
+private:
+    Window window;
+    Device device                               = Device(window);
+    Renderer renderer                           = { window, device };
 
-    std::vector<Object> objects        = { };
+    const Scene scene                           = Scene::Test;
+    const Model::VertexFormat format            = Model::VertexFormat::Quantized;
+    const uint32_t frameLimit                   = 0;  // Frames to render before exiting, 0 runs until closed or a benchmark ends
+    const bool streamModels                     = false;  // Through ModelStreamer instead of the mesh cache
+    SwapChain::PresentProfile profile           = SwapChain::PresentProfile::VSync;  // Uncapped for benchmarks
+    RenderSystem::ShaderFeatures shaderFeatures = { };
+    std::vector<Object> objects                 = { };
+    StartupStats startupStats                   = { };
 
     void loadObjects();
 
+    // The scene's benchmark, over the loaded model; nullptr for the test scene
+    std::unique_ptr<Benchmark> createBenchmark() const;
+
 public:
-    Application();
+    // Headless renders offscreen at the extent without a display, see Device::isHeadless.
+    // Streamed models keep less in host memory, but are always float, uncached and one LOD
+    Application(Scene scene                = Scene::Test,
+                Model::VertexFormat format = Model::VertexFormat::Quantized,
+                bool headless              = false,
+                VkExtent2D extent          = { WIDTH, HEIGHT },
+                uint32_t frameLimit        = 0,
+                bool streamModels          = false);
     ~Application();
 
     // Delete copy constructor and copy operator
     Application(const Application&)            = delete;
     Application& operator=(const Application&) = delete;
 
+    // Writes every frame of run() to directory, see Renderer::startCapture
+    void captureFrames(const std::string& directory, FrameCapture::Format format);
+
+    // P cycles through the profiles while running
+    void setPresentProfile(SwapChain::PresentProfile profile);
+
+    // Before run(); L toggles lighting while running
+    void setShaderFeatures(const RenderSystem::ShaderFeatures& features) { this->shaderFeatures = features; }
+
     void run();
 };
\ No newline at end of file
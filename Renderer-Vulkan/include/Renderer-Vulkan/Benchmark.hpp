@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <Camera.hpp>
+#include <Stats.hpp>
+#include <Objects/Object.hpp>
+#include <Rendering/RenderSystem.hpp>
+
+// A scene Application runs in place of the test one. It lays out the objects, steps the
+// RenderSystem through what it measures, places the camera, and reports once every step is done
+class Benchmark
+{
+public:
+    virtual ~Benchmark() = default;
+
+    virtual void begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) = 0;
+
+    // Feed every recorded frame, with the current render pass; returns false once every step is measured
+    virtual bool update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) = 0;
+
+    virtual void setCamera(Camera& camera, float aspect) const = 0;
+    virtual void print(std::ostream& out) const = 0;
+};
\ No newline at end of file
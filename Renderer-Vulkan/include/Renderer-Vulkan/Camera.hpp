@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
@@ -19,4 +21,12 @@ public:
 
     const glm::mat4& getProjection() const;
     const glm::mat4& getView() const;
+
+    // Pixels covered by one world unit at view space depth, on a viewport viewportHeight pixels tall
+    float getPixelsPerUnit(float depth, float viewportHeight) const;
+    bool isPerspective() const { return this->projectionMatrix[2][3] != 0.0f; }
+
+    // World space planes of the view volume, normals pointing inside: left, right, top,
+    // bottom, near, far. A point p is inside all of them when dot(plane.xyz, p) + plane.w >= 0
+    std::array<glm::vec4, 6> getFrustumPlanes() const;
 };
\ No newline at end of file
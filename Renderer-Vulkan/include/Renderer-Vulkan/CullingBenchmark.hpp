@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <Benchmark.hpp>
+#include <Camera.hpp>
+#include <Model.hpp>
+#include <Stats.hpp>
+#include <Objects/Object.hpp>
+#include <Rendering/RenderSystem.hpp>
+
+// Frustum culling of a million copies of one model, half of them rotated, in a grid that
+// mostly lies outside the view. Measured once per instruction set FrustumCuller can run,
+// from scalar up to the widest the CPU has
+class CullingBenchmark : public Benchmark
+{
+public:
+    static constexpr uint32_t OBJECTS      = 1000000;
+    static constexpr float SPACING         = 1.5f;  // Between grid cells, each model scaled to fit one unit
+    static constexpr float WARMUP_SECONDS  = 1.0f;
+    static constexpr float MEASURE_SECONDS = 3.0f;
+
+    struct Step
+    {
+        FrustumCuller::InstructionSet instructionSet = FrustumCuller::InstructionSet::Scalar;
+        uint32_t frames                              = 0;
+        double seconds                               = 0.0;
+        double cullMilliseconds                      = 0.0;
+        double cpuMilliseconds                       = 0.0;
+        uint64_t visible                             = 0;
+        uint64_t culled                              = 0;
+    };
+
+private:
+    std::shared_ptr<Model> model = nullptr;
+    std::vector<Step> steps      = { };
+    Step current                 = { };
+    float elapsed                = 0.0f;
+
+    void layoutObjects(std::vector<Object>& objects) const;
+    void beginStep(FrustumCuller::InstructionSet instructionSet, RenderSystem& renderSystem);
+
+public:
+    CullingBenchmark(std::shared_ptr<Model> model);
+
+    // Delete copy constructor and copy operator
+    CullingBenchmark(const CullingBenchmark&)            = delete;
+    CullingBenchmark& operator=(const CullingBenchmark&) = delete;
+
+    void begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    // Feed every recorded frame; returns false once every step is measured
+    bool update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    void setCamera(Camera& camera, float aspect) const override;
+    void print(std::ostream& out) const override;
+};
\ No newline at end of file
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <window.hpp>
+#include <GeometryPool.hpp>
+#include <MemoryAllocator.hpp>
+#include <PipelineCache.hpp>
+#include <PipelineLibrary.hpp>
+#include <UploadManager.hpp>
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,9 +23,11 @@ struct QueueFamilyIndices
 {
     uint32_t graphicsFamily;
     uint32_t presentFamily;
+    uint32_t transferFamily;  // The graphics family when there is no dedicated one
     bool graphicsFamilyHasValue = false;
     bool presentFamilyHasValue  = false;
-    bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+    bool transferFamilyHasValue = false;
+    bool isComplete(bool present = true) { return graphicsFamilyHasValue && (presentFamilyHasValue || !present); }
 };
 
 class Device
@@ -42,28 +50,44 @@ public:
     Device(Device&&)                = delete;
     Device& operator=(Device&&)     = delete;
 
-    VkCommandPool getCommandPool() { return commandPool;    }
-    VkDevice device()              { return device_;        }
-    VkSurfaceKHR surface()         { return surface_;       }
-    VkQueue graphicsQueue()        { return graphicsQueue_; }
-    VkQueue presentQueue()         { return presentQueue_;  }
+    VkCommandPool getCommandPool() { return commandPool;     }
+    VkDevice device()              { return device_;         }
+    VkSurfaceKHR surface()         { return surface_;        }
+    VkQueue graphicsQueue()        { return graphicsQueue_;  }
+    VkQueue presentQueue()         { return presentQueue_;   }
+    VkQueue transferQueue()        { return transferQueue_;  }
+    MemoryAllocator& allocator()   { return *allocator_;     }
+    UploadManager& uploads()       { return *uploads_;       }
+    GeometryPool& geometry()       { return *geometry_;      }
+    PipelineCache& pipelineCache() { return *pipelineCache_; }
+    PipelineLibrary& pipelines()   { return *pipelines_;     }
+
+    // With a headless Window there is no surface, present queue or swap chain extension
+    bool isHeadless() const { return headless_; }
+
+    // multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount, all enabled when true
+    bool supportsDrawIndirectCount() const { return drawIndirectCount_; }
 
     SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
-    QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
+    QueueFamilyIndices findPhysicalQueueFamilies() const { return queueFamilies_; }  // Found once, at device creation
     VkFormat findSupportedFormat(
         const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
     // Buffer Helper Functions
+    // Memory comes from the device's MemoryAllocator; host visible memory is already mapped.
+    // Shared buffers are used by the graphics and transfer families without ownership transfers
     void createBuffer(
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkMemoryPropertyFlags properties,
         VkBuffer& buffer,
-        VkDeviceMemory& bufferMemory);
+        MemoryAllocation& bufferMemory,
+        bool sharedWithTransfer = false);
+    void destroyBuffer(VkBuffer buffer, MemoryAllocation& bufferMemory);
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
     void copyBufferToImage(
         VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
@@ -71,7 +95,8 @@ public:
         const VkImageCreateInfo& imageInfo,
         VkMemoryPropertyFlags properties,
         VkImage& image,
-        VkDeviceMemory& imageMemory);
+        MemoryAllocation& imageMemory);
+    void destroyImage(VkImage image, MemoryAllocation& imageMemory);
 
 private:
     void createInstance();
@@ -94,14 +119,25 @@ private:
     VkInstance instance                     = { };
     VkDebugUtilsMessengerEXT debugMessenger = { };
     VkPhysicalDevice physicalDevice         = VK_NULL_HANDLE;
+    QueueFamilyIndices queueFamilies_       = { };
     VkCommandPool commandPool               = { };
     Window& window;
+    const bool headless_                    = false;
 
     VkDevice device_       = { };
     VkSurfaceKHR surface_  = { };
     VkQueue graphicsQueue_ = { };
     VkQueue presentQueue_  = { };
+    VkQueue transferQueue_ = { };
+
+    bool drawIndirectCount_ = false;
+
+    std::unique_ptr<MemoryAllocator> allocator_   = nullptr;
+    std::unique_ptr<UploadManager> uploads_       = nullptr;
+    std::unique_ptr<GeometryPool> geometry_       = nullptr;
+    std::unique_ptr<PipelineCache> pipelineCache_ = nullptr;
+    std::unique_ptr<PipelineLibrary> pipelines_   = nullptr;
 
     const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
-    const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    std::vector<const char*> deviceExtensions       = { };
 };
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Device.hpp>
+#include <Stats.hpp>
+#include <WorkerPool.hpp>
+
+// Copies rendered frames into a ring of host visible buffers, one per frame in flight, and
+// writes them out as image files on a thread of its own. A buffer is only read once the
+// frame's fence has signalled, so the render thread never waits on the GPU for a capture.
+// The writer takes frames in order; once it is a whole ring behind, recording waits for it
+class FrameCapture
+{
+public:
+    enum class Format
+    {
+        Ppm,  // Binary P6
+        Png   // 8 bit RGB, stored without compression
+    };
+
+private:
+    struct Readback
+    {
+        VkBuffer buffer           = nullptr;
+        MemoryAllocation memory   = { };
+        VkDeviceSize capacity     = 0;
+        VkDeviceSize size         = 0;  // Of the copy in flight
+        VkExtent2D extent         = { };
+        VkFormat format           = VK_FORMAT_UNDEFINED;
+        uint64_t frame            = 0;
+        bool pending              = false;  // Copy recorded, not yet handed to the writer
+        std::future<void> release = { };  // Ready once the writer has copied the pixels out
+    };
+
+    Device& device;
+    const std::string directory          = "";
+    const Format format                  = Format::Ppm;
+    std::vector<Readback> readbacks      = { };
+    std::deque<std::future<void>> writes = { };
+    uint64_t frameCount                  = 0;
+    CaptureStats stats                   = { };
+    mutable std::mutex mutex             = { };  // Over stats, which the writer updates too
+    WorkerPool writer                    = WorkerPool(2);  // Caller plus one thread
+
+    void reserve(Readback& readback, VkDeviceSize size);
+    void write(const std::vector<uint8_t>& pixels, VkExtent2D extent, VkFormat format, uint64_t frame);
+
+public:
+    FrameCapture(Device& device, const std::string& directory, Format format, uint32_t framesInFlight);
+
+    // Finishes, reporting rather than throwing what a write threw
+    ~FrameCapture();
+
+    // Delete copy constructor and copy operator
+    FrameCapture(const FrameCapture&)            = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Records a copy of image, left in layout by the render pass, into frameIndex's buffer.
+    // image needs VK_IMAGE_USAGE_TRANSFER_SRC_BIT and is handed back in layout
+    void record(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImage image, VkImageLayout layout, VkFormat format, VkExtent2D extent);
+
+    // Once frameIndex's fence has signalled, hands its last copy to the writer. Rethrows what
+    // a finished write threw
+    void collect(uint32_t frameIndex);
+
+    // Waits for the device, then writes out every frame still in flight. Rethrows what a
+    // write threw
+    void finish();
+
+    CaptureStats getStats() const;
+};
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <MemoryAllocator.hpp>
+#include <Stats.hpp>
+#include <UploadManager.hpp>
+
+class Device;
+
+// Every Model's vertices and indices live in a few large shared buffers: one vertex buffer per
+// vertex stride and a single index buffer. A model is a range of each, drawn with its
+// vertexOffset and firstIndex, so a whole scene of one vertex format needs a single bind.
+//
+// Free ranges merge with their neighbours. When no free range fits but the free space would,
+// the buffer is compacted: live ranges are copied packed into a new buffer, growing it when
+// needed, and the ranges move with them. Handles stay valid, so always look ranges up again
+// instead of keeping offsets around. Buffers are shared with the transfer queue family, so
+// ranges change hands without ownership transfers
+class GeometryPool
+{
+public:
+    using Handle = uint32_t;
+
+    static constexpr Handle INVALID_HANDLE     = UINT32_MAX;
+    static constexpr uint32_t INITIAL_VERTICES = 64 * 1024;
+    static constexpr uint32_t INITIAL_INDICES  = 256 * 1024;
+
+    struct Range
+    {
+        uint32_t vertexArena  = 0;
+        uint32_t vertexOffset = 0;
+        uint32_t vertexCount  = 0;
+        uint32_t firstIndex   = 0;
+        uint32_t indexCount   = 0;
+        bool live             = false;
+    };
+
+private:
+    // One shared buffer, allocated in elements of stride bytes
+    struct Arena
+    {
+        VkDeviceSize stride                     = 0;
+        VkBufferUsageFlags usage                = 0;
+        VkBuffer buffer                         = nullptr;
+        MemoryAllocation memory                 = { };
+        uint32_t capacity                       = 0;
+        uint32_t used                           = 0;
+        std::map<uint32_t, uint32_t> freeRanges = { };  // Offset to count, never adjacent
+
+        bool allocate(uint32_t count, uint32_t& offset);
+        void free(uint32_t offset, uint32_t count);
+    };
+
+    Device& device;
+    std::vector<Arena> vertexArenas = { };
+    Arena indexArena                = { };
+    std::vector<Range> ranges       = { };
+    std::vector<Handle> spare       = { };  // Free slots of ranges
+    uint32_t compactions            = 0;
+
+    uint32_t vertexArenaFor(VkDeviceSize stride);
+
+    // Allocates count elements from arena, compacting or growing it when they do not fit
+    uint32_t allocateFrom(Arena& arena, uint32_t count, uint32_t Range::* offset, uint32_t Range::* rangeCount, uint32_t vertexArena);
+
+    // Moves every live range of arena into a new, packed buffer of capacity elements
+    void rebuild(Arena& arena, uint32_t capacity, uint32_t Range::* offset, uint32_t Range::* count, uint32_t vertexArena);
+
+public:
+    GeometryPool(Device& device);
+    ~GeometryPool();
+
+    // Delete copy constructor and copy operator
+    GeometryPool(const GeometryPool&)            = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    Handle allocate(VkDeviceSize vertexStride, uint32_t vertexCount, uint32_t indexCount);
+
+    // Like destroying a buffer, only once no frame in flight draws from the range
+    void free(Handle handle);
+
+    const Range& getRange(Handle handle) const { return this->ranges[handle]; }
+
+    // Indices are relative to the range's vertices, as vertexOffset is added when drawing
+    UploadTicket uploadVertices(Handle handle, const void* vertices);
+    UploadTicket uploadVertices(Handle handle, const UploadManager::Fill& fill);  // Pieces hold whole vertices
+    UploadTicket uploadIndices(Handle handle, const uint32_t* indices);
+
+    VkBuffer getVertexBuffer(Handle handle) const { return this->vertexArenas[this->ranges[handle].vertexArena].buffer; }
+    VkBuffer getIndexBuffer() const { return this->indexArena.buffer; }
+
+    // Binds the shared buffers handle's range lives in
+    void bind(VkCommandBuffer commandBuffer, Handle handle) const;
+
+    GeometryStats getStats() const;
+};
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Benchmark.hpp>
+#include <Camera.hpp>
+#include <Model.hpp>
+#include <Stats.hpp>
+#include <Objects/Object.hpp>
+#include <Rendering/RenderSystem.hpp>
+
+// CPU frame time of a large grid of copies of one model, drawn with a draw call per object,
+// first recorded on the main thread and then split across worker threads, with one instanced
+// draw per LOD and, where the device supports it, GPU-driven: culled and given LODs by a
+// compute pass and drawn with one indirect draw, then with occlusion culling on top. Every step
+// selects LODs, so they differ only in how the draws are issued
+class InstancingBenchmark : public Benchmark
+{
+public:
+    static constexpr uint32_t OBJECTS      = 100000;
+    static constexpr float SPACING         = 1.5f;  // Between grid cells, each model scaled to fit one unit
+    static constexpr float WARMUP_SECONDS  = 1.0f;
+    static constexpr float MEASURE_SECONDS = 3.0f;
+
+    struct Step
+    {
+        RenderSystem::DrawPath drawPath = RenderSystem::DrawPath::PerObject;
+        bool parallel                   = false;  // Recorded with RenderSystem::setParallelRecording
+        bool occlusion                  = false;  // With RenderSystem::setOcclusionCulling
+        uint32_t recordingThreads       = 1;
+        uint32_t frames                 = 0;
+        double seconds                  = 0.0;
+        double cpuMilliseconds          = 0.0;  // In RenderSystem::cullObjects and renderObjects
+        uint64_t drawCalls              = 0;
+        uint64_t bindsAvoided           = 0;
+        uint64_t occluded               = 0;
+        uint64_t triangles              = 0;  // Unknown to the CPU GPU-driven
+    };
+
+private:
+    std::shared_ptr<Model> model = nullptr;
+    std::vector<Step> steps      = { };
+    Step current                 = { };
+    float elapsed                = 0.0f;
+    bool gpuDrivenSkipped        = false;  // Device lacks drawIndirectCount
+
+    void layoutObjects(std::vector<Object>& objects) const;
+    void beginStep(RenderSystem::DrawPath drawPath, bool parallel, bool occlusion, RenderSystem& renderSystem);
+
+    static std::string stepName(const Step& step);
+
+public:
+    InstancingBenchmark(std::shared_ptr<Model> model);
+
+    // Delete copy constructor and copy operator
+    InstancingBenchmark(const InstancingBenchmark&)            = delete;
+    InstancingBenchmark& operator=(const InstancingBenchmark&) = delete;
+
+    void begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    // Feed every recorded frame; returns false once every step is measured
+    bool update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    void setCamera(Camera& camera, float aspect) const override;
+    void print(std::ostream& out) const override;
+};
\ No newline at end of file
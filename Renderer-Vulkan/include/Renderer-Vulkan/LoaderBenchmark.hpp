@@ -0,0 +1,55 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Model.hpp>
+
+// OBJ parse time of tinyobj::LoadObj against tinyobj::LoadObjMapped, on the CPU only and
+// without Model::Builder's welding. Either runs on a given file, or on a synthetic grid mesh
+// of a given size written for the run, large enough for LoadObjMapped to split it over its
+// threads. The loaders take turns every run so both see the same page cache, and must parse
+// the same attributes and indices
+class LoaderBenchmark
+{
+public:
+    static constexpr uint32_t RUNS               = 5;
+    static constexpr uint32_t DEFAULT_MEGABYTES  = 256;
+    static constexpr uint32_t MAPPED_CHUNK_BYTES = 1 << 20;  // LoadObjMapped's smallest chunk
+
+    struct Result
+    {
+        Model::Builder::LoaderMode mode = Model::Builder::LoaderMode::Mapped;
+        double bestMilliseconds         = 0.0;
+        double meanMilliseconds         = 0.0;
+        size_t vertices                 = 0;  // Positions, as parsed
+        size_t indices                  = 0;
+    };
+
+private:
+    std::string filePath        = "";
+    const uint32_t megabytes    = 0;
+    bool generated              = false;  // filePath was written for the run, and is removed after it
+    uint64_t fileBytes          = 0;
+    uint32_t threads            = 1;
+    std::vector<Result> results = { };
+    bool identical              = true;
+
+    // A grid of about megabytes MiB with positions, normals, texture coordinates and triangles
+    void generate();
+
+public:
+    // An empty filePath generates a synthetic mesh of megabytes MiB instead
+    LoaderBenchmark(const std::string& filePath, uint32_t megabytes = DEFAULT_MEGABYTES);
+    ~LoaderBenchmark();
+
+    // Delete copy constructor and copy operator
+    LoaderBenchmark(const LoaderBenchmark&)            = delete;
+    LoaderBenchmark& operator=(const LoaderBenchmark&) = delete;
+
+    void run();
+
+    bool meshesMatch() const { return this->identical; }
+    void print(std::ostream& out) const;
+};
\ No newline at end of file
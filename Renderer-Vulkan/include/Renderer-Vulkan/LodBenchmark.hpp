@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include <Benchmark.hpp>
+#include <Camera.hpp>
+#include <Model.hpp>
+#include <Stats.hpp>
+#include <Objects/Object.hpp>
+#include <Rendering/RenderSystem.hpp>
+
+// Triangle throughput as the object count grows. A grid of copies of one model, stretching
+// away from a fixed camera, doubles in size every step; each size is measured once with
+// LOD selection and once at full detail
+class LodBenchmark : public Benchmark
+{
+public:
+    static constexpr uint32_t MAX_OBJECTS  = 4096;
+    static constexpr float SPACING         = 1.5f;  // Between grid cells, each model scaled to fit one unit
+    static constexpr float WARMUP_SECONDS  = 0.5f;
+    static constexpr float MEASURE_SECONDS = 2.0f;
+
+    struct Step
+    {
+        uint32_t objects             = 0;
+        bool lodSelection            = true;
+        uint32_t frames              = 0;
+        double seconds               = 0.0;
+        uint64_t triangles           = 0;
+        uint64_t fullDetailTriangles = 0;
+    };
+
+private:
+    std::shared_ptr<Model> model = nullptr;
+    std::vector<Step> steps      = { };
+    Step current                 = { };
+    float elapsed                = 0.0f;
+
+    void layoutObjects(std::vector<Object>& objects) const;
+
+public:
+    LodBenchmark(std::shared_ptr<Model> model);
+
+    // Delete copy constructor and copy operator
+    LodBenchmark(const LodBenchmark&)            = delete;
+    LodBenchmark& operator=(const LodBenchmark&) = delete;
+
+    void begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    // Feed every recorded frame; returns false once every step is measured
+    bool update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    void setCamera(Camera& camera, float aspect) const override;
+    void print(std::ostream& out) const override;
+};
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+private:
+    const char* data_ = nullptr;
+    size_t size_      = 0;
+
+#ifdef _WIN32
+    void* file        = nullptr;
+    void* mapping     = nullptr;
+#else
+    int fd            = -1;
+#endif
+
+public:
+    MappedFile(const std::string& filePath);
+    ~MappedFile();
+
+    // Delete copy constructor and copy operator
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return this->data_; }
+    size_t size() const      { return this->size_; }
+};
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <Stats.hpp>
+
+// A range of device memory handed out by MemoryAllocator
+struct MemoryAllocation
+{
+    VkDeviceMemory memory = nullptr;
+    VkDeviceSize offset   = 0;
+    VkDeviceSize size     = 0;
+    void* mapped          = nullptr;  // Set for host visible memory, which stays mapped
+
+    // Where it came from, for MemoryAllocator::free
+    uint32_t pool         = 0;
+    uint32_t block        = 0;
+    uint32_t node         = 0;
+    bool dedicated        = false;
+};
+
+// Sub-allocates buffers and images from large VkDeviceMemory blocks, one pool of blocks per
+// memory type, with a TLSF (two-level segregated fit) allocator inside each block. Requests
+// above half the preferred block size get a dedicated allocation instead.
+//
+// Linear resources (buffers) and optimal tiled images never share a block when the device
+// reports a bufferImageGranularity above 1, so the granularity never has to be padded for.
+// Host visible blocks are mapped once for their whole lifetime.
+class MemoryAllocator
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+    enum class Tiling
+    {
+        Linear,  // Buffers and linear images
+        Optimal
+    };
+
+private:
+    // Free lists: first level by power of two, second level splits each into SL_COUNT ranges.
+    // Sizes below SMALL_SIZE share the first level in SL_COUNT equal steps
+    static constexpr uint32_t SL_BITS         = 4;
+    static constexpr uint32_t SL_COUNT        = 1u << SL_BITS;
+    static constexpr uint32_t SMALL_SIZE_LOG2 = 8;
+    static constexpr VkDeviceSize SMALL_SIZE  = VkDeviceSize(1) << SMALL_SIZE_LOG2;
+    static constexpr uint32_t FL_COUNT        = 64 - SMALL_SIZE_LOG2 + 1;
+    static constexpr VkDeviceSize MIN_ALIGN   = 16;
+    static constexpr uint32_t NONE            = UINT32_MAX;
+
+    // Free or used range of a block, linked to its physical neighbours and, when free, to
+    // the other free nodes of its size class
+    struct Node
+    {
+        VkDeviceSize offset = 0;
+        VkDeviceSize size   = 0;
+        uint32_t prev       = NONE;
+        uint32_t next       = NONE;
+        uint32_t prevFree   = NONE;
+        uint32_t nextFree   = NONE;
+        bool free           = false;
+    };
+
+    class Tlsf
+    {
+    private:
+        std::vector<Node> nodes            = { };
+        std::vector<uint32_t> spare        = { };  // Unused slots of nodes
+        uint64_t flBitmap                  = 0;
+        uint32_t slBitmap[FL_COUNT]        = { };
+        uint32_t heads[FL_COUNT][SL_COUNT] = { };  // Filled with NONE on construction
+        VkDeviceSize used                  = 0;
+
+        static void mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl);
+
+        uint32_t createNode();
+        void insertFree(uint32_t node);
+        void removeFree(uint32_t node);
+        uint32_t findFree(VkDeviceSize size) const;  // Of a size from searchSize
+
+        // Splits size bytes off the front of node; the remainder becomes a new free node
+        void split(uint32_t node, VkDeviceSize size);
+
+    public:
+        Tlsf(VkDeviceSize size);
+
+        // What allocate looks up for a request: padded for its alignment and rounded up to
+        // the start of the next size class. A block at least this large always fits it
+        static VkDeviceSize searchSize(VkDeviceSize size, VkDeviceSize alignment);
+
+        // Returns the node now covering [offset, offset + size), or NONE if it does not fit
+        uint32_t allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+        void free(uint32_t node);
+
+        VkDeviceSize usedBytes() const { return this->used; }
+        bool empty() const { return this->used == 0; }
+    };
+
+    struct Block
+    {
+        VkDeviceMemory memory = nullptr;
+        VkDeviceSize size     = 0;
+        char* mapped          = nullptr;
+        Tlsf tlsf;
+
+        Block(VkDeviceSize size) : size(size), tlsf(size) { }
+    };
+
+    struct Pool
+    {
+        uint32_t memoryType         = 0;
+        std::vector<Block> blocks   = { };  // Freed blocks stay as null memory so indices hold
+        uint32_t dedicatedCount     = 0;
+        VkDeviceSize dedicatedBytes = 0;
+    };
+
+    VkDevice device                                   = nullptr;
+    VkPhysicalDeviceMemoryProperties memoryProperties = { };
+    VkDeviceSize bufferImageGranularity               = 1;
+    uint32_t maxAllocationCount                       = 0;
+    VkDeviceSize preferredBlockSize                   = DEFAULT_BLOCK_SIZE;
+
+    std::mutex mutex                                  = { };
+    std::vector<Pool> pools                           = { };  // Two per memory type, by Tiling
+    uint32_t allocationCount                          = 0;  // Live vkAllocateMemory results
+    uint64_t allocateCalls                            = 0;
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    uint32_t poolIndex(uint32_t memoryType, Tiling tiling) const;
+    VkDeviceSize largestBlockSize(uint32_t memoryType) const;
+    VkDeviceSize blockSizeFor(const Pool& pool, VkDeviceSize size) const;
+
+    VkDeviceMemory allocateMemory(uint32_t memoryType, VkDeviceSize size, char** mapped);
+    void freeMemory(VkDeviceMemory memory, bool mapped);
+
+public:
+    MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE);
+    ~MemoryAllocator();
+
+    // Delete copy constructor and copy operator
+    MemoryAllocator(const MemoryAllocator&)            = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+    MemoryAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, Tiling tiling);
+    void free(MemoryAllocation& allocation);
+
+    MemoryStats getStats();
+};
\ No newline at end of file
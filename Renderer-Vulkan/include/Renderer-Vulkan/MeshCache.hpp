@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <MappedFile.hpp>
+#include <Model.hpp>
+
+// On-disk cache of cooked meshes (the final Model::Vertex and index arrays and LOD ranges),
+// keyed by a content hash of the source .obj and the .mtl files it references
+class MeshCache
+{
+public:
+    // Bump whenever the file layout or the output of Model::Builder changes
+    static constexpr uint32_t VERSION = 3;
+
+    // Every section starts on this boundary, so the mapped data can be read in place
+    static constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+    struct Header
+    {
+        char magic[4]         = { 'R', 'V', 'M', 'C' };
+        uint32_t version      = VERSION;
+        uint64_t sourceHash   = 0;
+        uint32_t vertexStride = sizeof(Model::Vertex);
+        uint32_t vertexCount  = 0;
+        uint32_t indexCount   = 0;
+        uint32_t lodCount     = 0;
+        Model::Bounds bounds  = { };
+        uint64_t vertexOffset = 0;
+        uint64_t indexOffset  = 0;
+        uint64_t lodOffset    = 0;
+    };
+
+    // A validated cache file, mapped for as long as the entry lives
+    class Entry
+    {
+    private:
+        MappedFile file;
+        Model::MeshData mesh_ = { };
+
+    public:
+        Entry(const std::string& filePath, uint64_t sourceHash);
+
+        // Delete copy constructor and copy operator
+        Entry(const Entry&)            = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        const Model::MeshData& mesh() const { return this->mesh_; }
+    };
+
+private:
+    const std::string directory = "";
+
+    std::string entryPath(uint64_t sourceHash) const;
+
+public:
+    MeshCache(const std::string& directory = "Cache/Meshes");
+
+    uint64_t hashSource(const std::string& filePath) const;
+    std::unique_ptr<Entry> load(uint64_t sourceHash) const;
+    bool store(uint64_t sourceHash, const Model::Builder& builder) const;
+};
\ No newline at end of file
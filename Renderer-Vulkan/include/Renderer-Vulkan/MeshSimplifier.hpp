@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Model.hpp>
+
+// Quadric error metric edge collapse (Garland & Heckbert) for Model::Builder LODs.
+// Only index lists change: every collapse moves a vertex onto a neighbour's position,
+// so each LOD indexes into the same vertex array as the full detail mesh.
+//
+// Collapses work on positions rather than welded vertices, since flat shaded meshes
+// split every corner by normal. A corner whose position moves takes the vertex at the
+// new position with the nearest attributes. Positions on a color seam, on a non-manifold
+// edge or where open borders meet are never moved, and border vertices only slide
+// along their border
+class MeshSimplifier
+{
+private:
+    // Symmetric 4x4 plane quadric, plus the summed weight so the error reads as a distance
+    struct Quadric
+    {
+        double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+        double b2 = 0.0, bc = 0.0, bd = 0.0;
+        double c2 = 0.0, cd = 0.0;
+        double d2 = 0.0;
+        double weight = 0.0;
+
+        static Quadric fromPlane(const glm::vec3& normal, float distance, double weight);
+
+        Quadric& operator+=(const Quadric& other);
+        double evaluate(const glm::vec3& point) const;
+    };
+
+    enum class Kind : uint8_t
+    {
+        Interior,
+        Border,
+        Locked
+    };
+
+    struct Collapse
+    {
+        uint32_t from = 0;
+        uint32_t to   = 0;
+        float error   = 0.0f;
+    };
+
+    const std::vector<Model::Vertex>& vertices;
+
+    // Welded vertices sharing a position, grouped by position id
+    std::vector<uint32_t> positionOf  = { };
+    std::vector<uint32_t> wedgeBase   = { };
+    std::vector<uint32_t> wedges      = { };
+    std::vector<bool> colorSeam       = { };
+
+    std::vector<Quadric> quadrics     = { };
+    std::vector<uint32_t> collapsedTo = { };
+    std::vector<uint32_t> indices_    = { };
+    float error_                      = 0.0f;
+
+    const glm::vec3& position(uint32_t positionId) const;
+    float collapseError(uint32_t from, uint32_t to) const;
+    uint32_t nearestWedge(uint32_t vertex, uint32_t positionId) const;
+
+    void groupPositions();
+    void computeQuadrics();
+
+    // One round of non-overlapping collapses, cheapest first; returns the triangles removed
+    size_t collapsePass(size_t targetTriangles, float maxError);
+
+public:
+    // indices is the full detail triangle list to start from, into vertices
+    MeshSimplifier(const std::vector<Model::Vertex>& vertices, const uint32_t* indices, size_t indexCount);
+
+    // Delete copy constructor and copy operator
+    MeshSimplifier(const MeshSimplifier&)            = delete;
+    MeshSimplifier& operator=(const MeshSimplifier&) = delete;
+
+    // Continues collapsing until at most targetIndexCount indices remain, or until
+    // no collapse is possible within maxError (in model units)
+    void simplify(size_t targetIndexCount, float maxError);
+
+    const std::vector<uint32_t>& indices() const { return this->indices_; }
+
+    // Largest geometric error introduced so far, in model units
+    float error() const { return this->error_; }
+};
\ No newline at end of file
@@ -7,20 +7,39 @@
 #include <glm/glm.hpp>
 
 #include <Device.hpp>
+#include <Stats.hpp>
 
 class Model
 {
 private:
     Device& device;
-    VkBuffer vertexBuffer              = nullptr;
-    VkBuffer indexBuffer               = nullptr;
-    VkDeviceMemory vertexBufferMemory  = nullptr;
-    VkDeviceMemory indexBufferMemory   = nullptr;
-    uint32_t vertexCount               = 0;
-    uint32_t indexCount                = 0;
-    bool hasIndexBuffer                = false;
+    GeometryPool::Handle geometry = GeometryPool::INVALID_HANDLE;  // Range of the device's shared buffers
+    uint32_t vertexCount          = 0;
+    uint32_t indexCount           = 0;
+    UploadTicket uploadTicket     = 0;  // Covers vertices and indices
 
 public:
+    // Layout of the vertex buffer, picked per model when it is created
+    enum class VertexFormat
+    {
+        Float,     // Vertex, 44 bytes
+        Quantized  // QuantizedVertex, 20 bytes, decoded in Vertex.vert
+    };
+
+    struct Bounds
+    {
+        glm::vec3 min = glm::vec3();
+        glm::vec3 max = glm::vec3();
+    };
+
+    // Centered on the bounds and reaching the farthest vertex, so never larger than the
+    // sphere around the bounds themselves
+    struct Sphere
+    {
+        glm::vec3 center = glm::vec3();
+        float radius     = 0.0f;
+    };
+
     struct Vertex
     {
         glm::vec3 position = glm::vec3();
@@ -40,27 +59,136 @@ public:
         }
     };
 
+    // Packed Vertex: position in 16-bit steps across the model bounds, octahedral normal,
+    // half float uv and 8-bit color. Read as UNORM, position decodes to
+    // bounds.min + position * (bounds.max - bounds.min)
+    struct QuantizedVertex
+    {
+        uint16_t position[4] = { };  // w is padding
+        uint8_t color[4]     = { };
+        int16_t normal[2]    = { };
+        uint16_t uv[2]       = { };
+
+        static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+
+        static QuantizedVertex quantize(const Vertex& vertex, const Bounds& bounds);
+    };
+
+    static constexpr uint32_t MAX_LODS = 8;
+
+    // Range of the index buffer drawn for one level of detail, finest first
+    struct Lod
+    {
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+        float error         = 0.0f;  // Geometric error against the full detail mesh, in model units
+    };
+
+    // Non-owning view of the final vertex and index arrays of a mesh
+    struct MeshData
+    {
+        const Vertex* vertices   = nullptr;
+        uint32_t vertexCount     = 0;
+        const uint32_t* indices  = nullptr;
+        uint32_t indexCount      = 0;
+        const Lod* lods          = nullptr;
+        uint32_t lodCount        = 0;  // None means a single range over every index
+        Bounds bounds            = { };
+    };
+
     struct Builder
     {
-        std::vector<Vertex> vertices  = { };
-        std::vector<uint32_t> indices = { };
+        enum class LoaderMode
+        {
+            Stream,  // tinyobj::LoadObj, single threaded std::ifstream
+            Mapped   // tinyobj::LoadObjMapped, memory-mapped and parsed on all cores
+        };
+
+        std::vector<Vertex> vertices       = { };
+        std::vector<uint32_t> indices      = { };
+        LoaderMode loaderMode              = LoaderMode::Mapped;
+        Bounds bounds                      = { };
+
+        // Reorder triangles for the post-transform cache and vertices for fetch locality
+        bool optimizeVertexCache           = true;
+        VertexCacheStats vertexCacheBefore = { };
+        VertexCacheStats vertexCacheAfter  = { };
+
+        // Simplified LODs appended to indices, each about half the triangles of the one before.
+        // lodErrorBudget caps the error of the coarsest, relative to the bounds diagonal
+        bool generateLods                  = true;
+        float lodErrorBudget               = 0.02f;
+        std::vector<Lod> lods              = { };
 
         void loadModel(const std::string& filePath);
+        MeshData meshData() const;
+
+        void buildLodChain();
+
+        // Of LOD 0; the reorders below work on every LOD range
+        VertexCacheStats analyzeVertexCache() const;
+        void reorderForVertexCache();
+        void reorderForVertexFetch();
+
+        // Debug color given to the vertices of the objectNumber-th shape (1-based)
+        static glm::vec3 objectColor(int objectNumber);
     };
 
-    Model(Device& device, const Builder& builder);
+    // Per model switches for createModelFromFile. All but vertexFormat and loaderMode are part
+    // of the mesh cache key, since the cache holds float vertices and quantizing them is cheap,
+    // and both loaders build the same mesh. loaderMode only matters when the cache is cold
+    struct LoadOptions
+    {
+        bool optimizeVertexCache       = true;
+        bool generateLods              = true;
+        float lodErrorBudget           = 0.02f;
+        VertexFormat vertexFormat      = VertexFormat::Float;
+        Builder::LoaderMode loaderMode = Builder::LoaderMode::Mapped;
+
+        uint64_t hash(uint64_t seed) const;
+    };
+
+    Model(Device& device, const Builder& builder, VertexFormat vertexFormat = VertexFormat::Float);
+    Model(Device& device, const MeshData& mesh, VertexFormat vertexFormat = VertexFormat::Float);
     ~Model();
 
     // Delete copy constructor and copy operator
     Model(const Model&)            = delete;
     Model& operator=(const Model&) = delete;
 
-    static std::unique_ptr<Model> createModelFromFile(Device& device, const std::string& filePath);
+    static std::unique_ptr<Model> createModelFromFile(Device& device, const std::string& filePath, StartupStats* stats = nullptr);
+    static std::unique_ptr<Model> createModelFromFile(Device& device, const std::string& filePath, StartupStats* stats, const LoadOptions& options);
+
+    const Bounds& getBounds() const { return this->bounds; }
+    const Sphere& getBoundingSphere() const { return this->sphere; }
+    VertexFormat getVertexFormat() const { return this->vertexFormat; }
+    UploadTicket getUploadTicket() const { return this->uploadTicket; }
+    GeometryPool::Handle getGeometry() const { return this->geometry; }
+    VkDeviceSize getVertexStride() const;
+    VkDeviceSize getVertexBufferSize() const;
 
+    uint32_t getLodCount() const { return static_cast<uint32_t>(this->lods.size()); }
+    const Lod& getLod(uint32_t lod) const { return this->lods[lod]; }
+
+    // Coarsest LOD whose error is within maxError, in model units
+    uint32_t selectLod(float maxError) const;
+
+    // Binds the shared buffers of the geometry pool; models of the same vertex format share them
     void bind(const VkCommandBuffer& commandBuffer);
-    void draw(const VkCommandBuffer& commandBuffer);
+    void draw(const VkCommandBuffer& commandBuffer, uint32_t lod = 0, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
 
 private:
-    void createVertexBuffers(const std::vector<Vertex>& vertices);
-    void createIndexBuffer(const std::vector<uint32_t>& indices);
+    friend class ModelStreamer;
+
+    Bounds bounds             = { };
+    Sphere sphere             = { };
+    VertexFormat vertexFormat = VertexFormat::Float;
+    std::vector<Lod> lods     = { };
+
+    // Geometry is filled in by ModelStreamer
+    Model(Device& device, const Bounds& bounds);
+
+    void uploadVertices(const Vertex* vertices);
+    void uploadIndices(const uint32_t* indices);
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Objects/ObjectLoader.h>
+
+#include <Device.hpp>
+#include <Model.hpp>
+#include <Stats.hpp>
+#include <VertexWelder.hpp>
+
+// Builds a Model straight from an .obj through tinyobj::LoadObjWithCallback. Welded
+// vertices and indices are staged in fixed-size host chunks and uploaded whenever a
+// chunk fills, so neither tinyobj's shapes nor a full copy of the mesh is ever held
+// in host memory. Only the source attributes and the weld table grow with the file.
+//
+// Corners are welded by (v, vn, vt) alone, so unlike Model::Builder two corners with
+// equal values under different indices are not merged, polygons are fanned, vertices
+// stay Model::VertexFormat::Float and only the full detail LOD is built. Once parsed,
+// the geometry is copied into the device's GeometryPool like every other Model
+class ModelStreamer
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_HOST_BUDGET = 16 * 1024 * 1024;
+
+private:
+    // Device-local buffer fed from a host chunk through the device's UploadManager, grown
+    // by doubling with a device-side copy when an upload no longer fits
+    class ChunkedUpload
+    {
+    private:
+        Device& device;
+        const VkBufferUsageFlags usage = 0;
+        const VkDeviceSize chunkSize   = 0;
+        std::vector<char> staging      = { };
+        VkDeviceSize staged            = 0;
+        VkBuffer buffer                = nullptr;
+        MemoryAllocation bufferMemory  = { };
+        VkDeviceSize capacity          = 0;
+        VkDeviceSize uploaded          = 0;
+        UploadTicket ticket            = 0;  // Of the last write to buffer
+
+        void reserve(VkDeviceSize size);
+
+        // Copies the contents into a new buffer of the given size, replacing the old one
+        void resize(VkDeviceSize size);
+
+    public:
+        ChunkedUpload(Device& device, VkBufferUsageFlags usage, VkDeviceSize chunkSize);
+        ~ChunkedUpload();
+
+        // Delete copy constructor and copy operator
+        ChunkedUpload(const ChunkedUpload&)            = delete;
+        ChunkedUpload& operator=(const ChunkedUpload&) = delete;
+
+        void append(const void* data, VkDeviceSize size);
+        void flush();
+
+        // Flushes and copies the contents into dst on the device, returning the ticket the
+        // copy completes with. The buffer stays alive until the copy is done
+        UploadTicket copyTo(VkBuffer dst, VkDeviceSize dstOffset);
+    };
+
+    Device& device;
+    const VkDeviceSize hostBudget = 0;
+
+    // Per load state, touched from the tinyobj callbacks
+    std::vector<tinyobj::real_t> positions      = { };
+    std::vector<tinyobj::real_t> normals        = { };
+    std::vector<tinyobj::real_t> texcoords      = { };
+    std::unique_ptr<VertexWelder> welder        = nullptr;
+    std::unique_ptr<ChunkedUpload> vertexUpload = nullptr;
+    std::unique_ptr<ChunkedUpload> indexUpload  = nullptr;
+    uint32_t vertexCount                        = 0;
+    uint32_t indexCount                         = 0;
+    int objectNumber                            = 1;
+    bool objectHasFaces                         = false;
+    Model::Bounds bounds                        = { };
+
+    static void vertexCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z, tinyobj::real_t w);
+    static void normalCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z);
+    static void texcoordCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z);
+    static void indexCallback(void* userData, tinyobj::index_t* indices, int indexCount);
+    static void groupCallback(void* userData, const char** names, int nameCount);
+    static void objectCallback(void* userData, const char* name);
+
+    void nextObject();
+    uint32_t emitCorner(const tinyobj::index_t& index);
+
+public:
+    // hostBudget caps the staging chunks, split evenly between vertices and indices
+    ModelStreamer(Device& device, VkDeviceSize hostBudget = DEFAULT_HOST_BUDGET);
+
+    // Delete copy constructor and copy operator
+    ModelStreamer(const ModelStreamer&)            = delete;
+    ModelStreamer& operator=(const ModelStreamer&) = delete;
+
+    std::unique_ptr<Model> load(const std::string& filePath, StartupStats* stats = nullptr);
+};
\ No newline at end of file
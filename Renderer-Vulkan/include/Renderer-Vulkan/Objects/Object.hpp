@@ -53,9 +53,10 @@ struct TransformComponent
 
 class Object
 {
-private:
+public:
     using id_t = unsigned long int;
-    
+
+private:
     const id_t id;
 
     Object(id_t objectID) : id(objectID) { }
@@ -76,5 +77,6 @@ public:
 
     std::shared_ptr<Model> model     = nullptr;
     glm::vec3 color                  = { };
+    float alpha                      = 1.0f;  // Only read by the alpha test variant
     TransformComponent transform     = { };
 };
\ No newline at end of file
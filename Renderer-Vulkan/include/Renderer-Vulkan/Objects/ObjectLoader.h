@@ -568,6 +568,27 @@ namespace tinyobj {
         MaterialReader* readMatFn = NULL, bool triangulate = true,
         bool default_vcols_fallback = true);
 
+    /// Loads .obj from a file like LoadObj(), but memory-maps the file and
+    /// parses `v`, `vn`, `vt` and `f` records of line-aligned chunks on
+    /// `num_threads` worker threads (0 = std::thread::hardware_concurrency()).
+    /// Every other statement is replayed in file order when the chunks are
+    /// merged, so `attrib`, `shapes` and `materials` are identical to the ones
+    /// LoadObj() produces for the same file.
+    bool LoadObjMapped(attrib_t* attrib, std::vector<shape_t>* shapes,
+        std::vector<material_t>* materials, std::string* warn,
+        std::string* err, const char* filename,
+        const char* mtl_basedir = NULL, bool triangulate = true,
+        bool default_vcols_fallback = true, unsigned int num_threads = 0);
+
+    /// Checks the SIMD real parser against the scalar one on generated and
+    /// edge case tokens, plus every number of the `v`, `vn` and `vt` records
+    /// of `filename` (when not NULL). Each token is parsed from the end of
+    /// its own exactly sized allocation, so an address sanitizer catches any
+    /// read past it. Returns the number of tokens the SIMD parser accepted
+    /// with a different value; they are listed in `report`. Always 0 when the
+    /// SIMD parser is not compiled in or the CPU lacks SSE4.1.
+    size_t CheckRealParser(const char* filename, std::string* report);
+
     /// Loads materials into std::map
     void LoadMtl(std::map<std::string, int>* material_map,
         std::vector<material_t>* materials, std::istream* inStream,
@@ -597,11 +618,42 @@ namespace tinyobj {
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <fstream>
 #include <limits>
 #include <sstream>
+#include <thread>
 #include <utility>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// SSE fast path for parsing reals, selected at runtime. Define
+// TINYOBJLOADER_NO_SIMD to always use the scalar parser.
+#if !defined(TINYOBJLOADER_NO_SIMD) &&                                  \
+    (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) ||      \
+     defined(__i386__))
+#define TINYOBJLOADER_SIMD_PARSER
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
 #ifdef TINYOBJLOADER_USE_MAPBOX_EARCUT
 
 #ifdef TINYOBJLOADER_DONOT_INCLUDE_MAPBOX_EARCUT
@@ -804,6 +856,12 @@ namespace tinyobj {
     //  - s >= s_end.
     //  - parse failure.
     //
+    // Scale of the n-th fractional digit. Shared by tryParseDouble and
+    // tryParseDoubleSse41, which must round identically.
+    static const double fraction_pow_lut[] = {
+        1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
+    };
+
     static bool tryParseDouble(const char* s, const char* s_end, double* result) {
         if (s >= s_end) {
             return false;
@@ -878,14 +936,13 @@ namespace tinyobj {
             read = 1;
             end_not_reached = (curr != s_end);
             while (end_not_reached && IS_DIGIT(*curr)) {
-                static const double pow_lut[] = {
-                    1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
-                };
-                const int lut_entries = sizeof pow_lut / sizeof pow_lut[0];
+                const int lut_entries =
+                    sizeof fraction_pow_lut / sizeof fraction_pow_lut[0];
 
                 // NOTE: Don't use powf here, it will absolutely murder precision.
                 mantissa += static_cast<int>(*curr - 0x30) *
-                    (read < lut_entries ? pow_lut[read] : std::pow(10.0, -read));
+                    (read < lut_entries ? fraction_pow_lut[read]
+                        : std::pow(10.0, -read));
                 read++;
                 curr++;
                 end_not_reached = (curr != s_end);
@@ -943,11 +1000,274 @@ namespace tinyobj {
         return false;
     }
 
+#ifdef TINYOBJLOADER_SIMD_PARSER
+#if defined(__GNUC__) || defined(__clang__)
+#define TINYOBJ_TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#else
+#define TINYOBJ_TARGET_SSE41
+#endif
+
+    // Checks for the SSSE3 and SSE4.1 instructions tryParseDoubleSse41 uses.
+    static bool cpuHasSse41() {
+#ifdef _MSC_VER
+        int info[4] = { 0, 0, 0, 0 };
+        __cpuid(info, 1);
+        const unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+#endif
+        return ((ecx & (1u << 9)) != 0) && ((ecx & (1u << 19)) != 0);
+    }
+
+    static const bool cpu_has_sse41 = cpuHasSse41();
+
+    static inline int countTrailingZeros(unsigned int x) {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward(&index, x);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+
+    // Fast path of tryParseDouble for the fixed-format decimals OBJ exporters
+    // write: [sign] , 1-15 digits , ["." , 0-7 digits], filling the whole
+    // token. The token is classified with SSE and its integer part converted
+    // in parallel. The fraction is then accumulated with exactly the
+    // operations tryParseDouble performs, so the result is bit-identical.
+    //
+    // Returns false without touching *result for anything else (exponents,
+    // leading dots, long tokens, garbage); the caller must then fall back to
+    // tryParseDouble.
+    TINYOBJ_TARGET_SSE41
+    static bool tryParseDoubleSse41(const char* s, const char* s_end,
+        double* result) {
+        char sign = '+';
+        const char* curr = s;
+        if ((curr < s_end) && (*curr == '+' || *curr == '-')) {
+            sign = *curr;
+            curr++;
+        }
+
+        const int length = static_cast<int>(s_end - curr);
+        if (length <= 0 || length > 16) {
+            return false;
+        }
+
+        // Never read past the token: it is copied into a zero padded block
+        // first, so the wide load only sees bytes that belong to it.
+        char token[16] = { 0 };
+        memcpy(token, curr, static_cast<size_t>(length));
+        const __m128i chars =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(token));
+
+        const __m128i values = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        const __m128i digits = _mm_cmpeq_epi8(
+            _mm_min_epu8(values, _mm_set1_epi8(9)), values);
+        const __m128i dots = _mm_cmpeq_epi8(chars, _mm_set1_epi8('.'));
+
+        const unsigned int valid = (1u << length) - 1u;
+        const unsigned int digit_mask =
+            static_cast<unsigned int>(_mm_movemask_epi8(digits)) & valid;
+        const unsigned int dot_mask =
+            static_cast<unsigned int>(_mm_movemask_epi8(dots)) & valid;
+
+        // Only digits and at most one dot.
+        if (((digit_mask | dot_mask) != valid) ||
+            ((dot_mask & (dot_mask - 1u)) != 0)) {
+            return false;
+        }
+
+        const int int_digits = dot_mask ? countTrailingZeros(dot_mask) : length;
+        const int frac_digits = dot_mask ? length - int_digits - 1 : 0;
+        const int lut_entries =
+            sizeof fraction_pow_lut / sizeof fraction_pow_lut[0];
+        if (int_digits == 0 || int_digits > 15 || frac_digits >= lut_entries) {
+            return false;
+        }
+
+        // Digit values inside the token, zero everywhere else.
+        const __m128i in_token = _mm_cmplt_epi8(
+            _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+            _mm_set1_epi8(static_cast<char>(length)));
+        const __m128i digit_values =
+            _mm_and_si128(values, _mm_and_si128(digits, in_token));
+
+        // Shuffle controls that move byte n to lane 0 (shift_lut + 16 + n)
+        // or lane 15 (shift_lut + 15 - n), filling with zeros.
+        static const signed char shift_lut[48] = {
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        };
+
+        // Right-align the integer digits, then reduce
+        // 16 digits -> 8 pairs -> 4 quads -> 2 groups of 8.
+        __m128i v = _mm_shuffle_epi8(digit_values, _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(shift_lut + int_digits)));
+        v = _mm_maddubs_epi16(v, _mm_set1_epi16(0x010A));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00010064));
+        v = _mm_packus_epi32(v, v);
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00012710));
+
+        const long long high = _mm_cvtsi128_si32(v);
+        const long long low = _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+
+        // Left-align the fractional digits; lanes past the token are zero.
+        const __m128i fraction = _mm_shuffle_epi8(digit_values, _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(shift_lut + 16 + int_digits + 1)));
+
+        // Scale the 7 digits two at a time. The products are the same as
+        // tryParseDouble's, and adding them up one by one in order rounds
+        // the same way. Adding 0 * 10^-n for missing digits leaves the
+        // mantissa unchanged, so no branch on the digit count is needed.
+        const __m128d scaled12 = _mm_mul_pd(
+            _mm_cvtepi32_pd(_mm_cvtepu8_epi32(fraction)),
+            _mm_loadu_pd(fraction_pow_lut + 1));
+        const __m128d scaled34 = _mm_mul_pd(
+            _mm_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_srli_si128(fraction, 2))),
+            _mm_loadu_pd(fraction_pow_lut + 3));
+        const __m128d scaled56 = _mm_mul_pd(
+            _mm_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_srli_si128(fraction, 4))),
+            _mm_loadu_pd(fraction_pow_lut + 5));
+        const __m128d scaled7 = _mm_mul_sd(
+            _mm_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_srli_si128(fraction, 6))),
+            _mm_load_sd(fraction_pow_lut + 7));
+
+        // Exact: at most 15 digits.
+        __m128d mantissa = _mm_set_sd(static_cast<double>(high * 100000000 + low));
+        mantissa = _mm_add_sd(mantissa, scaled12);
+        mantissa = _mm_add_sd(mantissa, _mm_unpackhi_pd(scaled12, scaled12));
+        mantissa = _mm_add_sd(mantissa, scaled34);
+        mantissa = _mm_add_sd(mantissa, _mm_unpackhi_pd(scaled34, scaled34));
+        mantissa = _mm_add_sd(mantissa, scaled56);
+        mantissa = _mm_add_sd(mantissa, _mm_unpackhi_pd(scaled56, scaled56));
+        mantissa = _mm_add_sd(mantissa, scaled7);
+
+        *result = (sign == '+' ? 1 : -1) * _mm_cvtsd_f64(mantissa);
+        return true;
+    }
+#endif  // TINYOBJLOADER_SIMD_PARSER
+
+    // tryParseDouble, taking the SIMD fast path when the CPU supports it.
+    static inline bool tryParseDoubleFast(const char* s, const char* s_end,
+        double* result) {
+#ifdef TINYOBJLOADER_SIMD_PARSER
+        if (cpu_has_sse41 && tryParseDoubleSse41(s, s_end, result)) {
+            return true;
+        }
+#endif
+        return tryParseDouble(s, s_end, result);
+    }
+
+#ifdef TINYOBJLOADER_SIMD_PARSER
+    // Parses token with both parsers from the end of an allocation of its
+    // exact size; returns false when the SIMD one accepts a different value.
+    static bool checkRealToken(const std::string& token, std::string* report) {
+        std::vector<char> exact(token.begin(), token.end());
+        const char* begin = exact.empty() ? NULL : &exact[0];
+        const char* end = begin + exact.size();
+
+        double fast = 0.0;
+        if (!tryParseDoubleSse41(begin, end, &fast)) {
+            return true;
+        }
+
+        double scalar = 0.0;
+        const bool accepted = tryParseDouble(begin, end, &scalar);
+        if (accepted && memcmp(&fast, &scalar, sizeof(double)) == 0) {
+            return true;
+        }
+
+        if (report) {
+            std::stringstream ss;
+            ss.precision(17);
+            ss << "'" << token << "': SIMD " << fast << ", scalar ";
+            if (accepted) {
+                ss << scalar;
+            }
+            else {
+                ss << "rejected";
+            }
+            (*report) += ss.str() + "\n";
+        }
+        return false;
+    }
+#endif  // TINYOBJLOADER_SIMD_PARSER
+
+    size_t CheckRealParser(const char* filename, std::string* report) {
+        size_t mismatches = 0;
+#ifdef TINYOBJLOADER_SIMD_PARSER
+        if (!cpu_has_sse41) {
+            return 0;
+        }
+
+        static const char* const edge_cases[] = {
+            "", "+", "-", ".", "0", "-0", "+0", "0.", "-0.", ".5", "1.", "-1.0",
+            "1.2.3", "1e5", "1E-5", "1,5", "0x10", "nan", "inf", "12a",
+            "0.0000001", "9.9999999", "9999999.9999999", "00000000000000.1",
+            "123456789012345", "1234567890123456", "999999999999999.9",
+            "12345678.1234567", "1.12345678", "-999999999999999",
+        };
+        for (size_t i = 0; i < sizeof edge_cases / sizeof edge_cases[0]; i++) {
+            mismatches += checkRealToken(edge_cases[i], report) ? 0 : 1;
+        }
+
+        // Fixed format decimals of every shape the fast path takes, and some
+        // just past it. A fixed seed keeps the corpus the same every run.
+        unsigned int seed = 12345u;
+        for (int i = 0; i < 100000; i++) {
+            std::string token;
+            seed = seed * 1664525u + 1013904223u;
+            const unsigned int bits = seed >> 8;
+            if (bits & 1u) {
+                token += (bits & 2u) ? '-' : '+';
+            }
+            const unsigned int int_digits = 1u + (bits >> 2) % 16u;
+            const unsigned int frac_digits = (bits >> 6) % 10u;
+            for (unsigned int d = 0; d < int_digits + frac_digits; d++) {
+                if (d == int_digits) {
+                    token += '.';
+                }
+                seed = seed * 1664525u + 1013904223u;
+                token += static_cast<char>('0' + (seed >> 16) % 10u);
+            }
+            mismatches += checkRealToken(token, report) ? 0 : 1;
+        }
+
+        if (filename) {
+            std::ifstream file(filename);
+            std::string line;
+            while (std::getline(file, line)) {
+                std::istringstream fields(line);
+                std::string command;
+                fields >> command;
+                if (command != "v" && command != "vn" && command != "vt") {
+                    continue;
+                }
+
+                std::string token;
+                while (fields >> token) {
+                    mismatches += checkRealToken(token, report) ? 0 : 1;
+                }
+            }
+        }
+#else
+        (void)filename;
+        (void)report;
+#endif  // TINYOBJLOADER_SIMD_PARSER
+        return mismatches;
+    }
+
     static inline real_t parseReal(const char** token, double default_value = 0.0) {
         (*token) += strspn((*token), " \t");
         const char* end = (*token) + strcspn((*token), " \t\r");
         double val = default_value;
-        tryParseDouble((*token), end, &val);
+        tryParseDoubleFast((*token), end, &val);
         real_t f = static_cast<real_t>(val);
         (*token) = end;
         return f;
@@ -957,7 +1277,7 @@ namespace tinyobj {
         (*token) += strspn((*token), " \t");
         const char* end = (*token) + strcspn((*token), " \t\r");
         double val;
-        bool ret = tryParseDouble((*token), end, &val);
+        bool ret = tryParseDoubleFast((*token), end, &val);
         if (ret) {
             real_t f = static_cast<real_t>(val);
             (*out) = f;
@@ -3261,6 +3581,981 @@ namespace tinyobj {
         return true;
     }
 
+    // Read-only view of a whole file, backed by mmap() / MapViewOfFile().
+    struct mapped_file_t {
+        const char* data;
+        size_t size;
+#ifdef _WIN32
+        HANDLE file;
+        HANDLE mapping;
+
+        mapped_file_t()
+            : data(NULL), size(0), file(INVALID_HANDLE_VALUE), mapping(NULL) {}
+#else
+        int fd;
+
+        mapped_file_t() : data(NULL), size(0), fd(-1) {}
+#endif
+        ~mapped_file_t() { unmap(); }
+
+        bool map(const char* filename) {
+#ifdef _WIN32
+            file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size)) {
+                return false;
+            }
+
+            size = static_cast<size_t>(file_size.QuadPart);
+            if (size == 0) {
+                return true;  // Nothing to map, empty .obj
+            }
+
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping == NULL) {
+                return false;
+            }
+
+            data = static_cast<const char*>(
+                MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            return data != NULL;
+#else
+            fd = ::open(filename, O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                return false;
+            }
+
+            size = static_cast<size_t>(st.st_size);
+            if (size == 0) {
+                return true;  // Nothing to map, empty .obj
+            }
+
+            void* addr = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                return false;
+            }
+
+            ::madvise(addr, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(addr);
+            return true;
+#endif
+        }
+
+        void unmap() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            mapping = NULL;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (data) ::munmap(const_cast<char*>(data), size);
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+#endif
+            data = NULL;
+            size = 0;
+        }
+    };
+
+    // A statement other than `v`, `vn`, `vt` and `f`. These are rare and depend
+    // on the state built up by the preceding lines, so the worker only records
+    // them and LoadObjMapped() replays them in file order.
+    struct deferred_line_t {
+        std::string line;  // Newline-trimmed copy of the line.
+        size_t line_num;   // Line number, relative to the chunk.
+        size_t num_faces;  // Faces parsed in the chunk before this line.
+        int num_v, num_vn, num_vt;  // Chunk-local element counts at this line.
+    };
+
+    // A face which uses relative(negative) indices. Those can only be fixed up
+    // once the element counts of all previous chunks are known.
+    struct relative_face_t {
+        size_t face;
+        int num_v, num_vn, num_vt;  // Chunk-local element counts at this face.
+    };
+
+    // Parse result of one line-aligned range of the mapped file.
+    struct obj_chunk_t {
+        const char* begin;
+        const char* end;
+
+        std::vector<real_t> v;
+        std::vector<real_t> vn;
+        std::vector<real_t> vt;
+        std::vector<real_t> vc;
+        std::vector<face_t> faces;
+        std::vector<relative_face_t> relative_faces;
+        std::vector<deferred_line_t> deferred;
+
+        size_t num_lines;
+        int greatest_v_idx;
+        int greatest_vn_idx;
+        int greatest_vt_idx;
+        bool found_all_colors;
+
+        bool failed;       // `f` line could not be parsed,
+        size_t fail_line;  // at this chunk-local line.
+        std::exception_ptr exception;
+
+        obj_chunk_t()
+            : begin(NULL),
+            end(NULL),
+            num_lines(0),
+            greatest_v_idx(-1),
+            greatest_vn_idx(-1),
+            greatest_vt_idx(-1),
+            found_all_colors(true),
+            failed(false),
+            fail_line(0) {}
+    };
+
+    // Like fixIndex(), but a relative index is kept as `idx - 1`(<= -2) so it
+    // can be resolved later by fixDeferredIndex(). -1 still means "not present".
+    static inline bool deferIndex(int idx, int* ret, bool* relative) {
+        if (idx > 0) {
+            (*ret) = idx - 1;
+            return true;
+        }
+
+        if (idx == 0) {
+            // zero is not allowed according to the spec.
+            return false;
+        }
+
+        (*ret) = idx - 1;
+        (*relative) = true;
+        return true;
+    }
+
+    static inline int fixDeferredIndex(int idx, int n) {
+        return (idx < -1) ? (n + idx + 1) : idx;
+    }
+
+    // Same grammar as parseTriple(), with relative indices deferred.
+    static bool parseDeferredTriple(const char** token, vertex_index_t* ret,
+        bool* relative) {
+        vertex_index_t vi(-1);
+
+        if (!deferIndex(atoi((*token)), &(vi.v_idx), relative)) {
+            return false;
+        }
+
+        (*token) += strcspn((*token), "/ \t\r");
+        if ((*token)[0] != '/') {
+            (*ret) = vi;
+            return true;
+        }
+        (*token)++;
+
+        // i//k
+        if ((*token)[0] == '/') {
+            (*token)++;
+            if (!deferIndex(atoi((*token)), &(vi.vn_idx), relative)) {
+                return false;
+            }
+            (*token) += strcspn((*token), "/ \t\r");
+            (*ret) = vi;
+            return true;
+        }
+
+        // i/j/k or i/j
+        if (!deferIndex(atoi((*token)), &(vi.vt_idx), relative)) {
+            return false;
+        }
+
+        (*token) += strcspn((*token), "/ \t\r");
+        if ((*token)[0] != '/') {
+            (*ret) = vi;
+            return true;
+        }
+
+        // i/j/k
+        (*token)++;  // skip '/'
+        if (!deferIndex(atoi((*token)), &(vi.vn_idx), relative)) {
+            return false;
+        }
+        (*token) += strcspn((*token), "/ \t\r");
+
+        (*ret) = vi;
+
+        return true;
+    }
+
+    // Worker body of LoadObjMapped(). Lines are split exactly like
+    // safeGetline() does and copied into a NUL terminated buffer, so the
+    // shared token parsers behave the same as in LoadObj().
+    static void parseObjChunk(obj_chunk_t* chunk) {
+        std::string linebuf;
+        const char* p = chunk->begin;
+
+        while (p < chunk->end) {
+            const char* eol = p;
+            while ((eol < chunk->end) && (*eol != '\n') && (*eol != '\r')) {
+                eol++;
+            }
+
+            linebuf.assign(p, eol);
+
+            p = eol;
+            if (p < chunk->end) {
+                if ((*p == '\r') && (p + 1 < chunk->end) && (p[1] == '\n')) {
+                    p += 2;
+                }
+                else {
+                    p++;
+                }
+            }
+
+            chunk->num_lines++;
+
+            // Skip if empty line.
+            if (linebuf.empty()) {
+                continue;
+            }
+
+            // Skip leading space.
+            const char* token = linebuf.c_str();
+            token += strspn(token, " \t");
+
+            if (token[0] == '\0') continue;  // empty line
+
+            if (token[0] == '#') continue;  // comment line
+
+            // vertex
+            if (token[0] == 'v' && IS_SPACE((token[1]))) {
+                token += 2;
+                real_t x, y, z;
+                real_t r, g, b;
+
+                chunk->found_all_colors &=
+                    parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+
+                chunk->v.push_back(x);
+                chunk->v.push_back(y);
+                chunk->v.push_back(z);
+
+                chunk->vc.push_back(r);
+                chunk->vc.push_back(g);
+                chunk->vc.push_back(b);
+
+                continue;
+            }
+
+            // normal
+            if (token[0] == 'v' && token[1] == 'n' && IS_SPACE((token[2]))) {
+                token += 3;
+                real_t x, y, z;
+                parseReal3(&x, &y, &z, &token);
+                chunk->vn.push_back(x);
+                chunk->vn.push_back(y);
+                chunk->vn.push_back(z);
+                continue;
+            }
+
+            // texcoord
+            if (token[0] == 'v' && token[1] == 't' && IS_SPACE((token[2]))) {
+                token += 3;
+                real_t x, y;
+                parseReal2(&x, &y, &token);
+                chunk->vt.push_back(x);
+                chunk->vt.push_back(y);
+                continue;
+            }
+
+            // face
+            if (token[0] == 'f' && IS_SPACE((token[1]))) {
+                token += 2;
+                token += strspn(token, " \t");
+
+                chunk->faces.push_back(face_t());
+                face_t& face = chunk->faces.back();
+                face.vertex_indices.reserve(3);
+
+                bool relative = false;
+                while (!IS_NEW_LINE(token[0])) {
+                    vertex_index_t vi;
+                    if (!parseDeferredTriple(&token, &vi, &relative)) {
+                        chunk->failed = true;
+                        chunk->fail_line = chunk->num_lines;
+                        return;
+                    }
+
+                    chunk->greatest_v_idx = chunk->greatest_v_idx > vi.v_idx
+                        ? chunk->greatest_v_idx : vi.v_idx;
+                    chunk->greatest_vn_idx = chunk->greatest_vn_idx > vi.vn_idx
+                        ? chunk->greatest_vn_idx : vi.vn_idx;
+                    chunk->greatest_vt_idx = chunk->greatest_vt_idx > vi.vt_idx
+                        ? chunk->greatest_vt_idx : vi.vt_idx;
+
+                    face.vertex_indices.push_back(vi);
+                    size_t n = strspn(token, " \t\r");
+                    token += n;
+                }
+
+                if (relative) {
+                    relative_face_t rf;
+                    rf.face = chunk->faces.size() - 1;
+                    rf.num_v = static_cast<int>(chunk->v.size() / 3);
+                    rf.num_vn = static_cast<int>(chunk->vn.size() / 3);
+                    rf.num_vt = static_cast<int>(chunk->vt.size() / 2);
+                    chunk->relative_faces.push_back(rf);
+                }
+
+                continue;
+            }
+
+            deferred_line_t deferred;
+            deferred.line = linebuf;
+            deferred.line_num = chunk->num_lines;
+            deferred.num_faces = chunk->faces.size();
+            deferred.num_v = static_cast<int>(chunk->v.size() / 3);
+            deferred.num_vn = static_cast<int>(chunk->vn.size() / 3);
+            deferred.num_vt = static_cast<int>(chunk->vt.size() / 2);
+            chunk->deferred.push_back(deferred);
+        }
+    }
+
+    static void parseObjChunkNoThrow(obj_chunk_t* chunk) {
+        try {
+            parseObjChunk(chunk);
+        }
+        catch (...) {
+            chunk->exception = std::current_exception();
+        }
+    }
+
+    // Parser state LoadObjMapped() carries from chunk to chunk while merging.
+    struct obj_merge_state_t {
+        std::vector<real_t> v;  // Grows in file order, see LoadObjMapped().
+        std::vector<skin_weight_t> vw;
+        std::vector<tag_t> tags;
+        PrimGroup prim_group;
+        std::string name;
+        std::map<std::string, int> material_map;
+        int material;
+        unsigned int current_smoothing_id;
+        shape_t shape;
+
+        obj_merge_state_t() : material(-1), current_smoothing_id(0) {}
+    };
+
+    // Moves the faces [first, last) of `chunk` into the current primitive
+    // group, resolving relative indices and applying the smoothing group.
+    static void mergeObjFaces(obj_merge_state_t* state, obj_chunk_t* chunk,
+        size_t first, size_t last, size_t* next_relative,
+        int base_v, int base_vn, int base_vt) {
+        for (size_t i = first; i < last; i++) {
+            face_t& face = chunk->faces[i];
+
+            if ((*next_relative < chunk->relative_faces.size()) &&
+                (chunk->relative_faces[*next_relative].face == i)) {
+                const relative_face_t& rf = chunk->relative_faces[*next_relative];
+                for (size_t k = 0; k < face.vertex_indices.size(); k++) {
+                    vertex_index_t& vi = face.vertex_indices[k];
+                    vi.v_idx = fixDeferredIndex(vi.v_idx, base_v + rf.num_v);
+                    vi.vn_idx = fixDeferredIndex(vi.vn_idx, base_vn + rf.num_vn);
+                    vi.vt_idx = fixDeferredIndex(vi.vt_idx, base_vt + rf.num_vt);
+                }
+                (*next_relative)++;
+            }
+
+            state->prim_group.faceGroup.push_back(face_t());
+            face_t& merged = state->prim_group.faceGroup.back();
+            merged.smoothing_group_id = state->current_smoothing_id;
+            merged.vertex_indices.swap(face.vertex_indices);
+        }
+    }
+
+    // Replays a deferred statement exactly like the main loop of LoadObj().
+    // `vsize`, `vnsize` and `vtsize` are the element counts at that line.
+    static bool replayObjLine(obj_merge_state_t* state, const char* token,
+        int vsize, int vnsize, int vtsize, size_t line_num,
+        std::vector<shape_t>* shapes,
+        std::vector<material_t>* materials,
+        MaterialReader* readMatFn, bool triangulate,
+        std::string* warn, std::string* err) {
+        // skin weight. tinyobj extension
+        if (token[0] == 'v' && token[1] == 'w' && IS_SPACE((token[2]))) {
+            token += 3;
+
+            int vid = 0;
+            vid = parseInt(&token);
+
+            skin_weight_t sw;
+
+            sw.vertex_id = vid;
+
+            while (!IS_NEW_LINE(token[0])) {
+                real_t j, w;
+                // joint_id should not be negative, weight may be negative
+                parseReal2(&j, &w, &token, -1.0);
+
+                if (j < static_cast<real_t>(0)) {
+                    if (err) {
+                        std::stringstream ss;
+                        ss << "Failed parse `vw' line. joint_id is negative. "
+                            "line "
+                            << line_num << ".)\n";
+                        (*err) += ss.str();
+                    }
+                    return false;
+                }
+
+                joint_and_weight_t jw;
+
+                jw.joint_id = int(j);
+                jw.weight = w;
+
+                sw.weightValues.push_back(jw);
+
+                size_t n = strspn(token, " \t\r");
+                token += n;
+            }
+
+            state->vw.push_back(sw);
+            return true;
+        }
+
+        // line
+        if (token[0] == 'l' && IS_SPACE((token[1]))) {
+            token += 2;
+
+            __line_t line;
+
+            while (!IS_NEW_LINE(token[0])) {
+                vertex_index_t vi;
+                if (!parseTriple(&token, vsize, vnsize, vtsize, &vi)) {
+                    if (err) {
+                        std::stringstream ss;
+                        ss << "Failed parse `l' line(e.g. zero value for vertex index. "
+                            "line "
+                            << line_num << ".)\n";
+                        (*err) += ss.str();
+                    }
+                    return false;
+                }
+
+                line.vertex_indices.push_back(vi);
+
+                size_t n = strspn(token, " \t\r");
+                token += n;
+            }
+
+            state->prim_group.lineGroup.push_back(line);
+
+            return true;
+        }
+
+        // points
+        if (token[0] == 'p' && IS_SPACE((token[1]))) {
+            token += 2;
+
+            __points_t pts;
+
+            while (!IS_NEW_LINE(token[0])) {
+                vertex_index_t vi;
+                if (!parseTriple(&token, vsize, vnsize, vtsize, &vi)) {
+                    if (err) {
+                        std::stringstream ss;
+                        ss << "Failed parse `p' line(e.g. zero value for vertex index. "
+                            "line "
+                            << line_num << ".)\n";
+                        (*err) += ss.str();
+                    }
+                    return false;
+                }
+
+                pts.vertex_indices.push_back(vi);
+
+                size_t n = strspn(token, " \t\r");
+                token += n;
+            }
+
+            state->prim_group.pointsGroup.push_back(pts);
+
+            return true;
+        }
+
+        // use mtl
+        if ((0 == strncmp(token, "usemtl", 6))) {
+            token += 6;
+            std::string namebuf = parseString(&token);
+
+            int newMaterialId = -1;
+            std::map<std::string, int>::const_iterator it =
+                state->material_map.find(namebuf);
+            if (it != state->material_map.end()) {
+                newMaterialId = it->second;
+            }
+            else {
+                // { error!! material not found }
+                if (warn) {
+                    (*warn) += "material [ '" + namebuf + "' ] not found in .mtl\n";
+                }
+            }
+
+            if (newMaterialId != state->material) {
+                exportGroupsToShape(&state->shape, state->prim_group, state->tags,
+                    state->material, state->name, triangulate, state->v, warn);
+                state->prim_group.faceGroup.clear();
+                state->material = newMaterialId;
+            }
+
+            return true;
+        }
+
+        // load mtl
+        if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE((token[6]))) {
+            if (readMatFn) {
+                token += 7;
+
+                std::vector<std::string> filenames;
+                SplitString(std::string(token), ' ', '\\', filenames);
+
+                if (filenames.empty()) {
+                    if (warn) {
+                        std::stringstream ss;
+                        ss << "Looks like empty filename for mtllib. Use default "
+                            "material (line "
+                            << line_num << ".)\n";
+
+                        (*warn) += ss.str();
+                    }
+                }
+                else {
+                    bool found = false;
+                    for (size_t s = 0; s < filenames.size(); s++) {
+                        std::string warn_mtl;
+                        std::string err_mtl;
+                        bool ok = (*readMatFn)(filenames[s].c_str(), materials,
+                            &state->material_map, &warn_mtl, &err_mtl);
+                        if (warn && (!warn_mtl.empty())) {
+                            (*warn) += warn_mtl;
+                        }
+
+                        if (err && (!err_mtl.empty())) {
+                            (*err) += err_mtl;
+                        }
+
+                        if (ok) {
+                            found = true;
+                            break;
+                        }
+                    }
+
+                    if (!found) {
+                        if (warn) {
+                            (*warn) +=
+                                "Failed to load material file(s). Use default "
+                                "material.\n";
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // group name
+        if (token[0] == 'g' && IS_SPACE((token[1]))) {
+            // flush previous face group.
+            bool ret = exportGroupsToShape(&state->shape, state->prim_group,
+                state->tags, state->material, state->name, triangulate, state->v,
+                warn);
+            (void)ret;  // return value not used.
+
+            if (state->shape.mesh.indices.size() > 0) {
+                shapes->push_back(state->shape);
+            }
+
+            state->shape = shape_t();
+
+            state->prim_group.clear();
+
+            std::vector<std::string> names;
+
+            while (!IS_NEW_LINE(token[0])) {
+                std::string str = parseString(&token);
+                names.push_back(str);
+                token += strspn(token, " \t\r");  // skip tag
+            }
+
+            // names[0] must be 'g'
+
+            if (names.size() < 2) {
+                // 'g' with empty names
+                if (warn) {
+                    std::stringstream ss;
+                    ss << "Empty group name. line: " << line_num << "\n";
+                    (*warn) += ss.str();
+                    state->name = "";
+                }
+            }
+            else {
+                std::stringstream ss;
+                ss << names[1];
+
+                for (size_t i = 2; i < names.size(); i++) {
+                    ss << " " << names[i];
+                }
+
+                state->name = ss.str();
+            }
+
+            return true;
+        }
+
+        // object name
+        if (token[0] == 'o' && IS_SPACE((token[1]))) {
+            // flush previous face group.
+            bool ret = exportGroupsToShape(&state->shape, state->prim_group,
+                state->tags, state->material, state->name, triangulate, state->v,
+                warn);
+            (void)ret;  // return value not used.
+
+            if (state->shape.mesh.indices.size() > 0 ||
+                state->shape.lines.indices.size() > 0 ||
+                state->shape.points.indices.size() > 0) {
+                shapes->push_back(state->shape);
+            }
+
+            state->prim_group.clear();
+            state->shape = shape_t();
+
+            token += 2;
+            std::stringstream ss;
+            ss << token;
+            state->name = ss.str();
+
+            return true;
+        }
+
+        if (token[0] == 't' && IS_SPACE(token[1])) {
+            const int max_tag_nums = 8192;  // FIXME(syoyo): Parameterize.
+            tag_t tag;
+
+            token += 2;
+
+            tag.name = parseString(&token);
+
+            tag_sizes ts = parseTagTriple(&token);
+
+            if (ts.num_ints < 0) {
+                ts.num_ints = 0;
+            }
+            if (ts.num_ints > max_tag_nums) {
+                ts.num_ints = max_tag_nums;
+            }
+
+            if (ts.num_reals < 0) {
+                ts.num_reals = 0;
+            }
+            if (ts.num_reals > max_tag_nums) {
+                ts.num_reals = max_tag_nums;
+            }
+
+            if (ts.num_strings < 0) {
+                ts.num_strings = 0;
+            }
+            if (ts.num_strings > max_tag_nums) {
+                ts.num_strings = max_tag_nums;
+            }
+
+            tag.intValues.resize(static_cast<size_t>(ts.num_ints));
+
+            for (size_t i = 0; i < static_cast<size_t>(ts.num_ints); ++i) {
+                tag.intValues[i] = parseInt(&token);
+            }
+
+            tag.floatValues.resize(static_cast<size_t>(ts.num_reals));
+            for (size_t i = 0; i < static_cast<size_t>(ts.num_reals); ++i) {
+                tag.floatValues[i] = parseReal(&token);
+            }
+
+            tag.stringValues.resize(static_cast<size_t>(ts.num_strings));
+            for (size_t i = 0; i < static_cast<size_t>(ts.num_strings); ++i) {
+                tag.stringValues[i] = parseString(&token);
+            }
+
+            state->tags.push_back(tag);
+
+            return true;
+        }
+
+        if (token[0] == 's' && IS_SPACE(token[1])) {
+            // smoothing group id
+            token += 2;
+
+            // skip space.
+            token += strspn(token, " \t");  // skip space
+
+            if (token[0] == '\0') {
+                return true;
+            }
+
+            if (token[0] == '\r' || token[1] == '\n') {
+                return true;
+            }
+
+            if (strlen(token) >= 3 && token[0] == 'o' && token[1] == 'f' &&
+                token[2] == 'f') {
+                state->current_smoothing_id = 0;
+            }
+            else {
+                // assume number
+                int smGroupId = parseInt(&token);
+                if (smGroupId < 0) {
+                    // parse error. force set to 0.
+                    state->current_smoothing_id = 0;
+                }
+                else {
+                    state->current_smoothing_id = static_cast<unsigned int>(smGroupId);
+                }
+            }
+
+            return true;
+        }  // smoothing group id
+
+        // Ignore unknown command.
+        return true;
+    }
+
+    bool LoadObjMapped(attrib_t* attrib, std::vector<shape_t>* shapes,
+        std::vector<material_t>* materials, std::string* warn,
+        std::string* err, const char* filename, const char* mtl_basedir,
+        bool triangulate, bool default_vcols_fallback,
+        unsigned int num_threads) {
+        attrib->vertices.clear();
+        attrib->normals.clear();
+        attrib->texcoords.clear();
+        attrib->colors.clear();
+        shapes->clear();
+
+        std::stringstream errss;
+
+        mapped_file_t file;
+        if (!file.map(filename)) {
+            errss << "Cannot open file [" << filename << "]\n";
+            if (err) {
+                (*err) = errss.str();
+            }
+            return false;
+        }
+
+        std::string baseDir = mtl_basedir ? mtl_basedir : "";
+        if (!baseDir.empty()) {
+#ifndef _WIN32
+            const char dirsep = '/';
+#else
+            const char dirsep = '\\';
+#endif
+            if (baseDir[baseDir.length() - 1] != dirsep) baseDir += dirsep;
+        }
+        MaterialFileReader matFileReader(baseDir);
+
+        if (num_threads == 0) {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        if (num_threads == 0) {
+            num_threads = 1;
+        }
+
+        // Don't bother splitting small files, thread start up would dominate.
+        const size_t min_chunk_size = size_t(1) << 20;
+        size_t num_chunks = file.size / min_chunk_size + 1;
+        num_chunks = num_chunks < num_threads ? num_chunks : num_threads;
+
+        // Split at the first line ending after each nominal boundary.
+        std::vector<obj_chunk_t> chunks(num_chunks);
+        const char* file_end = file.data + file.size;
+        const char* chunk_begin = file.data;
+        for (size_t i = 0; i < num_chunks; i++) {
+            const char* chunk_end = (i + 1 == num_chunks)
+                ? file_end : file.data + file.size / num_chunks * (i + 1);
+            if (chunk_end < chunk_begin) {
+                chunk_end = chunk_begin;
+            }
+            while ((chunk_end < file_end) && (chunk_end > file.data) &&
+                (chunk_end[-1] != '\n')) {
+                chunk_end++;
+            }
+
+            chunks[i].begin = chunk_begin;
+            chunks[i].end = chunk_end;
+            chunk_begin = chunk_end;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(num_chunks);
+        for (size_t i = 1; i < num_chunks; i++) {
+            workers.push_back(std::thread(parseObjChunkNoThrow, &chunks[i]));
+        }
+        parseObjChunkNoThrow(&chunks[0]);
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i].join();
+        }
+
+        for (size_t i = 0; i < num_chunks; i++) {
+            if (chunks[i].exception) {
+                std::rethrow_exception(chunks[i].exception);
+            }
+        }
+
+        size_t total_v = 0, total_vn = 0, total_vt = 0;
+        for (size_t i = 0; i < num_chunks; i++) {
+            total_v += chunks[i].v.size();
+            total_vn += chunks[i].vn.size();
+            total_vt += chunks[i].vt.size();
+        }
+
+        // Merge in file order. `state.v` only ever holds the positions defined
+        // before the statement being replayed, which is what LoadObj() hands
+        // to exportGroupsToShape() for triangulation.
+        obj_merge_state_t state;
+        std::vector<real_t> vn;
+        std::vector<real_t> vt;
+        std::vector<real_t> vc;
+        state.v.reserve(total_v);
+        vn.reserve(total_vn);
+        vt.reserve(total_vt);
+        vc.reserve(total_v);
+
+        int greatest_v_idx = -1;
+        int greatest_vn_idx = -1;
+        int greatest_vt_idx = -1;
+
+        bool found_all_colors = true;
+
+        size_t line_num = 0;
+        for (size_t c = 0; c < num_chunks; c++) {
+            obj_chunk_t& chunk = chunks[c];
+
+            const size_t base_v_size = state.v.size();
+            const int base_v = static_cast<int>(state.v.size() / 3);
+            const int base_vn = static_cast<int>(vn.size() / 3);
+            const int base_vt = static_cast<int>(vt.size() / 2);
+
+            size_t next_face = 0;
+            size_t next_relative = 0;
+            for (size_t d = 0; d < chunk.deferred.size(); d++) {
+                const deferred_line_t& deferred = chunk.deferred[d];
+
+                mergeObjFaces(&state, &chunk, next_face, deferred.num_faces,
+                    &next_relative, base_v, base_vn, base_vt);
+                next_face = deferred.num_faces;
+
+                const size_t merged_v = state.v.size() - base_v_size;
+                state.v.insert(state.v.end(), chunk.v.begin() + merged_v,
+                    chunk.v.begin() + 3 * deferred.num_v);
+
+                const char* token = deferred.line.c_str();
+                token += strspn(token, " \t");
+
+                if (!replayObjLine(&state, token, base_v + deferred.num_v,
+                    base_vn + deferred.num_vn, base_vt + deferred.num_vt,
+                    line_num + deferred.line_num, shapes, materials,
+                    &matFileReader, triangulate, warn, err)) {
+                    return false;
+                }
+            }
+
+            if (chunk.failed) {
+                if (err) {
+                    std::stringstream ss;
+                    ss << "Failed parse `f' line(e.g. zero value for face index. line "
+                        << line_num + chunk.fail_line << ".)\n";
+                    (*err) += ss.str();
+                }
+                return false;
+            }
+
+            mergeObjFaces(&state, &chunk, next_face, chunk.faces.size(),
+                &next_relative, base_v, base_vn, base_vt);
+
+            const size_t merged_v = state.v.size() - base_v_size;
+            state.v.insert(state.v.end(), chunk.v.begin() + merged_v, chunk.v.end());
+            vn.insert(vn.end(), chunk.vn.begin(), chunk.vn.end());
+            vt.insert(vt.end(), chunk.vt.begin(), chunk.vt.end());
+            vc.insert(vc.end(), chunk.vc.begin(), chunk.vc.end());
+
+            greatest_v_idx = greatest_v_idx > chunk.greatest_v_idx
+                ? greatest_v_idx : chunk.greatest_v_idx;
+            greatest_vn_idx = greatest_vn_idx > chunk.greatest_vn_idx
+                ? greatest_vn_idx : chunk.greatest_vn_idx;
+            greatest_vt_idx = greatest_vt_idx > chunk.greatest_vt_idx
+                ? greatest_vt_idx : chunk.greatest_vt_idx;
+            found_all_colors &= chunk.found_all_colors;
+            line_num += chunk.num_lines;
+
+            // Release the chunk early, keeps the peak close to LoadObj()'s.
+            chunk = obj_chunk_t();
+        }
+
+        // not all vertices have colors, no default colors desired? -> clear colors
+        if (!found_all_colors && !default_vcols_fallback) {
+            vc.clear();
+        }
+
+        if (greatest_v_idx >= static_cast<int>(state.v.size() / 3)) {
+            if (warn) {
+                std::stringstream ss;
+                ss << "Vertex indices out of bounds (line " << line_num << ".)\n\n";
+                (*warn) += ss.str();
+            }
+        }
+        if (greatest_vn_idx >= static_cast<int>(vn.size() / 3)) {
+            if (warn) {
+                std::stringstream ss;
+                ss << "Vertex normal indices out of bounds (line " << line_num << ".)\n\n";
+                (*warn) += ss.str();
+            }
+        }
+        if (greatest_vt_idx >= static_cast<int>(vt.size() / 2)) {
+            if (warn) {
+                std::stringstream ss;
+                ss << "Vertex texcoord indices out of bounds (line " << line_num << ".)\n\n";
+                (*warn) += ss.str();
+            }
+        }
+
+        bool ret = exportGroupsToShape(&state.shape, state.prim_group, state.tags,
+            state.material, state.name, triangulate, state.v, warn);
+        // exportGroupsToShape return false when `usemtl` is called in the last
+        // line.
+        // we also add `shape` to `shapes` when `shape.mesh` has already some
+        // faces(indices)
+        if (ret || state.shape.mesh.indices.size()) {
+            shapes->push_back(state.shape);
+        }
+        state.prim_group.clear();  // for safety
+
+        if (err) {
+            (*err) += errss.str();
+        }
+
+        attrib->vertices.swap(state.v);
+        attrib->vertex_weights.swap(state.v);
+        attrib->normals.swap(vn);
+        attrib->texcoords.swap(vt);
+        attrib->texcoord_ws.swap(vt);
+        attrib->colors.swap(vc);
+        attrib->skin_weights.swap(state.vw);
+
+        return true;
+    }
+
     bool ObjReader::ParseFromFile(const std::string& filename,
         const ObjReaderConfig& config) {
         std::string mtl_search_path;
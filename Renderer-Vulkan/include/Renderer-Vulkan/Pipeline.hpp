@@ -5,35 +5,62 @@
 
 #include <Device.hpp>
 
+// Values for the constant_id specialization constants of a pipeline's shaders. Every stage
+// gets the whole set and ignores ids it does not declare. Constants are kept sorted by id,
+// so equal sets compare equal in the PipelineLibrary however they were built
+class SpecializationConstants
+{
+private:
+    std::vector<VkSpecializationMapEntry> entries = { };
+    std::vector<uint32_t> values                  = { };  // bool, int, uint and float are all 4 bytes
+
+    void setBits(uint32_t id, const void* value);
+
+public:
+    void set(uint32_t id, bool value);
+    void set(uint32_t id, int32_t value);
+    void set(uint32_t id, uint32_t value);
+    void set(uint32_t id, float value);
+
+    bool empty() const { return this->entries.empty(); }
+    const std::vector<VkSpecializationMapEntry>& getEntries() const { return this->entries; }
+    const std::vector<uint32_t>& getValues() const { return this->values; }
+
+    // Points into this set, so only valid while it is unchanged
+    VkSpecializationInfo info() const;
+};
+
 struct PipelineConfigInfo
 {
-    VkPipelineViewportStateCreateInfo viewportInfo            = { };
-    VkPipelineInputAssemblyStateCreateInfo inputAssemblyInput = { };
-    VkPipelineRasterizationStateCreateInfo rasterizationInfo  = { };
-    VkPipelineMultisampleStateCreateInfo multisampleInfo      = { };
-    VkPipelineDepthStencilStateCreateInfo depthStencilInfo    = { };
-    std::vector<VkDynamicState> dynamicStateEnables           = { };
-    VkPipelineDynamicStateCreateInfo dynamicStateInfo         = { };
-    VkPipelineLayout pipelineLayout                           = nullptr;
-    VkRenderPass renderPass                                   = nullptr;
-    uint32_t subpass                                          = 0;
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions     = { };
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions = { };
+    VkPipelineViewportStateCreateInfo viewportInfo                       = { };
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyInput            = { };
+    VkPipelineRasterizationStateCreateInfo rasterizationInfo             = { };
+    VkPipelineMultisampleStateCreateInfo multisampleInfo                 = { };
+    VkPipelineDepthStencilStateCreateInfo depthStencilInfo               = { };
+    std::vector<VkDynamicState> dynamicStateEnables                      = { };
+    VkPipelineDynamicStateCreateInfo dynamicStateInfo                    = { };
+    VkPipelineLayout pipelineLayout                                      = nullptr;
+    VkRenderPass renderPass                                              = nullptr;
+    uint32_t subpass                                                     = 0;
+    SpecializationConstants specialization                               = { };
 };
 
+// A pipeline of the device's PipelineLibrary, which may still be compiling on its workers;
+// the first bind() waits for it. Identical pipelines are shared, and outlive this handle
 class Pipeline
 {
 private:
-    Device& device;
-    VkPipeline graphicsPipeline     = nullptr;
-    VkShaderModule vertShaderModule = nullptr;
-    VkShaderModule fragShaderModule = nullptr;
-
-    static const std::vector<char> readFile(const std::string& filePath);
-    void createGraphicsPipeline(const std::string_view& vertPath, const std::string_view& fragPath, const PipelineConfigInfo& config);
-    void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
+    PipelineLibrary::Future pipeline = { };
+    VkPipelineBindPoint bindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
 
 public:
     Pipeline(Device& device, const std::string_view& verPath, const std::string_view& fragPath, const PipelineConfigInfo& config);
-    ~Pipeline();
+
+    // A compute pipeline, bound to VK_PIPELINE_BIND_POINT_COMPUTE
+    Pipeline(Device& device, const std::string_view& compPath, VkPipelineLayout pipelineLayout);
+    ~Pipeline() = default;
 
     // Delete copy constructor and copy operator
     Pipeline(const Pipeline&)            = delete;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <Stats.hpp>
+
+// The device's VkPipelineCache, kept on disk between runs. The file is the driver's own
+// serialization; it is only handed back when its header names this driver and device, and
+// is replaced whole on save, so a crash never leaves a torn file behind
+class PipelineCache
+{
+private:
+    VkDevice device                                       = nullptr;
+    VkPipelineCache cache                                 = nullptr;
+    const std::string filePath                            = "";
+    bool warm                                             = false;  // Loaded from filePath
+    std::vector<StartupStats::PipelineCreation> creations = { };
+    mutable std::mutex mutex                              = { };  // Over creations
+
+    static bool isCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties);
+
+public:
+    PipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties, const std::string& filePath = "Cache/Pipelines.bin");
+
+    // Saves the cache before destroying it
+    ~PipelineCache();
+
+    // Delete copy constructor and copy operator
+    PipelineCache(const PipelineCache&)            = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    VkPipelineCache handle() const { return this->cache; }
+    bool isWarm() const            { return this->warm;  }
+
+    // Writes the driver's data to filePath; returns false, leaving any older file, on failure
+    bool save() const;
+
+    // Timings of each pipeline created with the cache, for StartupStats. Thread safe
+    void record(const std::string& shaderPath, double milliseconds);
+    std::vector<StartupStats::PipelineCreation> getCreations() const;
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <PipelineCache.hpp>
+#include <WorkerPool.hpp>
+
+struct PipelineConfigInfo;
+
+// Every VkPipeline of the device. Requests are keyed by the shaders' SPIR-V and, for graphics
+// pipelines, everything in PipelineConfigInfo that reaches the driver, so identical requests
+// share one pipeline. Shader modules are shared by content hash too. A new pipeline is
+// compiled on a WorkerPool through the PipelineCache, and the request returns at once with a
+// future of it.
+//
+// Render passes are keyed by what makes them compatible rather than by handle, so a pass
+// recreated with the swap chain finds the pipelines of the one before, and a reused handle
+// never finds those of another pass. Pipelines live until their layout is released, or the
+// library is destroyed with the device
+class PipelineLibrary
+{
+public:
+    using Future = std::shared_future<VkPipeline>;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const std::string& key) const;
+    };
+
+    struct Entry
+    {
+        Future future                   = { };
+        VkPipelineLayout pipelineLayout = nullptr;
+    };
+
+    VkDevice device                                               = nullptr;
+    PipelineCache& cache;
+    std::unordered_map<uint64_t, VkShaderModule> shaderModules    = { };  // By content hash
+    std::unordered_map<std::string, Entry, KeyHash> pipelines     = { };  // By canonical key
+    std::unordered_map<VkRenderPass, std::string> renderPasses    = { };  // Compatibility key of each added
+    std::mutex mutex                                              = { };
+    uint32_t requests                                             = 0;
+    WorkerPool workers;
+
+    // Reads the SPIR-V at filePath, returning the module with the same code if there is one
+    VkShaderModule shaderModule(const std::string& filePath, uint64_t& contentHash);
+
+    static std::vector<char> readFile(const std::string& filePath);
+    static std::string renderPassKey(const VkRenderPassCreateInfo& createInfo);
+    static std::string graphicsKey(uint64_t vertHash, uint64_t fragHash, const std::string& renderPassKey, const PipelineConfigInfo& config);
+
+public:
+    // Compiles on threadCount threads besides the caller's, 0 being one per hardware thread
+    PipelineLibrary(VkDevice device, PipelineCache& cache, uint32_t threadCount = 0);
+    ~PipelineLibrary();
+
+    // Delete copy constructor and copy operator
+    PipelineLibrary(const PipelineLibrary&)            = delete;
+    PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+    // Every render pass graphics pipelines are requested for is added once created, and
+    // removed before it is destroyed. Its pipelines stay for any pass compatible with it
+    void addRenderPass(VkRenderPass renderPass, const VkRenderPassCreateInfo& createInfo);
+    void removeRenderPass(VkRenderPass renderPass);
+
+    // Destroys every pipeline made with pipelineLayout, which must no longer be in use; called
+    // right before the layout is destroyed
+    void releaseLayout(VkPipelineLayout pipelineLayout);
+
+    // Thread safe. config is copied, so it may go before the pipeline is compiled
+    Future graphics(const std::string& vertPath, const std::string& fragPath, const PipelineConfigInfo& config);
+    Future compute(const std::string& compPath, VkPipelineLayout pipelineLayout);
+
+    // Until every pipeline requested so far is compiled; rethrows the first failure
+    void wait();
+
+    uint32_t getRequestCount() const  { return this->requests; }
+    uint32_t getPipelineCount() const { return static_cast<uint32_t>(this->pipelines.size()); }
+    uint32_t getThreadCount() const   { return this->workers.getWorkerCount() - 1; }
+};
\ No newline at end of file
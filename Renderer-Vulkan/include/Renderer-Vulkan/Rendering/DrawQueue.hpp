@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// A frame's draws, each with a 64-bit key ordering them by the state they need, the most
+// expensive to change in the highest bits. Sorted with an LSD radix sort, so sorting costs a
+// few linear passes however many draws there are, and equal keys keep their order
+class DrawQueue
+{
+public:
+    struct Packet
+    {
+        uint64_t key  = 0;
+        uint32_t draw = 0;  // Index into the caller's draws
+    };
+
+    // From the top bit down. Fields wider than their bits wrap, which only costs binds
+    static constexpr uint32_t PIPELINE_BITS = 8;
+    static constexpr uint32_t MATERIAL_BITS = 16;
+    static constexpr uint32_t MODEL_BITS    = 24;
+    static constexpr uint32_t DEPTH_BITS    = 16;
+
+private:
+    static constexpr uint32_t RADIX_BITS = 8;
+    static constexpr uint32_t RADIX      = 1u << RADIX_BITS;
+    static constexpr uint32_t PASSES     = 64 / RADIX_BITS;
+
+    std::vector<Packet> packets = { };
+    std::vector<Packet> scratch = { };  // Kept across frames for its capacity
+
+public:
+    DrawQueue() = default;
+
+    // Delete copy constructor and copy operator
+    DrawQueue(const DrawQueue&)            = delete;
+    DrawQueue& operator=(const DrawQueue&) = delete;
+
+    // Depth is view space distance; nearer sorts first, as every draw is opaque
+    static uint64_t makeKey(uint32_t pipeline, uint32_t material, uint32_t model, float depth);
+    static uint32_t depthBucket(float depth);
+
+    void clear() { this->packets.clear(); }
+    void push(uint64_t key, uint32_t draw) { this->packets.push_back({ key, draw }); }
+    void sort();
+
+    uint32_t size() const { return static_cast<uint32_t>(this->packets.size()); }
+    const Packet& operator[](uint32_t i) const { return this->packets[i]; }
+};
\ No newline at end of file
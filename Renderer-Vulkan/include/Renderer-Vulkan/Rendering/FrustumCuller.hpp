@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <Objects/Object.hpp>
+
+// CPU frustum culling of the objects' bounding spheres, run before RenderSystem groups
+// anything. The world space spheres are kept as a structure of arrays, so the plane tests
+// run 8 objects at a time with AVX and FMA where the CPU has them, 4 at a time with SSE otherwise.
+//
+// The arrays persist across frames: sync() rebuilds them only when the objects are a new set,
+// and otherwise only refreshes those reported through moved(). Every GROUP objects also share
+// a sphere around theirs, tested first, so groups wholly outside or inside the frustum skip
+// their objects' tests and only the ones crossing a plane are read
+class FrustumCuller
+{
+public:
+    static constexpr uint32_t BLOCK        = 8;  // Objects per visibility mask byte; arrays are padded to it
+    static constexpr uint32_t GROUP_BLOCKS = 8;  // Blocks under one group sphere
+    static constexpr uint32_t GROUP        = BLOCK * GROUP_BLOCKS;
+
+    enum class InstructionSet
+    {
+        Scalar,
+        Sse,
+        Avx  // With FMA
+    };
+
+private:
+    // A structure of arrays of spheres, padded to whole blocks. Radii are stored negated, the
+    // bound each plane distance is compared against; padding gets FLT_MAX so it never passes
+    struct Spheres
+    {
+        std::vector<float> centerX   = { };
+        std::vector<float> centerY   = { };
+        std::vector<float> centerZ   = { };
+        std::vector<float> negRadius = { };
+
+        void resize(uint32_t count);
+        void set(uint32_t index, const glm::vec3& center, float radius);
+        glm::vec4 get(uint32_t index) const;
+    };
+
+    // World space spheres of the objects
+    Spheres spheres                    = { };
+    std::vector<uint8_t> masks         = { };  // Bit i of byte j is object j * BLOCK + i
+
+    // Spheres around each GROUP objects' spheres, and the same with the radii as they are, for
+    // the groups wholly inside. Moved objects only ever grow theirs until the next rebuild
+    Spheres groups                     = { };
+    std::vector<float> groupRadius     = { };
+    std::vector<uint8_t> groupReached  = { };  // Bit per group, reaching inside every plane
+    std::vector<uint8_t> groupInside   = { };  // Bit per group, wholly inside every plane
+
+    std::vector<uint32_t> movedObjects = { };
+    uint32_t count                     = 0;
+    Object::id_t firstID               = 0;  // Of the objects last synced, which tell a new set apart
+    Object::id_t lastID                = 0;
+    InstructionSet supported           = InstructionSet::Scalar;  // The widest the CPU runs
+    InstructionSet instructionSet      = InstructionSet::Scalar;
+
+    void rebuild(std::vector<Object>& objects);
+    void fitGroup(uint32_t group);
+    void growGroup(uint32_t group, const glm::vec4& sphere);
+
+    // Tests each sphere of the blocks on its own, with the instruction set picked
+    uint32_t cullBlocks(const float* x, const float* y, const float* z, const float* negR, uint8_t* masks, uint32_t blockCount,
+        const std::array<glm::vec4, 6>& planes) const;
+
+public:
+    FrustumCuller();
+
+    // Delete copy constructor and copy operator
+    FrustumCuller(const FrustumCuller&)            = delete;
+    FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+    // Brings the world space spheres up to date with objects. A different count, or a first or
+    // last object other than last time, rebuilds them all; otherwise only moved objects are read
+    void sync(std::vector<Object>& objects);
+
+    // Call after changing the transform or model of objects[index]; picked up by the next sync()
+    void moved(uint32_t index) { this->movedObjects.push_back(index); }
+
+    // Tests the synced spheres against Camera::getFrustumPlanes(); returns the visible count
+    uint32_t cull(const std::array<glm::vec4, 6>& planes);
+
+    bool isVisible(uint32_t index) const { return (this->masks[index / BLOCK] >> (index % BLOCK)) & 1; }
+    uint32_t getCount() const { return this->count; }
+
+    // The widest the CPU runs unless narrowed, for comparison; wider than supported is clamped
+    void setInstructionSet(InstructionSet instructionSet) { this->instructionSet = std::min(instructionSet, this->supported); }
+    InstructionSet getInstructionSet() const { return this->instructionSet; }
+    InstructionSet getSupported() const { return this->supported; }
+    static const char* getName(InstructionSet instructionSet);
+};
\ No newline at end of file
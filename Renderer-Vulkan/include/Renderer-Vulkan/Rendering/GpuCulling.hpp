@@ -0,0 +1,189 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Device.hpp>
+#include <Model.hpp>
+#include <Pipeline.hpp>
+#include <Objects/Object.hpp>
+
+// GPU-driven path of RenderSystem. Every object goes to the GPU with the index of its model
+// in a mesh table; Cull.comp culls it against the frustum, picks its LOD and appends an
+// indexed indirect draw and its RenderSystem::ObjectData to the lists of its pipeline. The
+// graphics pass then issues one vkCmdDrawIndexedIndirectCount per pipeline, however many
+// objects there are. Needs Device::supportsDrawIndirectCount()
+//
+// With occlusion culling the frame is drawn in two phases. Early draws what was visible last
+// frame; HiZ.comp then reduces the depth it left into a pyramid of farthest depths, and Late
+// tests every object's bounds against it, draws those that became visible and remembers
+// which were, for the next frame's Early
+class GpuCulling
+{
+public:
+    static constexpr uint32_t PIPELINE_COUNT = 2;  // One per Model::VertexFormat
+    static constexpr uint32_t GROUP_SIZE     = 64;  // local_size_x of Cull.comp
+    static constexpr uint32_t HIZ_GROUP_SIZE = 8;  // local_size_x and y of HiZ.comp
+    static constexpr uint32_t MAX_HIZ_LEVELS = 16;
+    static constexpr uint32_t MIN_OBJECTS    = 1024;
+    static constexpr uint32_t MIN_MESHES     = 16;
+
+    enum class Phase
+    {
+        All,    // Frustum culling only
+        Early,  // Of what survives the frustum, what was visible last frame
+        Late    // Of the rest, what the Hi-Z pyramid does not hide
+    };
+
+    // What cull() recorded for a frame
+    struct Result
+    {
+        uint32_t objectCount                  = 0;        // Sent to culling
+        uint32_t streaming                    = 0;        // Skipped, geometry still uploading
+        uint32_t occluded                     = 0;        // By the Late phase of this frame's last use
+        VkDescriptorSet drawSet               = nullptr;  // RenderSystem's set 0 layout, over the culled ObjectData
+
+        // Any model of each pipeline, to bind the geometry pool's buffers with; null when unused
+        Model* pipelineModels[PIPELINE_COUNT] = { };
+    };
+
+private:
+    // std430 layouts read by Cull.comp
+    struct CullObject
+    {
+        glm::mat4 transform = glm::mat4();
+        glm::vec4 color     = glm::vec4();
+        uint32_t mesh       = 0;
+        uint32_t id         = 0;  // Index into the visibility buffer, stable across frames
+        uint32_t padding[2] = { };
+    };
+
+    struct CullLod
+    {
+        uint32_t firstIndex = 0;  // In the geometry pool's index buffer
+        uint32_t indexCount = 0;
+        float error         = 0.0f;
+    };
+
+    struct CullMesh
+    {
+        glm::vec4 boundsMin            = glm::vec4();
+        glm::vec4 boundsMax            = glm::vec4();
+        glm::vec4 sphere               = glm::vec4();  // Model::Sphere, radius in w
+        int32_t vertexOffset           = 0;
+        uint32_t lodCount              = 0;  // None for models without indices, which are skipped
+        uint32_t pipeline              = 0;
+        uint32_t quantized             = 0;
+        CullLod lods[Model::MAX_LODS]  = { };
+    };
+
+    struct CullPush
+    {
+        uint32_t objectCount  = 0;
+        uint32_t capacity     = 0;  // Draws each pipeline has room for
+        uint32_t phase        = 0;  // Phase
+        uint32_t padding      = 0;
+        uint32_t depthSize[2] = { };  // Of the depth attachment the Hi-Z pyramid was built from
+    };
+
+    struct HiZPush
+    {
+        uint32_t sourceSize[2] = { };
+        uint32_t size[2]       = { };
+    };
+
+    // Per frame in flight. Objects and meshes are written by the host, the rest by Cull.comp
+    struct FrameData
+    {
+        VkBuffer cameraBuffer          = nullptr;  // Owned by RenderSystem
+        VkBuffer objectBuffer          = nullptr;
+        MemoryAllocation objectMemory  = { };
+        VkBuffer meshBuffer            = nullptr;
+        MemoryAllocation meshMemory    = { };
+        VkBuffer visibleBuffer         = nullptr;  // ObjectData of the draws
+        MemoryAllocation visibleMemory = { };
+        VkBuffer drawBuffer            = nullptr;  // VkDrawIndexedIndirectCommand
+        MemoryAllocation drawMemory    = { };
+        VkBuffer countBuffer           = nullptr;  // Draw count of each pipeline
+        MemoryAllocation countMemory   = { };
+        VkBuffer statsBuffer           = nullptr;  // Host visible, the occluded count
+        MemoryAllocation statsMemory   = { };
+        uint32_t objectCapacity        = 0;
+        uint32_t meshCapacity          = 0;
+        VkDescriptorSet cullSet        = nullptr;
+        Result result                  = { };
+
+        // Farthest depth of each 2x2 texels of the level above, level 0 over the depth attachment
+        VkImage hizImage                          = nullptr;
+        MemoryAllocation hizMemory                = { };
+        VkImageView hizView                       = nullptr;  // Every level, sampled by Cull.comp
+        VkImageView hizLevelViews[MAX_HIZ_LEVELS] = { };
+        VkDescriptorSet hizSets[MAX_HIZ_LEVELS]   = { };  // Level i from level i - 1, or the depth
+        VkExtent2D depthExtent                    = { };  // The pyramid was made for
+        uint32_t hizLevels                        = 0;
+    };
+
+    Device& device;
+    const VkDeviceSize cameraSize                          = 0;
+    VkDescriptorSetLayout cullSetLayout                    = nullptr;
+    VkPipelineLayout cullPipelineLayout                    = nullptr;
+    VkDescriptorPool descriptorPool                        = nullptr;
+    std::unique_ptr<Pipeline> cullPipeline                 = nullptr;
+    VkDescriptorSetLayout hizSetLayout                     = nullptr;
+    VkPipelineLayout hizPipelineLayout                     = nullptr;
+    std::unique_ptr<Pipeline> hizPipeline                  = nullptr;
+    VkSampler hizSampler                                   = nullptr;
+    std::vector<FrameData> frames                          = { };
+
+    // Shared by every frame, whether each object passed the last Late phase. Written in one
+    // frame and read in the next, so only replaced with the device idle
+    VkBuffer visibilityBuffer                              = nullptr;
+    MemoryAllocation visibilityMemory                      = { };
+    uint32_t visibilityCapacity                            = 0;
+    bool visibilityCleared                                 = false;
+
+    // Rebuilt every frame, so moves in the geometry pool are picked up
+    std::vector<CullMesh> meshes                           = { };
+    std::unordered_map<const Model*, uint32_t> meshByModel = { };
+
+    void createCullPipeline();
+    void createHiZPipeline();
+    void createFrameData(VkDescriptorSetLayout drawSetLayout, const std::vector<VkBuffer>& cameraBuffers);
+    void createHiZ(FrameData& frame, VkExtent2D depthExtent);
+    void destroyHiZ(FrameData& frame);
+
+    // Grow the frame's buffers; the sets are rewritten when any is replaced
+    void reserveObjects(FrameData& frame, uint32_t objectCount);
+    void reserveMeshes(FrameData& frame, uint32_t meshCount);
+    void reserveVisibility(uint32_t objectCount);
+    void writeDescriptors(FrameData& frame);
+    uint32_t meshFor(Model& model);
+
+    void buildHiZ(VkCommandBuffer commandBuffer, FrameData& frame, VkImageView depthView);
+    void dispatchCull(VkCommandBuffer commandBuffer, FrameData& frame, Phase phase);
+
+public:
+    // cameraBuffers holds one RenderSystem::CameraData uniform buffer per frame in flight
+    GpuCulling(Device& device, VkDescriptorSetLayout drawSetLayout, const std::vector<VkBuffer>& cameraBuffers, VkDeviceSize cameraSize);
+    ~GpuCulling();
+
+    // Delete copy constructor and copy operator
+    GpuCulling(const GpuCulling&)            = delete;
+    GpuCulling& operator=(const GpuCulling&) = delete;
+
+    // Outside the render pass, once the frame's camera buffer is written: sends the objects
+    // and records the culling dispatch of phase All or Early. On Early the Hi-Z pyramid is
+    // resized to depthExtent here, before the cull set is bound
+    const Result& cull(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<Object>& objects,
+                       Phase phase = Phase::All, VkExtent2D depthExtent = { });
+
+    // Between SwapChain::Pass::Early and Late: builds the Hi-Z pyramid from the depth Early left
+    // and records the Late dispatch, replacing the draws of Early with those of Late
+    const Result& cullOccluded(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImageView depthView);
+    const Result& getResult(uint32_t frameIndex) const { return this->frames[frameIndex].result; }
+
+    // Inside the render pass, with the pipeline, geometry and drawSet bound: the draws culling
+    // kept for one pipeline, as a single indirect draw
+    void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t pipeline) const;
+};
\ No newline at end of file
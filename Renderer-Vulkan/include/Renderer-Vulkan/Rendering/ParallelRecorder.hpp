@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <Device.hpp>
+#include <WorkerPool.hpp>
+#include <Rendering/Renderer.hpp>
+
+// Records the draws of a render pass on a WorkerPool. Every worker has its own VkCommandPool
+// per frame in flight, so workers share nothing while recording; each records one secondary
+// command buffer continuing the pass, which the primary then executes in worker order
+class ParallelRecorder
+{
+private:
+    struct WorkerFrame
+    {
+        VkCommandPool commandPool     = nullptr;
+        VkCommandBuffer commandBuffer = nullptr;
+    };
+
+    Device& device;
+    WorkerPool workers;
+    std::vector<WorkerFrame> workerFrames = { };  // By frame in flight, then by worker
+    std::vector<VkCommandBuffer> recorded = { };
+
+    void createWorkerFrames();
+
+public:
+    // Counts the calling thread; 0 is one worker per hardware thread
+    ParallelRecorder(Device& device, uint32_t workerCount = 0);
+    ~ParallelRecorder();
+
+    // Delete copy constructor and copy operator
+    ParallelRecorder(const ParallelRecorder&)            = delete;
+    ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+    uint32_t getWorkerCount() const { return this->workers.getWorkerCount(); }
+
+    // Calls record(worker, commandBuffer) on jobCount workers at once, each with a secondary
+    // command buffer that continues target and has its viewport and scissor set, then executes
+    // them from primaryCommandBuffer. The pass must have begun with
+    // VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+    void record(VkCommandBuffer primaryCommandBuffer,
+                uint32_t frameIndex,
+                uint32_t jobCount,
+                const RenderPassTarget& target,
+                const std::function<void(uint32_t, VkCommandBuffer)>& record);
+};
\ No newline at end of file
@@ -1,30 +1,202 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <Pipeline.hpp>
 #include <Device.hpp>
 #include <Objects/Object.hpp>
 #include <Camera.hpp>
+#include <Stats.hpp>
+#include <Rendering/FrustumCuller.hpp>
+#include <Rendering/DrawQueue.hpp>
+#include <Rendering/GpuCulling.hpp>
+#include <Rendering/ParallelRecorder.hpp>
+#include <Rendering/Renderer.hpp>
 
+// Draws objects grouped by model: each frame the model matrices of every object sharing a
+// Model and LOD are written next to each other into a per-frame object storage buffer, and
+// each group is one instanced draw that indexes it by gl_InstanceIndex. The camera comes
+// from a per-frame uniform buffer, so the CPU multiplies no matrices per object. Where the
+// device supports it, GpuCulling moves the grouping, culling and LOD selection to a compute pass.
+// On the CPU paths FrustumCuller drops objects outside the view before any of that, the draws
+// are ordered by a DrawQueue and recorded through a StateTracker, and with parallel recording
+// on they are split across a ParallelRecorder's workers. The GPU-driven path can also cull
+// occluded objects, drawing in two passes around a Hi-Z pyramid of the first one's depth
 class RenderSystem
 {
+public:
+    enum class DrawPath
+    {
+        PerObject,  // One draw per object, for comparison
+        Instanced,  // One instanced draw per model and LOD
+        GpuDriven   // Culled by Cull.comp, one indirect draw per pipeline; see supportsGpuDriven()
+    };
+
+    // Specialization constants of Vertex.vert and Fragment.frag; what is off is compiled out
+    struct ShaderFeatures
+    {
+        bool vertexColor  = true;   // Off colors each object by Object::color
+        bool lighting     = false;  // A fixed directional light with some ambient
+        bool alphaTest    = false;  // Discards fragments whose alpha is below alphaCutoff
+        float alphaCutoff = 0.5f;
+    };
+
+    // Set 0, binding 0. The frustum and LOD parameters are only read by Cull.comp
+    struct CameraData
+    {
+        glm::mat4 projection       = glm::mat4();
+        glm::mat4 view             = glm::mat4();
+        glm::mat4 projectionView   = glm::mat4();
+        glm::vec4 frustumPlanes[6] = { };
+        glm::vec4 lod              = glm::vec4();  // Pixel error, pixels per unit at depth 1, perspective, LOD selection on
+    };
+
+    // Set 0, binding 1, an std430 array
+    struct ObjectData
+    {
+        glm::mat4 transform   = glm::mat4();  // Model matrix
+        glm::vec4 color       = glm::vec4();
+        glm::vec4 decodeScale = glm::vec4(1.0f);  // Per axis, what Cull.comp folded into transform; normals skip it
+    };
+
+    static constexpr uint32_t MIN_OBJECTS          = 1024;
+    static constexpr uint32_t MIN_DRAWS_PER_WORKER = 1024;  // Fewer are not worth waking a worker for
+
 private:
+    // Host visible and mapped, rewritten every frame they are in flight for
+    struct FrameData
+    {
+        VkBuffer cameraBuffer         = nullptr;
+        MemoryAllocation cameraMemory = { };
+        VkBuffer objectBuffer         = nullptr;
+        MemoryAllocation objectMemory = { };
+        uint32_t objectCapacity       = 0;
+        VkDescriptorSet descriptorSet = nullptr;
+    };
+
+    // Objects of one model, by LOD. Kept across frames for their capacity
+    struct InstanceGroup
+    {
+        Model* model                              = nullptr;
+        std::vector<std::vector<ObjectData>> lods = { };
+        std::vector<std::vector<float>> depths    = { };  // View space, of each object in lods
+    };
+
+    // One draw: count of a group's instances at one LOD from first, written to the object
+    // buffer from firstInstance. The whole LOD instanced, a single object on DrawPath::PerObject
+    struct DrawItem
+    {
+        uint32_t group         = 0;
+        uint32_t lod           = 0;
+        uint32_t first         = 0;
+        uint32_t firstInstance = 0;
+        uint32_t count         = 0;
+    };
+
     Device& device;
 
-    std::unique_ptr<Pipeline> pipeline = nullptr;
-    VkPipelineLayout pipelineLayout    = nullptr;
+    // One pipeline per Model::VertexFormat
+    std::unique_ptr<Pipeline> pipeline          = nullptr;
+    std::unique_ptr<Pipeline> quantizedPipeline = nullptr;
+    VkPipelineLayout pipelineLayout             = nullptr;
+    VkDescriptorSetLayout frameSetLayout        = nullptr;
+    VkDescriptorPool descriptorPool             = nullptr;
+    VkRenderPass renderPass                     = nullptr;
+    ShaderFeatures shaderFeatures               = { };
+
+    // LODs are picked so their error covers at most lodPixelError pixels on screen
+    bool lodSelection                           = true;
+    float lodPixelError                         = 1.0f;
+    FrameStats frameStats                       = { };
+
+    DrawPath drawPath                                       = DrawPath::Instanced;
+    bool occlusionCulling                                   = false;
+    FrustumCuller frustumCuller                             = { };
+    std::unique_ptr<GpuCulling> gpuCulling                  = nullptr;  // Only where supported
+    double cullMilliseconds                                 = 0.0;
+    std::vector<FrameData> frames                           = { };  // One per frame in flight
+    std::vector<InstanceGroup> groups                       = { };
+    uint32_t groupCount                                     = 0;  // In use this frame
+    std::unordered_map<const Model*, uint32_t> groupByModel = { };
+    std::vector<DrawItem> drawItems                         = { };  // This frame's, in the order they were planned
+    DrawQueue drawQueue                                     = { };  // Of drawItems, in the order they are recorded
+    bool parallelRecording                                  = false;
+    std::unique_ptr<ParallelRecorder> parallelRecorder      = nullptr;  // Kept once created, its pools may be in flight
+    std::vector<FrameStats> workerStats                     = { };
 
     void createPiplineLayout();
-    void createPipeline(VkRenderPass renderPass);
+    void createPipeline();
+    void createFrameData();
+
+    // The draws GpuCulling kept, one indirect draw per pipeline
+    void drawCulled(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+    // Sorts this frame's visible objects into groups; returns the object count
+    uint32_t groupObjects(std::vector<Object>& objects, const Camera& camera, float viewportHeight);
+    ObjectData* mapObjects(uint32_t frameIndex, uint32_t objectCount);
+
+    // Lays the groups out in drawItems and sorts them into drawQueue; returns the draw count
+    uint32_t planDraws();
+
+    // Writes the instances of queued draws firstDraw up to lastDraw and records them. Only reads
+    // the render system, so workers can record disjoint ranges at once
+    void recordDraws(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, ObjectData* objectData,
+                     uint32_t firstDraw, uint32_t lastDraw, FrameStats& stats) const;
+    void writeCamera(uint32_t frameIndex, const Camera& camera, float viewportHeight);
+
+    uint32_t selectLod(const Model& model, const TransformComponent& transform, const glm::mat4& modelMatrix,
+                       const Camera& camera, float viewportHeight) const;
 
 public:
-    RenderSystem(Device& device, const VkRenderPass& renderPass);
+    RenderSystem(Device& device, const VkRenderPass& renderPass, const ShaderFeatures& shaderFeatures);
     ~RenderSystem();
 
     // Delete copy constructor and copy operator
     RenderSystem(const RenderSystem&)            = delete;
     RenderSystem& operator=(const RenderSystem&) = delete;
 
-    void renderObjects(VkCommandBuffer commandBuffer, std::vector<Object>& objects, const Camera& camera);
+    // Before the render pass begins; records the culling dispatch on the GPU-driven path and
+    // does nothing on the others
+    void cullObjects(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<Object>& objects, const Camera& camera, const RenderPassTarget& target);
+
+    // Inside the render pass of target, begun with getSubpassContents() as getFirstPass()
+    void renderObjects(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<Object>& objects, const Camera& camera, const RenderPassTarget& target);
+
+    // With occlusion culling, after the first pass ends: cullOccluded() tests the objects it did
+    // not draw against its depth, and renderOccluded() draws those found visible inside
+    // SwapChain::Pass::Late
+    void cullOccluded(VkCommandBuffer commandBuffer, uint32_t frameIndex, const RenderPassTarget& target);
+    void renderOccluded(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+    // Off draws every object at full detail
+    void setLodSelection(bool enabled) { this->lodSelection = enabled; }
+    void setLodPixelError(float pixelError) { this->lodPixelError = pixelError; }
+    void setDrawPath(DrawPath drawPath);
+
+    // Swaps in the pipelines of another variant; those in flight stay alive in the PipelineLibrary.
+    // renderPass is the current one, as the swap chain may have been recreated since construction
+    void setShaderFeatures(const ShaderFeatures& features, VkRenderPass renderPass);
+    const ShaderFeatures& getShaderFeatures() const { return this->shaderFeatures; }
+    DrawPath getDrawPath() const { return this->drawPath; }
+
+    // Objects moved after they were first drawn must be reported to it through moved()
+    FrustumCuller& getFrustumCuller() { return this->frustumCuller; }
+
+    // Only takes effect on the GPU-driven path
+    void setOcclusionCulling(bool enabled) { this->occlusionCulling = enabled; }
+    bool isOcclusionCulling() const { return this->occlusionCulling && this->drawPath == DrawPath::GpuDriven; }
+    SwapChain::Pass getFirstPass() const { return this->isOcclusionCulling() ? SwapChain::Pass::Early : SwapChain::Pass::Whole; }
+
+    // Records the CPU paths' draws into secondary command buffers, on one worker per hardware thread
+    void setParallelRecording(bool enabled);
+    bool isRecordingParallel() const { return this->parallelRecording && this->drawPath != DrawPath::GpuDriven; }
+    uint32_t getRecordingThreads() const;
+    VkSubpassContents getSubpassContents() const;
+
+    // Needs multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount
+    bool supportsGpuDriven() const { return this->gpuCulling != nullptr; }
+
+    const FrameStats& getFrameStats() const { return this->frameStats; }
 };
\ No newline at end of file
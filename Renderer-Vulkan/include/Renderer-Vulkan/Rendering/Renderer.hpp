@@ -1,11 +1,24 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <cassert>
 
 #include <Window.hpp>
 #include <Device.hpp>
 #include <SwapChain.hpp>
+#include <FrameCapture.hpp>
+
+// The render pass instance being recorded, all a secondary command buffer continuing it needs
+struct RenderPassTarget
+{
+    VkRenderPass renderPass        = nullptr;
+    VkFramebuffer framebuffer      = nullptr;
+    VkExtent2D extent              = { };
+    VkImage depthImage             = nullptr;
+    VkImageView depthView          = nullptr;  // Sampled between SwapChain::Pass::Early and Late
+    VkImageAspectFlags depthAspect = 0;
+};
 
 class Renderer
 {
@@ -14,10 +27,14 @@ private:
     Device& device;
     std::unique_ptr<SwapChain> swapChain        = nullptr;
     std::vector<VkCommandBuffer> commandBuffers = { };
+    std::unique_ptr<FrameCapture> capture       = nullptr;
         
     uint32_t currentImageIndex                  = 0;
     uint32_t currentFrameIndex                  = 0;
     bool isFrameStarted                         = false;
+    std::vector<VkPresentModeKHR> presentModes  = SwapChain::getPresentModes(SwapChain::PresentProfile::VSync);
+    uint32_t swapChainRecreations               = 0;
+    uint64_t uploadWaitValue                    = 0;  // Timeline value the current frame's submission waits for
 
     void createCommandBuffers();
     void freeCommandBuffers();
@@ -33,11 +50,37 @@ public:
 
     VkCommandBuffer beginFrame();
     void endFrame();
-    void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+
+    // With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass only takes vkCmdExecuteCommands,
+    // and the secondary command buffers set their own viewport and scissor. A frame either has
+    // one SwapChain::Pass::Whole, or an Early followed by a Late
+    void beginSwapChainRenderPass(VkCommandBuffer commandBuffer,
+                                  VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE,
+                                  SwapChain::Pass pass       = SwapChain::Pass::Whole);
     void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
     VkRenderPass getSwapChainRenderPass() const;
+    RenderPassTarget getRenderPassTarget() const;
     float getAspectRatio() const;
+    VkExtent2D getSwapChainExtent() const;
     bool isFrameInProgress() const;
     VkCommandBuffer getCurrentCommandBuffer() const;
     uint32_t getFrameIndex() const;
+
+    // Every frame from now on is copied out at the end of endFrame and written to directory
+    // in the background, see FrameCapture. Not while a frame is in progress
+    void startCapture(const std::string& directory, FrameCapture::Format format);
+
+    // Waits for the frames still being written, and returns the stats of the whole capture
+    CaptureStats stopCapture();
+    bool isCapturing() const;
+
+    // Recreates the swap chain with the first of modes the surface supports, FIFO failing
+    // that. Not while a frame is in progress
+    void setPresentModes(const std::vector<VkPresentModeKHR>& modes);
+    void setPresentProfile(SwapChain::PresentProfile profile);
+    VkPresentModeKHR getPresentMode() const;
+    PresentStats getPresentStats() const;
+
+    // Covers the whole extent, as every pipeline's viewport and scissor are dynamic
+    static void setViewport(VkCommandBuffer commandBuffer, VkExtent2D extent);
 };
\ No newline at end of file
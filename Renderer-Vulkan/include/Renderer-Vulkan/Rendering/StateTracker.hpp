@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Device.hpp>
+#include <Pipeline.hpp>
+#include <Stats.hpp>
+
+// Binds through a tracker skip whatever its command buffer already has bound, and count both
+// the binds issued and those skipped into a FrameStats. One per command buffer, as a new one,
+// secondary or primary, starts with nothing bound. Descriptor sets are kept across pipeline
+// binds, so every pipeline recorded through one tracker must share a pipeline layout
+class StateTracker
+{
+private:
+    VkCommandBuffer commandBuffer = nullptr;
+    FrameStats& stats;
+
+    const Pipeline* pipeline      = nullptr;
+    VkDescriptorSet descriptorSet = nullptr;
+    VkBuffer vertexBuffer         = nullptr;
+    VkBuffer indexBuffer          = nullptr;
+
+public:
+    StateTracker(VkCommandBuffer commandBuffer, FrameStats& stats);
+
+    // Delete copy constructor and copy operator
+    StateTracker(const StateTracker&)            = delete;
+    StateTracker& operator=(const StateTracker&) = delete;
+
+    void bindPipeline(Pipeline& pipeline);
+    void bindDescriptorSet(VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet);
+    void bindVertexBuffer(VkBuffer vertexBuffer);
+    void bindIndexBuffer(VkBuffer indexBuffer);
+};
\ No newline at end of file
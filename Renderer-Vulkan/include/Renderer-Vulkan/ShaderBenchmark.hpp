@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <Benchmark.hpp>
+#include <Camera.hpp>
+#include <Model.hpp>
+#include <Stats.hpp>
+#include <Objects/Object.hpp>
+#include <Rendering/RenderSystem.hpp>
+
+// Frame time of a fill-bound scene under each RenderSystem::ShaderFeatures variant: layers of
+// copies of one model, each scaled to cover the screen, drawn instanced. Every variant only
+// pays for the features it compiles in, so each step against the bare one is the per-pixel
+// cost of a feature. Every other layer, from the nearest on, has an alpha below the cutoff, so
+// the alpha test variant discards it and draws the layer behind. Alpha test also turns early
+// depth testing off, which is part of its cost
+class ShaderBenchmark : public Benchmark
+{
+public:
+    static constexpr uint32_t LAYERS       = 64;
+    static constexpr float LAYER_SPACING   = 0.05f;
+    static constexpr float CUTOUT_ALPHA    = 0.25f;  // Under ShaderFeatures' default alphaCutoff
+    static constexpr float WARMUP_SECONDS  = 1.0f;  // Also covers compiling the variant
+    static constexpr float MEASURE_SECONDS = 3.0f;
+
+    struct Step
+    {
+        RenderSystem::ShaderFeatures features = { };
+        uint32_t frames                       = 0;
+        double seconds                        = 0.0;
+    };
+
+private:
+    std::shared_ptr<Model> model = nullptr;
+    std::vector<Step> steps      = { };
+    Step current                 = { };
+    float elapsed                = 0.0f;
+
+    void layoutObjects(std::vector<Object>& objects) const;
+    void beginStep(const RenderSystem::ShaderFeatures& features, RenderSystem& renderSystem, VkRenderPass renderPass);
+
+    static std::vector<RenderSystem::ShaderFeatures> variants();
+    static std::string stepName(const Step& step);
+
+public:
+    ShaderBenchmark(std::shared_ptr<Model> model);
+
+    // Delete copy constructor and copy operator
+    ShaderBenchmark(const ShaderBenchmark&)            = delete;
+    ShaderBenchmark& operator=(const ShaderBenchmark&) = delete;
+
+    void begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    // Feed every recorded frame; returns false once every step is measured
+    bool update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass) override;
+
+    void setCamera(Camera& camera, float aspect) const override;
+    void print(std::ostream& out) const override;
+};
\ No newline at end of file
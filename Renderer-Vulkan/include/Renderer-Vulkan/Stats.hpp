@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <ostream>
+
+// Post-transform vertex cache efficiency of an index buffer
+struct VertexCacheStats
+{
+    float acmr = 0.0f;  // Average cache miss ratio: vertex shader invocations per triangle
+    float atvr = 0.0f;  // Average transformed vertex ratio: invocations per vertex, 1.0 is ideal
+};
+
+// Counters for the last frame recorded by RenderSystem::renderObjects
+struct FrameStats
+{
+    uint32_t objects               = 0;  // Drawn, or sent to culling on the GPU-driven path
+    uint32_t streaming             = 0;  // Skipped, geometry not on the graphics queue yet
+    uint32_t culled                = 0;  // Outside the frustum, by FrustumCuller on the CPU paths
+    uint32_t occluded              = 0;  // Behind the Hi-Z pyramid, GPU-driven; as of the frame's last use
+    uint32_t geometryBinds         = 0;  // Vertex and index buffer binds, part of stateBinds
+    uint32_t stateBinds            = 0;  // Pipeline, descriptor set, vertex and index buffer binds, geometry included
+    uint32_t bindsAvoided          = 0;  // Binds a draw needed that StateTracker found already bound
+    uint32_t drawCalls             = 0;  // Per model and LOD instanced, per object, or per pipeline GPU-driven
+    double cpuMilliseconds         = 0.0;  // Spent recording, grouping, writing instances and culling included
+    double cullMilliseconds        = 0.0;  // Of that, syncing and testing spheres against the frustum
+    uint64_t triangles             = 0;  // Submitted, after LOD selection; unknown to the CPU when GPU-driven
+    uint64_t fullDetailTriangles   = 0;  // Had every object been drawn at LOD 0
+    std::vector<uint32_t> lodDraws = { };  // Objects drawn at each LOD
+
+    void reset();
+};
+
+// Device memory by heap, from MemoryAllocator::getStats
+struct MemoryStats
+{
+    struct Heap
+    {
+        uint64_t size           = 0;
+        bool deviceLocal        = false;
+        uint32_t blockCount     = 0;
+        uint64_t blockBytes     = 0;  // Reserved by blocks
+        uint64_t usedBytes      = 0;  // Handed out from blocks
+        uint32_t dedicatedCount = 0;
+        uint64_t dedicatedBytes = 0;
+    };
+
+    std::vector<Heap> heaps     = { };
+    uint32_t allocationCount    = 0;  // Live VkDeviceMemory objects
+    uint32_t maxAllocationCount = 0;
+    uint64_t allocateCalls      = 0;  // vkAllocateMemory calls so far
+
+    void print(std::ostream& out) const;
+};
+
+// Staging traffic, from UploadManager::getStats
+struct UploadStats
+{
+    bool dedicatedQueue         = false;  // On a transfer queue family of its own
+    uint64_t uploads            = 0;
+    uint64_t bytes              = 0;
+    uint64_t regions            = 0;  // Recorded copy regions, after merging adjacent uploads
+    uint64_t batches            = 0;  // Queue submissions
+    uint64_t ownershipTransfers = 0;  // Buffers released to the graphics family
+    uint64_t stalls             = 0;  // Waits for the ring to free space
+    uint64_t waits              = 0;  // Blocking UploadManager::wait calls
+
+    void print(std::ostream& out) const;
+};
+
+// Shared vertex and index buffers, from GeometryPool::getStats
+struct GeometryStats
+{
+    struct Arena
+    {
+        uint64_t stride   = 0;
+        uint64_t capacity = 0;  // In bytes
+        uint64_t used     = 0;  // In bytes, by live ranges
+        bool indices      = false;
+    };
+
+    std::vector<Arena> arenas = { };  // Vertex arenas by stride, then the index buffer
+    uint32_t liveRanges       = 0;  // Models drawn from the pool
+    uint32_t compactions      = 0;  // Rebuilds that moved live ranges
+
+    void print(std::ostream& out) const;
+};
+
+// Frames read back to image files, from FrameCapture::getStats
+struct CaptureStats
+{
+    uint64_t frames           = 0;  // Copies recorded
+    uint64_t bytes            = 0;  // Read back
+    uint64_t written          = 0;  // Image files finished
+    uint64_t stalls           = 0;  // Frames that waited for the writer to catch up
+    double renderMilliseconds = 0.0;  // On the render thread, recording copies and handing them off
+    double writeMilliseconds  = 0.0;  // On the writer thread
+
+    void print(std::ostream& out) const;
+};
+
+// The swap chain's presentation, from Renderer::getPresentStats
+struct PresentStats
+{
+    bool headless                      = false;  // Nothing presented, the rest is empty
+    std::string mode                   = "";  // Active
+    std::vector<std::string> requested = { };  // In order of preference
+    std::vector<std::string> supported = { };  // By the surface
+    uint32_t recreations               = 0;  // Swap chains replaced, present mode switches included
+
+    void print(std::ostream& out) const;
+};
+
+struct StartupStats
+{
+    struct ModelLoad
+    {
+        std::string filePath               = "";
+        bool warm                          = false;  // Loaded from the cooked mesh cache
+        bool streamed                      = false;  // Through ModelStreamer, which never caches
+        double milliseconds                = 0.0;
+        bool optimized                     = false;  // Reordered on this load, so the cache stats below are set
+        VertexCacheStats cacheBefore       = { };
+        VertexCacheStats cacheAfter        = { };
+        std::vector<uint32_t> lodTriangles = { };  // Finest first
+        float lodError                     = 0.0f;  // Of the coarsest LOD, in model units
+        bool quantized                     = false;  // Model::VertexFormat::Quantized
+        uint64_t vertexBytes               = 0;
+    };
+
+    // Pipeline objects, warm when the PipelineCache was loaded from disk
+    struct PipelineCreation
+    {
+        std::string shaderPath = "";  // The vertex or compute shader
+        bool warm              = false;
+        double milliseconds    = 0.0;
+    };
+
+    std::vector<ModelLoad> modelLoads               = { };
+    std::vector<PipelineCreation> pipelineCreations = { };
+    uint32_t pipelineRequests                       = 0;  // Identical ones are created once
+    uint32_t pipelineThreads                        = 0;  // Compiling in parallel
+    double pipelineMilliseconds                     = 0.0;  // Until all were ready, on the clock
+
+    void print(std::ostream& out) const;
+};
\ No newline at end of file
@@ -10,12 +10,36 @@
 
 class SwapChain
 {
+public:
+    // Render passes over the same framebuffers, all compatible with each other. Occlusion culling
+    // splits the frame in two: Early keeps the depth for sampling, Late carries on drawing over it
+    enum class Pass
+    {
+        Whole,  // Clears, then presents (headless, leaves colour in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        Early,  // Clears, then leaves colour and depth as attachments
+        Late,   // Loads what Early left, then presents like Whole
+        Count
+    };
+
+    // Presentation policies, each a fallback order of present modes. FIFO, which every surface
+    // supports, is the last resort of all of them
+    enum class PresentProfile
+    {
+        VSync,       // FIFO: capped to the display, never tears
+        Adaptive,    // FIFO_RELAXED: capped, but a late frame tears instead of waiting a refresh
+        LowLatency,  // MAILBOX, else IMMEDIATE: the newest frame at each refresh
+        Uncapped,    // IMMEDIATE, else MAILBOX: never waits for the display, for benchmarks
+        Count
+    };
+
 private:
     void init();
     void createSwapChain();
+    void createOffscreenImages();
     void createImageViews();
     void createDepthResources();
     void createRenderPass();
+    VkRenderPass createRenderPass(Pass pass);
     void createFramebuffers();
     void createSyncObjects();
 
@@ -26,17 +50,23 @@ private:
         const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 
+    std::vector<VkPresentModeKHR> presentModes          = { };  // Requested, in order of preference
+    std::vector<VkPresentModeKHR> availablePresentModes = { };
+    VkPresentModeKHR presentMode                        = VK_PRESENT_MODE_FIFO_KHR;
+
     VkFormat swapChainImageFormat                     = { };
+    VkImageUsageFlags swapChainImageUsage             = 0;
     VkFormat swapChainDepthFormat                     = { };
     VkExtent2D swapChainExtent                        = { };
 
-    std::vector<VkFramebuffer> swapChainFramebuffers  = { };
-    VkRenderPass renderPass                           = { };
+    std::vector<VkFramebuffer> swapChainFramebuffers            = { };
+    VkRenderPass renderPasses[static_cast<size_t>(Pass::Count)] = { };
 
     std::vector<VkImage> depthImages                  = { };
-    std::vector<VkDeviceMemory> depthImageMemorys     = { };
+    std::vector<MemoryAllocation> depthImageMemorys   = { };
     std::vector<VkImageView> depthImageViews          = { };
     std::vector<VkImage> swapChainImages              = { };
+    std::vector<MemoryAllocation> offscreenMemorys    = { };  // Headless only, where the images are our own
     std::vector<VkImageView> swapChainImageViews      = { };
 
     Device& device;
@@ -54,27 +84,44 @@ private:
 public:
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
-    SwapChain(Device& deviceRef, VkExtent2D windowExtent);
-    SwapChain(Device& deviceRef, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previous);
+    SwapChain(Device& deviceRef, VkExtent2D windowExtent, const std::vector<VkPresentModeKHR>& presentModes);
+    SwapChain(Device& deviceRef, VkExtent2D windowExtent, const std::vector<VkPresentModeKHR>& presentModes, std::shared_ptr<SwapChain> previous);
     ~SwapChain();
 
     SwapChain(const SwapChain&)           = delete;
     SwapChain operator=(const SwapChain&) = delete;
 
-    VkFramebuffer getFrameBuffer(int index) { return swapChainFramebuffers[index]; }
-    VkRenderPass getRenderPass()            { return renderPass;                   }
-    VkImageView getImageView(int index)     { return swapChainImageViews[index];   }
-    size_t imageCount()                     { return swapChainImages.size();       }
-    VkFormat getSwapChainImageFormat()      { return swapChainImageFormat;         }
-    VkExtent2D getSwapChainExtent()         { return swapChainExtent;              }
-    uint32_t width()                        { return swapChainExtent.width;        }
-    uint32_t height()                       { return swapChainExtent.height;       }
+    VkFramebuffer getFrameBuffer(int index)              { return swapChainFramebuffers[index];              }
+    VkRenderPass getRenderPass(Pass pass = Pass::Whole)  { return renderPasses[static_cast<size_t>(pass)];   }
+    VkImage getImage(int index)                          { return swapChainImages[index];                    }
+    VkImageView getImageView(int index)                  { return swapChainImageViews[index];                }
+    VkImage getDepthImage(int index)                     { return depthImages[index];                        }
+    VkImageView getDepthImageView(int index)             { return depthImageViews[index];                    }
+    size_t imageCount()                                  { return swapChainImages.size();                    }
+    VkFormat getSwapChainImageFormat()                   { return swapChainImageFormat;                      }
+    VkExtent2D getSwapChainExtent()                      { return swapChainExtent;                           }
+    uint32_t width()                                     { return swapChainExtent.width;                     }
+    uint32_t height()                                    { return swapChainExtent.height;                    }
+
+    static std::vector<VkPresentModeKHR> getPresentModes(PresentProfile profile);
+    static const char* getPresentModeName(VkPresentModeKHR mode);
+
+    // The first requested mode the surface supports; meaningless headless, where nothing is presented
+    VkPresentModeKHR getPresentMode() const                               { return presentMode;           }
+    const std::vector<VkPresentModeKHR>& getRequestedPresentModes() const { return presentModes;          }
+    const std::vector<VkPresentModeKHR>& getAvailablePresentModes() const { return availablePresentModes; }
+
+    // Where Whole and Late leave the colour image, and whether it can be copied from there
+    VkImageLayout getFinalLayout() const;
+    bool canCopyImages() const { return swapChainImageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT; }
 
     float extentAspectRatio() { return static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height); }
     VkFormat findDepthFormat();
+    VkImageAspectFlags getDepthAspect() const;  // What barriers on the depth images cover
 
     VkResult acquireNextImage(uint32_t* imageIndex);
-    VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
+    // uploadWaitValue is from UploadManager::acquire, waited on at vertex input when not 0
+    VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex, uint64_t uploadWaitValue = 0);
 
     bool compareSwapFormat(const SwapChain& swapChain) const;
 };
\ No newline at end of file
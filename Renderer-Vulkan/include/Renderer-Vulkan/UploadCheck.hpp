@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include <Device.hpp>
+
+// Ordering check of the UploadManager against whatever device is picked, meant for a headless
+// run on a software ICD such as lavapipe. Each round uploads a fresh pattern on the transfer
+// queue, then copies the buffer back on the graphics queue behind the batch's timeline value
+// and compares it, so a read that ran before the upload finished shows up as stale data.
+// Half the rounds use a buffer shared with the transfer family, half one handed over with
+// acquire(). When the two queues differ, the shared rounds also submit the read before the
+// upload batch, and check it stays blocked until the timeline value is signalled
+class UploadCheck
+{
+public:
+    static constexpr uint32_t ROUNDS       = 64;
+    static constexpr VkDeviceSize BYTES    = 4 * 1024 * 1024;
+    static constexpr uint32_t BLOCKED_WAIT = 20;  // Milliseconds a read waiting on the timeline must stay blocked
+
+private:
+    Device& device;
+    VkCommandBuffer commandBuffer   = nullptr;
+    VkFence fence                   = nullptr;
+    VkBuffer readback               = nullptr;
+    MemoryAllocation readbackMemory = { };
+
+    uint32_t stale                  = 0;  // Rounds whose read saw anything but the new pattern
+    uint32_t early                  = 0;  // Reads that finished before their timeline value
+    uint32_t blockedChecks          = 0;
+    std::string report              = "";
+
+    // Copies buffer into readback on the graphics queue, waiting for the timeline at waitValue
+    void beginRead();
+    void submitRead(VkBuffer buffer, uint64_t waitValue);
+
+    void round(uint32_t index, bool shared);
+
+public:
+    UploadCheck(Device& device);
+    ~UploadCheck();
+
+    // Delete copy constructor and copy operator
+    UploadCheck(const UploadCheck&)            = delete;
+    UploadCheck& operator=(const UploadCheck&) = delete;
+
+    void run();
+
+    bool passed() const { return this->stale == 0 && this->early == 0; }
+    void print(std::ostream& out) const;
+};
\ No newline at end of file
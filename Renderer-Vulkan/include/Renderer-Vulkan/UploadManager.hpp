@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include <MemoryAllocator.hpp>
+#include <Stats.hpp>
+
+class Device;
+
+// Completion handle for uploads, the timeline value of the batch that carries them. 0 is always complete
+using UploadTicket = uint64_t;
+
+// Uploads to device local buffers through one persistently mapped staging ring. Copies are
+// recorded into a batch command buffer that is submitted on flush(), or once the ring needs
+// the space back, so loading many models costs one submission instead of a queue round trip
+// each. Adjacent copies into the same buffer share a region.
+//
+// Batches run on the device's transfer queue and signal a timeline semaphore with their
+// ticket. When that queue is a dedicated family, every buffer handed over is released to
+// the graphics family, and acquire() records the matching acquires into a frame once the
+// batch is done, so rendering never waits on a transfer in progress. Buffers created shared
+// with the transfer family skip the ownership transfer and only need the timeline wait.
+// Otherwise batches share the graphics queue and end with a barrier making their writes
+// visible to it.
+//
+// A buffer is only safe to draw from once isAcquired(); destroying or rewriting one needs wait()
+class UploadManager
+{
+public:
+    static constexpr VkDeviceSize DEFAULT_RING_SIZE = 32 * 1024 * 1024;
+    static constexpr VkDeviceSize STAGING_ALIGN     = 16;
+
+    // Writes bytes [offset, offset + size) of an upload to staging
+    using Fill = std::function<void(void* staging, VkDeviceSize offset, VkDeviceSize size)>;
+
+private:
+    struct Batch
+    {
+        VkCommandBuffer commandBuffer   = nullptr;
+        UploadTicket ticket             = 0;
+        uint64_t ringEnd                = 0;  // Ring position freed once the batch completes
+        std::vector<VkBuffer> handOvers = { };  // Released to graphics at the end of the batch
+    };
+
+    Device& device;
+    const VkDeviceSize ringSize       = 0;
+    const uint32_t transferFamily     = 0;
+    const uint32_t graphicsFamily     = 0;
+    const bool ownershipTransfer      = false;  // The two families differ
+    VkBuffer ringBuffer               = nullptr;
+    MemoryAllocation ringMemory       = { };
+    char* ring                        = nullptr;
+    VkCommandPool commandPool         = nullptr;
+    VkSemaphore timeline              = nullptr;
+
+    std::mutex mutex                  = { };
+    uint64_t head                     = 0;  // Ring positions grow forever, wrapped on use
+    uint64_t tail                     = 0;
+    Batch open                        = { };  // Being recorded, null command buffer if none
+    std::deque<Batch> inFlight        = { };  // Submitted, oldest first
+    std::vector<Batch> spare          = { };  // Completed, for reuse
+    UploadTicket nextTicket           = 1;
+    UploadTicket completed            = 0;
+
+    // Released by completed batches, waiting for acquire()
+    std::vector<VkBuffer> acquirable  = { };
+    UploadTicket acquirableTicket     = 0;
+    UploadTicket acquired             = 0;
+
+    // Copies waiting to be recorded, all into pendingBuffer
+    VkBuffer pendingBuffer            = nullptr;
+    std::vector<VkBufferCopy> pending = { };
+
+    UploadStats stats                 = { };
+
+    void beginBatch();
+    void recordPending();
+    void submitOpen();
+
+    // Recycles completed batches, first waiting for every batch up to waitFor
+    void retire(UploadTicket waitFor);
+
+    // Reserves size bytes of the ring, waiting on batches to free space; returns the offset
+    VkDeviceSize reserve(VkDeviceSize size);
+    void addCopy(VkBuffer dst, VkDeviceSize srcOffset, VkDeviceSize dstOffset, VkDeviceSize size);
+    void addHandOver(VkBuffer buffer);
+
+public:
+    UploadManager(Device& device, VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+    ~UploadManager();
+
+    // Delete copy constructor and copy operator
+    UploadManager(const UploadManager&)            = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    // Copies data into the ring right away, so it may be freed on return. Uploads larger
+    // than half the ring are split over several batches. Unless handOver is false, dst goes
+    // to the graphics queue with the last batch; buffers still being filled over several
+    // calls hand over once done with handOver()
+    UploadTicket upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, bool handOver = true);
+
+    // Same, but fill writes each piece straight into the ring, for data converted on the
+    // way up. Pieces are whole multiples of stride bytes; fill runs under the ring's lock
+    UploadTicket upload(VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size, VkDeviceSize stride, const Fill& fill, bool handOver = true);
+
+    // Device side copy, ordered after every upload recorded before it
+    UploadTicket copy(VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0, bool handOver = true);
+    UploadTicket handOver(VkBuffer buffer);
+
+    // Submits the batch being recorded, if any; returns the ticket of the newest batch
+    UploadTicket flush();
+
+    // Once per frame, before anything is drawn: submits the batch being recorded and
+    // records the acquires of every completed batch into commandBuffer, on the graphics
+    // queue. Returns the timeline value that submission must wait for, 0 if none
+    uint64_t acquire(VkCommandBuffer commandBuffer);
+    VkSemaphore timelineSemaphore() const { return this->timeline; }
+
+    // Polling a ticket of the batch being recorded submits it
+    bool isComplete(UploadTicket ticket);
+    bool isAcquired(UploadTicket ticket);
+    void wait(UploadTicket ticket);
+    void waitIdle();
+
+    UploadStats getStats();
+};
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <cstdint>
+#include <cstring>
 
 #include <Model.hpp>
 
@@ -9,4 +11,43 @@ void hashCombine(std::size_t& seed, const T& v, const Rest&... rest)
 {
     seed ^= std::hash<T>{}(v)+0x9e3779b9 + (seed << 6) + (seed >> 2);
     (hashCombine(seed, rest), ...);
-};
\ No newline at end of file
+};
+
+inline uint64_t rotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Fast non-cryptographic 64-bit hash of a byte range (xxHash64 style single lane)
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0)
+{
+    constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash              = seed + prime3 + static_cast<uint64_t>(size);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash ^= rotateLeft(word * prime2, 31) * prime1;
+        hash  = rotateLeft(hash, 27) * prime1 + prime3;
+    }
+
+    for (; i < size; i++)
+    {
+        hash ^= bytes[i] * prime3;
+        hash  = rotateLeft(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Model.hpp>
+
+// Open-addressing vertex deduplication for Model::Builder. Face corners are first
+// looked up by their source attribute indices; only on a miss is the vertex welded
+// by value, so the result is identical to welding every corner by value.
+// Constructed without a vertex array it only welds by source indices
+class VertexWelder
+{
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    struct SourceKey
+    {
+        int32_t vertexIndex   = -1;
+        int32_t normalIndex   = -1;
+        int32_t texcoordIndex = -1;
+        int32_t group         = 0;  // Anything else the Builder derives per corner (e.g. the shape color)
+    };
+
+private:
+    struct SourceSlot
+    {
+        SourceKey key  = { };
+        uint32_t index = NOT_FOUND;
+    };
+
+    struct VertexSlot
+    {
+        uint32_t hash  = 0;  // Upper half of hashVertex, checked before comparing vertices
+        uint32_t index = NOT_FOUND;
+    };
+
+    std::vector<Model::Vertex>* vertices = nullptr;
+    std::vector<SourceSlot> sourceSlots = { };
+    std::vector<VertexSlot> vertexSlots = { };
+    size_t sourceCount                  = 0;
+
+    static uint64_t hashSource(const SourceKey& key);
+    static uint64_t hashVertex(const Model::Vertex& vertex);
+
+    void rehashSource(size_t capacity);
+    void rehashVertices(size_t capacity);
+
+public:
+    // Welded vertices are appended to vertices, which must start out empty
+    VertexWelder(std::vector<Model::Vertex>& vertices, size_t expectedVertices);
+    VertexWelder(size_t expectedVertices);
+
+    // Delete copy constructor and copy operator
+    VertexWelder(const VertexWelder&)            = delete;
+    VertexWelder& operator=(const VertexWelder&) = delete;
+
+    uint32_t find(const SourceKey& key) const;
+    void insert(const SourceKey& key, uint32_t index);
+
+    // Needs the vertex array
+    uint32_t weld(const SourceKey& key, const Model::Vertex& vertex);
+};
\ No newline at end of file
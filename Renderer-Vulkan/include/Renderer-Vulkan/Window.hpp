@@ -18,11 +18,12 @@ private:
     uint32_t height         = 0;
     const std::string name  = "";
     bool frameBufferResized = false;
+    const bool headless     = false;  // No GLFW window; the SwapChain renders offscreen at this extent
 
     static void frameBufferResizedCallback(GLFWwindow* window, int width, int height);
 
 public:
-    Window(const uint32_t& width, const uint32_t& height, const std::string& name);
+    Window(const uint32_t& width, const uint32_t& height, const std::string& name, bool headless = false);
     ~Window();
 
     // Delete copy constructor and copy operator
@@ -30,9 +31,11 @@ public:
     Window& operator=(const Window&) = delete;
 
     bool shouldClose();
+    void pollEvents();
     void createWindowSurface(const VkInstance& instance, VkSurfaceKHR* const surface);
     VkExtent2D getExtent();
     bool wasWindowResized()           { return this->frameBufferResized;  }
     void resetWindowResizedFlag()     { this->frameBufferResized = false; }
     GLFWwindow* getGLFWwindow() const { return this->window;              }
+    bool isHeadless() const           { return this->headless;            }
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed set of threads that each run one job per call to run(). Job i always goes to worker
+// i, so whatever a worker owns, a command pool say, is only ever touched from one thread.
+// Tasks given to submit() instead go to whichever thread is free first
+class WorkerPool
+{
+private:
+    std::vector<std::thread> threads         = { };  // Workers 1 and up; worker 0 is the caller of run()
+    std::mutex mutex                         = { };
+    std::condition_variable started          = { };
+    std::condition_variable finished         = { };
+    const std::function<void(uint32_t)>* job = nullptr;
+    uint32_t jobCount                        = 0;
+    uint32_t pending                         = 0;  // Jobs still running on threads
+    uint64_t generation                      = 0;  // Bumped by every run()
+    bool stopping                            = false;
+    std::exception_ptr error                 = nullptr;  // First one thrown on a thread
+    std::deque<std::function<void()>> tasks  = { };  // From submit(), ahead of run()'s jobs
+
+    void work(uint32_t worker);
+    void enqueue(std::function<void()> task);
+
+public:
+    // Counts the calling thread; 0 is one worker per hardware thread
+    WorkerPool(uint32_t workerCount = 0);
+    ~WorkerPool();
+
+    // Delete copy constructor and copy operator
+    WorkerPool(const WorkerPool&)            = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    uint32_t getWorkerCount() const { return static_cast<uint32_t>(this->threads.size()) + 1; }
+
+    // Runs job(i) on worker i for every i below jobCount, job 0 on the calling thread, and
+    // returns once all are done. Rethrows the first exception a job threw
+    void run(uint32_t jobCount, const std::function<void(uint32_t)>& job);
+
+    // Runs task on a thread of the pool, or right away on the caller's when the pool has none.
+    // Queued tasks still run when the pool is destroyed, so no future is left broken
+    template <typename Task>
+    std::future<std::invoke_result_t<Task>> submit(Task task)
+    {
+        using Result  = std::invoke_result_t<Task>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        auto future   = packaged->get_future();
+
+        this->enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <chrono>
 #include <stdexcept>
 #include <array>
+#include <iostream>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -11,9 +12,23 @@
 #include <Rendering/RenderSystem.hpp>
 #include <KeyboardMovementController.hpp>
 #include <Camera.hpp>
+#include <LodBenchmark.hpp>
+#include <InstancingBenchmark.hpp>
+#include <CullingBenchmark.hpp>
+#include <ShaderBenchmark.hpp>
+#include <ModelStreamer.hpp>
 
-Application::Application()
+Application::Application(Scene scene, Model::VertexFormat format, bool headless, VkExtent2D extent, uint32_t frameLimit, bool streamModels) :
+    window(extent.width, extent.height, "Renderer in Vulkan", headless),
+    scene(scene),
+    format(format),
+    frameLimit(headless && frameLimit == 0 && scene == Scene::Test ? HEADLESS_FRAMES : frameLimit),
+    streamModels(streamModels)
 {
+    // Benchmarks measure the renderer, not the display's refresh rate
+    if (this->scene != Scene::Test)
+        this->setPresentProfile(SwapChain::PresentProfile::Uncapped);
+
     this->loadObjects();
 }
 
@@ -22,47 +37,158 @@ Application::~Application() { }
 void
 Application::run()
 {
-    RenderSystem renderSystem = { this->device, this->renderer.getSwapChainRenderPass() };
+    const auto pipelineStart  = std::chrono::high_resolution_clock::now();
+    RenderSystem renderSystem = { this->device, this->renderer.getSwapChainRenderPass(), this->shaderFeatures };
     Camera camera             = { };
 
+    // Every pipeline is requested once the render system exists; waited for here only to be timed
+    this->device.pipelines().wait();
+    const auto pipelineEnd = std::chrono::high_resolution_clock::now();
+
+    this->startupStats.pipelineCreations    = this->device.pipelineCache().getCreations();
+    this->startupStats.pipelineRequests     = this->device.pipelines().getRequestCount();
+    this->startupStats.pipelineThreads      = this->device.pipelines().getThreadCount();
+    this->startupStats.pipelineMilliseconds = std::chrono::duration<double, std::milli>(pipelineEnd - pipelineStart).count();
+    this->startupStats.print(std::cout);
+    this->renderer.getPresentStats().print(std::cout);
+
+    std::unique_ptr<Benchmark> benchmark = this->createBenchmark();
+    if (benchmark)
+        benchmark->begin(this->objects, renderSystem, this->renderer.getSwapChainRenderPass());
+
     //camera.setViewDirection(glm::vec3(0.0f), glm::vec3(0.5f, 0.0f, 1.0f));
     //camera.setViewTarget(glm::vec3(-1.0f, -2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 2.5f));
 
     KeyboardMovementController cameraController = { };
     Object viewerObject                         = Object::createObject();
     auto currentTime                            = std::chrono::high_resolution_clock::now();
+    uint32_t frameCount                         = 0;
+    bool profileKeyHeld                         = false;
+    bool lightingKeyHeld                        = false;
 
-    while (!window.shouldClose())
+    while (!window.shouldClose() && (this->frameLimit == 0 || frameCount < this->frameLimit))
     {
-        glfwPollEvents();
+        this->window.pollEvents();
+
+        // Switched between frames, as the swap chain is recreated
+        const bool profileKey = !this->window.isHeadless() && glfwGetKey(this->window.getGLFWwindow(), GLFW_KEY_P) == GLFW_PRESS;
+        if (profileKey && !profileKeyHeld)
+        {
+            const int next = (static_cast<int>(this->profile) + 1) % static_cast<int>(SwapChain::PresentProfile::Count);
+            this->setPresentProfile(static_cast<SwapChain::PresentProfile>(next));
+            this->renderer.getPresentStats().print(std::cout);
+        }
+        profileKeyHeld = profileKey;
+
+        // The render pass is fetched now, since switching profiles recreates it
+        const bool lightingKey = !this->window.isHeadless() && glfwGetKey(this->window.getGLFWwindow(), GLFW_KEY_L) == GLFW_PRESS;
+        if (lightingKey && !lightingKeyHeld)
+        {
+            this->shaderFeatures.lighting = !this->shaderFeatures.lighting;
+            renderSystem.setShaderFeatures(this->shaderFeatures, this->renderer.getSwapChainRenderPass());
+        }
+        lightingKeyHeld = lightingKey;
 
         auto newTime = std::chrono::high_resolution_clock::now();
         float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
         currentTime = newTime;
-        frameTime = glm::min(frameTime, 0.2f);
 
-        cameraController.moveInPlaneXZ(this->window.getGLFWwindow(), frameTime, viewerObject);
-        camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
+        // Measured before the clamp below, against the stats of the frame just recorded
+        if (benchmark && !benchmark->update(frameTime, renderSystem.getFrameStats(), this->objects, renderSystem, this->renderer.getSwapChainRenderPass()))
+            break;
+
+        frameTime = glm::min(frameTime, 0.2f);
 
         float aspect = this->renderer.getAspectRatio();
-        camera.setPerspectiveProjection(glm::radians(55.0f), aspect, 0.1f, 20.0f);
+        if (benchmark)
+            benchmark->setCamera(camera, aspect);
+        else
+        {
+            if (!this->window.isHeadless())
+                cameraController.moveInPlaneXZ(this->window.getGLFWwindow(), frameTime, viewerObject);
+            camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
+            camera.setPerspectiveProjection(glm::radians(55.0f), aspect, 0.1f, 20.0f);
+        }
 
         if (auto commandBuffer = this->renderer.beginFrame())
         {
-            this->renderer.beginSwapChainRenderPass(commandBuffer);
-            renderSystem.renderObjects(commandBuffer, this->objects, camera);
+            const RenderPassTarget target = this->renderer.getRenderPassTarget();
+
+            // Culling runs as a compute pass, outside the render pass
+            renderSystem.cullObjects(commandBuffer, this->renderer.getFrameIndex(), this->objects, camera, target);
+
+            this->renderer.beginSwapChainRenderPass(commandBuffer, renderSystem.getSubpassContents(), renderSystem.getFirstPass());
+            renderSystem.renderObjects(commandBuffer, this->renderer.getFrameIndex(), this->objects, camera, target);
             this->renderer.endSwapChainRenderPass(commandBuffer);
+
+            // What the first pass hid is tested against its depth, and drawn if it shows
+            if (renderSystem.isOcclusionCulling())
+            {
+                renderSystem.cullOccluded(commandBuffer, this->renderer.getFrameIndex(), target);
+
+                this->renderer.beginSwapChainRenderPass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE, SwapChain::Pass::Late);
+                renderSystem.renderOccluded(commandBuffer, this->renderer.getFrameIndex());
+                this->renderer.endSwapChainRenderPass(commandBuffer);
+            }
             this->renderer.endFrame();
+            frameCount++;
         }
     }
 
     vkDeviceWaitIdle(this->device.device());
+
+    if (this->renderer.isCapturing())
+        this->renderer.stopCapture().print(std::cout);
+
+    this->renderer.getPresentStats().print(std::cout);
+
+    if (benchmark)
+        benchmark->print(std::cout);
+}
+
+void
+Application::captureFrames(const std::string& directory, FrameCapture::Format format)
+{
+    this->renderer.startCapture(directory, format);
+}
+
+void
+Application::setPresentProfile(SwapChain::PresentProfile profile)
+{
+    this->profile = profile;
+    this->renderer.setPresentProfile(profile);
+}
+
+std::unique_ptr<Benchmark>
+Application::createBenchmark() const
+{
+    const std::shared_ptr<Model>& model = this->objects.front().model;
+    switch (this->scene)
+    {
+    case Scene::LodBenchmark:        return std::make_unique<LodBenchmark>(model);
+    case Scene::InstancingBenchmark: return std::make_unique<InstancingBenchmark>(model);
+    case Scene::CullingBenchmark:    return std::make_unique<CullingBenchmark>(model);
+    case Scene::ShaderBenchmark:     return std::make_unique<ShaderBenchmark>(model);
+    default:                         return nullptr;
+    }
 }
 
 void
 Application::loadObjects()
 {
-    std::shared_ptr<Model> model    = Model::createModelFromFile(this->device, "Assets/Scenes/Test.obj");
+    const std::string filePath      = "Assets/Scenes/Test.obj";
+    Model::LoadOptions options      = { };
+    options.vertexFormat            = this->format;
+
+    std::shared_ptr<Model> model    = nullptr;
+    if (this->streamModels)
+    {
+        ModelStreamer streamer = { this->device };
+        model                  = streamer.load(filePath, &this->startupStats);
+    }
+    else
+        model = Model::createModelFromFile(this->device, filePath, &this->startupStats, options);
+
     auto objects                    = Object::createObject();
     objects.model                   = model;
     objects.color                   = { 0.1f, 0.8f, 0.1f };
@@ -70,4 +196,11 @@ Application::loadObjects()
     objects.transform.scale         = { 0.5f, 0.5f, 0.5f };
 
     this->objects.push_back(std::move(objects));
+
+    // Every model is in one batch so far; send it before the first frame
+    this->device.uploads().flush();
+
+    this->device.allocator().getStats().print(std::cout);
+    this->device.uploads().getStats().print(std::cout);
+    this->device.geometry().getStats().print(std::cout);
 }
\ No newline at end of file
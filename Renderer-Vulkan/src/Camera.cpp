@@ -94,4 +94,38 @@ const glm::mat4&
 Camera::getView() const
 {
     return this->viewMatrix;
+}
+
+float
+Camera::getPixelsPerUnit(float depth, float viewportHeight) const
+{
+    const float pixelsPerUnit = glm::abs(this->projectionMatrix[1][1]) * viewportHeight * 0.5f;
+
+    // Orthographic projections leave w at 1, so size does not fall off with depth
+    if (!this->isPerspective())
+        return pixelsPerUnit;
+
+    assert(depth > 0.0f && "Depth Must be in Front of the Camera");
+    return pixelsPerUnit / depth;
+}
+
+std::array<glm::vec4, 6>
+Camera::getFrustumPlanes() const
+{
+    // Rows of the clip matrix combined as in Gribb and Hartmann, for a 0 to 1 depth range
+    const glm::mat4 clip = glm::transpose(this->projectionMatrix * this->viewMatrix);
+
+    std::array<glm::vec4, 6> planes = {
+        clip[3] + clip[0],
+        clip[3] - clip[0],
+        clip[3] + clip[1],
+        clip[3] - clip[1],
+        clip[2],
+        clip[3] - clip[2],
+    };
+
+    for (auto& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    return planes;
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include <CullingBenchmark.hpp>
+
+CullingBenchmark::CullingBenchmark(std::shared_ptr<Model> model) :
+    model(std::move(model))
+{ }
+
+void
+CullingBenchmark::layoutObjects(std::vector<Object>& objects) const
+{
+    objects.clear();
+    objects.reserve(OBJECTS);
+
+    const Model::Bounds& bounds = this->model->getBounds();
+    const float diagonal        = glm::length(bounds.max - bounds.min);
+    const float scale           = diagonal > 0.0f ? 1.0f / diagonal : 1.0f;
+    const glm::vec3 center      = (bounds.min + bounds.max) * 0.5f;
+    const uint32_t columns      = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(OBJECTS))));
+
+    for (uint32_t i = 0; i < OBJECTS; i++)
+    {
+        const float column = static_cast<float>(i % columns) - 0.5f * static_cast<float>(columns - 1);
+        const float row    = static_cast<float>(i / columns) - 0.5f * static_cast<float>(columns - 1);
+
+        auto object                  = Object::createObject();
+        object.model                 = this->model;
+        object.color                 = { 0.1f, 0.1f, 0.8f };
+        object.transform.scale       = { scale, scale, scale };
+        object.transform.translation = glm::vec3(column * SPACING, 0.0f, row * SPACING) - center * scale;
+
+        // Rotated spheres take FrustumCuller's other path
+        if (i % 2 == 1)
+            object.transform.rotation = { 0.0f, 0.1f * static_cast<float>(i % 63), 0.0f };
+
+        objects.push_back(std::move(object));
+    }
+}
+
+void
+CullingBenchmark::beginStep(FrustumCuller::InstructionSet instructionSet, RenderSystem& renderSystem)
+{
+    this->current                = { };
+    this->current.instructionSet = instructionSet;
+    this->elapsed                = 0.0f;
+
+    renderSystem.getFrustumCuller().setInstructionSet(instructionSet);
+}
+
+void
+CullingBenchmark::begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->steps.clear();
+    this->beginStep(FrustumCuller::InstructionSet::Scalar, renderSystem);
+    this->layoutObjects(objects);
+}
+
+bool
+CullingBenchmark::update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->elapsed += frameTime;
+    if (this->elapsed > WARMUP_SECONDS)
+    {
+        this->current.frames++;
+        this->current.seconds          += frameTime;
+        this->current.cullMilliseconds += stats.cullMilliseconds;
+        this->current.cpuMilliseconds  += stats.cpuMilliseconds;
+        this->current.visible          += stats.objects + stats.streaming;
+        this->current.culled           += stats.culled;
+    }
+
+    if (this->elapsed < WARMUP_SECONDS + MEASURE_SECONDS)
+        return true;
+
+    this->steps.push_back(this->current);
+
+    FrustumCuller& culler = renderSystem.getFrustumCuller();
+    if (this->current.instructionSet >= culler.getSupported())
+    {
+        culler.setInstructionSet(culler.getSupported());
+        return false;
+    }
+
+    const auto next = static_cast<FrustumCuller::InstructionSet>(static_cast<int>(this->current.instructionSet) + 1);
+    this->beginStep(next, renderSystem);
+    return true;
+}
+
+void
+CullingBenchmark::setCamera(Camera& camera, float aspect) const
+{
+    const float gridSize = std::sqrt(static_cast<float>(OBJECTS)) * SPACING;
+
+    // From one edge of the grid towards its center; far enough that most of it lies outside
+    camera.setViewTarget(glm::vec3(0.0f, -4.0f, -0.5f * gridSize), glm::vec3(0.0f, 0.0f, 0.0f));
+    camera.setPerspectiveProjection(glm::radians(55.0f), aspect, 0.1f, 0.25f * gridSize);
+}
+
+void
+CullingBenchmark::print(std::ostream& out) const
+{
+    out << "Culling benchmark:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    for (const auto& step : this->steps)
+    {
+        const double frames = static_cast<double>(std::max(step.frames, 1u));
+
+        out << "\t" << OBJECTS << " objects, " << FrustumCuller::getName(step.instructionSet) << ": "
+            << step.cullMilliseconds / frames << " ms culling, "
+            << step.cpuMilliseconds / frames << " ms recording, "
+            << 1000.0 * step.seconds / frames << " ms/frame, "
+            << static_cast<double>(step.visible) / frames << " visible, "
+            << static_cast<double>(step.culled) / frames << " culled/frame" << std::endl;
+    }
+
+    out << std::defaultfloat;
+}
\ No newline at end of file
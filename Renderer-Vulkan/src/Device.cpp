@@ -49,25 +49,45 @@ DestroyDebugUtilsMessengerEXT(
 }
 
 // class member functions
-Device::Device(Window& window) : window(window)
+Device::Device(Window& window) : window(window), headless_(window.isHeadless())
 {
+    if (!headless_)
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+
     this->createInstance();
     this->setupDebugMessenger();
     this->createSurface();
     this->pickPhysicalDevice();
     this->createLogicalDevice();
     this->createCommandPool();
+
+    this->allocator_ = std::make_unique<MemoryAllocator>(physicalDevice, device_);
+    this->uploads_   = std::make_unique<UploadManager>(*this);
+    this->geometry_  = std::make_unique<GeometryPool>(*this);
+    this->pipelineCache_ = std::make_unique<PipelineCache>(device_, properties);
+    this->pipelines_     = std::make_unique<PipelineLibrary>(device_, *this->pipelineCache_);
 }
 
 Device::~Device()
 {
+    // Every other resource must be destroyed by now. The pipeline library waits for its
+    // compiles, so the pipeline cache holds every pipeline of the run when it is saved. The
+    // geometry pool and upload ring go last, then the allocator releases its empty blocks
+    this->pipelines_.reset();
+    this->pipelineCache_.reset();
+    this->geometry_.reset();
+    this->uploads_.reset();
+    this->allocator_.reset();
+
     vkDestroyCommandPool(device_, commandPool, nullptr);
     vkDestroyDevice(device_, nullptr);
 
     if (enableValidationLayers)
         DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
 
-    vkDestroySurfaceKHR(instance, surface_, nullptr);
+    if (!headless_)
+        vkDestroySurfaceKHR(instance, surface_, nullptr);
+
     vkDestroyInstance(instance, nullptr);
 }
 
@@ -83,7 +103,7 @@ Device::createInstance()
     appInfo.applicationVersion         = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName                = "No ";
     appInfo.engineVersion              = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion                 = VK_API_VERSION_1_0;
+    appInfo.apiVersion                 = VK_API_VERSION_1_2;
 
     VkInstanceCreateInfo createInfo    = { };
     createInfo.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -145,10 +165,13 @@ Device::pickPhysicalDevice()
 void
 Device::createLogicalDevice()
 {
-    QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+    queueFamilies_             = findQueueFamilies(physicalDevice);
+    QueueFamilyIndices indices = queueFamilies_;
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily };
+    std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.transferFamily };
+    if (!headless_)
+        uniqueQueueFamilies.insert(indices.presentFamily);
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -161,11 +184,32 @@ Device::createLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // The GPU-driven draw path is optional, so its features are only enabled where supported
+    VkPhysicalDeviceVulkan12Features supported12 = { };
+    supported12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+    VkPhysicalDeviceFeatures2 supported          = { };
+    supported.sType                              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext                              = &supported12;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+    drawIndirectCount_ = supported.features.multiDrawIndirect &&
+                         supported.features.drawIndirectFirstInstance &&
+                         supported12.drawIndirectCount;
+
     VkPhysicalDeviceFeatures deviceFeatures     = { };
     deviceFeatures.samplerAnisotropy            = VK_TRUE;
+    deviceFeatures.multiDrawIndirect            = drawIndirectCount_;
+    deviceFeatures.drawIndirectFirstInstance    = drawIndirectCount_;
+
+    // Upload batches signal a timeline semaphore
+    VkPhysicalDeviceVulkan12Features features12 = { };
+    features12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+    features12.timelineSemaphore                = VK_TRUE;
+    features12.drawIndirectCount                = drawIndirectCount_;
 
     VkDeviceCreateInfo createInfo               = { };
     createInfo.sType                            = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext                            = &features12;
 
     createInfo.queueCreateInfoCount             = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos                = queueCreateInfos.data();
@@ -187,7 +231,9 @@ Device::createLogicalDevice()
         throw std::runtime_error("failed to create logical device!");
 
     vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
-    vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+    if (!headless_)
+        vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+    vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
 }
 
 void
@@ -208,6 +254,8 @@ Device::createCommandPool()
 void
 Device::createSurface()
 {
+    if (headless_) return;
+
     window.createWindowSurface(instance, &surface_);
 }
 
@@ -218,8 +266,8 @@ Device::isDeviceSuitable(VkPhysicalDevice device)
 
     bool extensionsSupported   = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate     = false;
-    if (extensionsSupported)
+    bool swapChainAdequate     = headless_;
+    if (extensionsSupported && !headless_)
     {
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
         swapChainAdequate                        = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -228,7 +276,24 @@ Device::isDeviceSuitable(VkPhysicalDevice device)
     VkPhysicalDeviceFeatures supportedFeatures;
     vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
-    return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+    VkPhysicalDeviceVulkan12Features features12 = { };
+    features12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+    VkPhysicalDeviceFeatures2 features2         = { };
+    features2.sType                             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext                             = &features12;
+
+    bool timelineSemaphores = false;
+    if (deviceProperties.apiVersion >= VK_API_VERSION_1_2)
+    {
+        vkGetPhysicalDeviceFeatures2(device, &features2);
+        timelineSemaphores = features12.timelineSemaphore;
+    }
+
+    return indices.isComplete(!headless_) && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy &&
+           timelineSemaphores;
 }
 
 void
@@ -289,9 +354,11 @@ Device::checkValidationLayerSupport()
 std::vector<const char*>
 Device::getRequiredExtensions()
 {
+    // Headless, GLFW is never initialized and no surface is created
     uint32_t glfwExtensionCount = 0;
     const char** glfwExtensions = nullptr;
-    glfwExtensions              = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    if (!headless_)
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
     std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
 
@@ -362,24 +429,43 @@ Device::findQueueFamilies(VkPhysicalDevice device)
     int i = 0;
     for (const auto& queueFamily : queueFamilies)
     {
-        if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        if (!indices.isComplete(!headless_))
         {
-            indices.graphicsFamily         = i;
-            indices.graphicsFamilyHasValue = true;
+            if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            {
+                indices.graphicsFamily         = i;
+                indices.graphicsFamilyHasValue = true;
+            }
+            VkBool32 presentSupport = false;
+            if (!headless_)
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+            if (queueFamily.queueCount > 0 && presentSupport)
+            {
+                indices.presentFamily         = i;
+                indices.presentFamilyHasValue = true;
+            }
         }
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
-        if (queueFamily.queueCount > 0 && presentSupport)
+
+        // Any family without graphics runs beside rendering; a transfer only one is the
+        // copy engine, so it wins over compute ones (which can always transfer)
+        const bool canTransfer  = queueFamily.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT);
+        const bool transferOnly = !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT);
+        if (queueFamily.queueCount > 0 && canTransfer && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) &&
+            (!indices.transferFamilyHasValue || transferOnly))
         {
-            indices.presentFamily         = i;
-            indices.presentFamilyHasValue = true;
+            indices.transferFamily         = i;
+            indices.transferFamilyHasValue = true;
         }
-        if (indices.isComplete())
-            break;
 
         i++;
     }
 
+    if (!indices.transferFamilyHasValue && indices.graphicsFamilyHasValue)
+    {
+        indices.transferFamily         = indices.graphicsFamily;
+        indices.transferFamilyHasValue = true;
+    }
+
     return indices;
 }
 
@@ -446,29 +532,40 @@ Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 }
 
 void
-Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory, bool sharedWithTransfer)
 {
+    QueueFamilyIndices indices = findPhysicalQueueFamilies();
+    uint32_t families[]        = { indices.graphicsFamily, indices.transferFamily };
+
     VkBufferCreateInfo bufferInfo = { };
     bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size               = size;
     bufferInfo.usage              = usage;
     bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
 
+    if (sharedWithTransfer && indices.graphicsFamily != indices.transferFamily)
+    {
+        bufferInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices   = families;
+    }
+
     if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
         throw std::runtime_error("failed to create vertex buffer!");
 
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo = { };
-    allocInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize       = memRequirements.size;
-    allocInfo.memoryTypeIndex      = findMemoryType(memRequirements.memoryTypeBits, properties);
+    bufferMemory = allocator_->allocate(memRequirements, properties, MemoryAllocator::Tiling::Linear);
 
-    if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-        throw std::runtime_error("failed to allocate vertex buffer memory!");
+    vkBindBufferMemory(device_, buffer, bufferMemory.memory, bufferMemory.offset);
+}
 
-    vkBindBufferMemory(device_, buffer, bufferMemory, 0);
+void
+Device::destroyBuffer(VkBuffer buffer, MemoryAllocation& bufferMemory)
+{
+    vkDestroyBuffer(device_, buffer, nullptr);
+    allocator_->free(bufferMemory);
 }
 
 VkCommandBuffer
@@ -508,13 +605,13 @@ Device::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 }
 
 void
-Device::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+Device::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
 {
     VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
     VkBufferCopy copyRegion       = { };
-    copyRegion.srcOffset          = 0;  // Optional
-    copyRegion.dstOffset          = 0;  // Optional
+    copyRegion.srcOffset          = srcOffset;
+    copyRegion.dstOffset          = dstOffset;
     copyRegion.size               = size;
     vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
@@ -544,7 +641,7 @@ Device::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32
 }
 
 void
-Device::createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory)
+Device::createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& imageMemory)
 {
     if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS)
         throw std::runtime_error("failed to create image!");
@@ -552,14 +649,18 @@ Device::createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryProperty
     VkMemoryRequirements memRequirements;
     vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo = { };
-    allocInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize       = memRequirements.size;
-    allocInfo.memoryTypeIndex      = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-        throw std::runtime_error("failed to allocate image memory!");
+    const MemoryAllocator::Tiling tiling = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL
+        ? MemoryAllocator::Tiling::Optimal
+        : MemoryAllocator::Tiling::Linear;
+    imageMemory = allocator_->allocate(memRequirements, properties, tiling);
 
-    if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS)
+    if (vkBindImageMemory(device_, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS)
         throw std::runtime_error("failed to bind image memory!");
+}
+
+void
+Device::destroyImage(VkImage image, MemoryAllocation& imageMemory)
+{
+    vkDestroyImage(device_, image, nullptr);
+    allocator_->free(imageMemory);
 }
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <FrameCapture.hpp>
+
+static void
+writeBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+static uint32_t
+crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static const std::array<uint32_t, 256> table = []()
+    {
+        std::array<uint32_t, 256> entries = { };
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+
+            entries[i] = c;
+        }
+
+        return entries;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+static void
+writePngChunk(std::ofstream& file, const char type[4], const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk = { };
+    writeBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+
+    // Over the type and data, not the length
+    writeBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+static void
+writePpm(std::ofstream& file, const std::vector<uint8_t>& rgb, VkExtent2D extent)
+{
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+    file.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+}
+
+// No deflate encoder is at hand, so the zlib stream is made of stored blocks. Files are about
+// the size of a PPM, and writing them costs next to nothing
+static void
+writePng(std::ofstream& file, const std::vector<uint8_t>& rgb, VkExtent2D extent)
+{
+    constexpr size_t MAX_STORED_BLOCK = 65535;
+    static const uint8_t SIGNATURE[]  = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+    std::vector<uint8_t> header = { };
+    writeBigEndian(header, extent.width);
+    writeBigEndian(header, extent.height);
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });  // 8 bit RGB, deflate, no filter, no interlace
+    writePngChunk(file, "IHDR", header);
+
+    // Every row starts with filter type 0
+    const size_t rowSize           = extent.width * 3;
+    std::vector<uint8_t> scanlines = { };
+    scanlines.reserve((rowSize + 1) * extent.height);
+    for (uint32_t y = 0; y < extent.height; y++)
+    {
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rgb.begin() + y * rowSize, rgb.begin() + (y + 1) * rowSize);
+    }
+
+    std::vector<uint8_t> data = { 0x78, 0x01 };
+    data.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK * 5 + 16);
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t offset = 0; offset < scanlines.size(); offset += MAX_STORED_BLOCK)
+    {
+        const uint16_t size = static_cast<uint16_t>(std::min(MAX_STORED_BLOCK, scanlines.size() - offset));
+        const bool last     = offset + size == scanlines.size();
+
+        data.insert(data.end(), { static_cast<uint8_t>(last ? 1 : 0),
+                                  static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8),
+                                  static_cast<uint8_t>(~size), static_cast<uint8_t>(~size >> 8) });
+        data.insert(data.end(), scanlines.begin() + offset, scanlines.begin() + offset + size);
+
+        for (size_t i = offset; i < offset + size; i++)
+        {
+            a = (a + scanlines[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+
+    writeBigEndian(data, (b << 16) | a);
+    writePngChunk(file, "IDAT", data);
+    writePngChunk(file, "IEND", { });
+}
+
+FrameCapture::FrameCapture(Device& device, const std::string& directory, Format format, uint32_t framesInFlight) :
+    device(device),
+    directory(directory),
+    format(format)
+{
+    std::filesystem::create_directories(this->directory);
+    this->readbacks.resize(framesInFlight);
+}
+
+FrameCapture::~FrameCapture()
+{
+    try
+    {
+        this->finish();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+
+    // What finish() left after a throw still uses the buffers
+    for (auto& write : this->writes)
+        write.wait();
+
+    for (auto& readback : this->readbacks)
+    {
+        if (readback.release.valid())
+            readback.release.wait();
+
+        if (readback.buffer != nullptr)
+            this->device.destroyBuffer(readback.buffer, readback.memory);
+    }
+}
+
+void
+FrameCapture::reserve(Readback& readback, VkDeviceSize size)
+{
+    if (readback.capacity >= size)
+        return;
+
+    if (readback.buffer != nullptr)
+        this->device.destroyBuffer(readback.buffer, readback.memory);
+
+    this->device.createBuffer(size,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        readback.buffer,
+        readback.memory);
+
+    readback.capacity = size;
+}
+
+void
+FrameCapture::record(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImage image, VkImageLayout layout, VkFormat format, VkExtent2D extent)
+{
+    const auto start   = std::chrono::high_resolution_clock::now();
+    Readback& readback = this->readbacks[frameIndex];
+    assert(!readback.pending && "Frame Must be Collected Before it is Recorded Again");
+
+    if (format != VK_FORMAT_B8G8R8A8_SRGB && format != VK_FORMAT_B8G8R8A8_UNORM &&
+        format != VK_FORMAT_R8G8B8A8_SRGB && format != VK_FORMAT_R8G8B8A8_UNORM)
+        throw std::runtime_error("Frame Capture Format not Supported!");
+
+    // The writer may still be copying out this buffer's last frame
+    bool stalled = false;
+    if (readback.release.valid())
+    {
+        stalled = readback.release.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        readback.release.get();
+    }
+
+    readback.size    = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    this->reserve(readback, readback.size);
+    readback.extent  = extent;
+    readback.format  = format;
+    readback.frame   = this->frameCount++;
+    readback.pending = true;
+
+    VkImageMemoryBarrier toTransfer            = { };
+    toTransfer.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask                   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    toTransfer.dstAccessMask                   = VK_ACCESS_TRANSFER_READ_BIT;
+    toTransfer.oldLayout                       = layout;
+    toTransfer.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image                           = image;
+    toTransfer.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    toTransfer.subresourceRange.baseMipLevel   = 0;
+    toTransfer.subresourceRange.levelCount     = 1;
+    toTransfer.subresourceRange.baseArrayLayer = 0;
+    toTransfer.subresourceRange.layerCount     = 1;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &toTransfer);
+
+    VkBufferImageCopy region               = { };
+    region.bufferOffset                    = 0;
+    region.bufferRowLength                 = 0;  // Tightly packed
+    region.bufferImageHeight               = 0;
+    region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel       = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount     = 1;
+    region.imageOffset                     = { 0, 0, 0 };
+    region.imageExtent                     = { extent.width, extent.height, 1 };
+
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+
+    // The fence makes the copy visible to the host; the image goes back for presenting
+    VkBufferMemoryBarrier toHost = { };
+    toHost.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    toHost.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toHost.dstAccessMask         = VK_ACCESS_HOST_READ_BIT;
+    toHost.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    toHost.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    toHost.buffer                = readback.buffer;
+    toHost.offset                = 0;
+    toHost.size                  = readback.size;
+
+    VkImageMemoryBarrier toLayout = toTransfer;
+    toLayout.srcAccessMask        = 0;
+    toLayout.dstAccessMask        = 0;
+    toLayout.oldLayout            = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toLayout.newLayout            = layout;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, nullptr,
+        1, &toHost,
+        layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 1 : 0, &toLayout);
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.frames++;
+    this->stats.bytes              += readback.size;
+    this->stats.stalls             += stalled ? 1 : 0;
+    this->stats.renderMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+FrameCapture::collect(uint32_t frameIndex)
+{
+    Readback& readback = this->readbacks[frameIndex];
+    if (!readback.pending)
+        return;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    readback.pending = false;
+
+    // Finished writes are dropped, rethrowing what they threw
+    while (!this->writes.empty() && this->writes.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        std::future<void> write = std::move(this->writes.front());
+        this->writes.pop_front();
+        write.get();
+    }
+
+    // The writer copies the pixels out first, freeing the buffer for the next record() of
+    // this frame, then converts and writes them
+    auto pixels             = std::make_shared<std::vector<uint8_t>>(readback.size);
+    const uint8_t* mapped   = static_cast<const uint8_t*>(readback.memory.mapped);
+    const VkDeviceSize size = readback.size;
+    readback.release        = this->writer.submit([pixels, mapped, size]() { memcpy(pixels->data(), mapped, size); });
+
+    const VkExtent2D extent = readback.extent;
+    const VkFormat format   = readback.format;
+    const uint64_t frame    = readback.frame;
+    this->writes.push_back(this->writer.submit([this, pixels, extent, format, frame]() { this->write(*pixels, extent, format, frame); }));
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.renderMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+FrameCapture::write(const std::vector<uint8_t>& pixels, VkExtent2D extent, VkFormat format, uint64_t frame)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // Both file formats take RGB, without alpha
+    const bool bgra          = format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM;
+    const size_t pixelCount  = static_cast<size_t>(extent.width) * extent.height;
+    std::vector<uint8_t> rgb = std::vector<uint8_t>(pixelCount * 3);
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        rgb[i * 3 + 0] = pixels[i * 4 + (bgra ? 2 : 0)];
+        rgb[i * 3 + 1] = pixels[i * 4 + 1];
+        rgb[i * 3 + 2] = pixels[i * 4 + (bgra ? 0 : 2)];
+    }
+
+    char name[32] = { };
+    std::snprintf(name, sizeof(name), "Frame%06llu.%s", static_cast<unsigned long long>(frame), this->format == Format::Png ? "png" : "ppm");
+
+    const std::filesystem::path path = std::filesystem::path(this->directory) / name;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (this->format == Format::Png)
+        writePng(file, rgb, extent);
+    else
+        writePpm(file, rgb, extent);
+
+    if (!file)
+        throw std::runtime_error("Failed to Write Captured Frame: " + path.string() + "!");
+
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stats.written++;
+    this->stats.writeMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+FrameCapture::finish()
+{
+    vkDeviceWaitIdle(this->device.device());
+
+    for (uint32_t i = 0; i < this->readbacks.size(); i++)
+        this->collect(i);
+
+    while (!this->writes.empty())
+    {
+        std::future<void> write = std::move(this->writes.front());
+        this->writes.pop_front();
+        write.get();
+    }
+}
+
+CaptureStats
+FrameCapture::getStats() const
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include <Device.hpp>
+#include <GeometryPool.hpp>
+
+bool
+GeometryPool::Arena::allocate(uint32_t count, uint32_t& offset)
+{
+    // First fit keeps the start of the buffer dense, so compaction moves less
+    for (auto it = this->freeRanges.begin(); it != this->freeRanges.end(); it++)
+    {
+        if (it->second < count)
+            continue;
+
+        offset                         = it->first;
+        const uint32_t remainingOffset = it->first + count;
+        const uint32_t remainingCount  = it->second - count;
+
+        this->freeRanges.erase(it);
+        if (remainingCount > 0)
+            this->freeRanges.emplace(remainingOffset, remainingCount);
+
+        this->used += count;
+        return true;
+    }
+
+    return false;
+}
+
+void
+GeometryPool::Arena::free(uint32_t offset, uint32_t count)
+{
+    this->used -= count;
+
+    auto next = this->freeRanges.lower_bound(offset);
+    if (next != this->freeRanges.end() && offset + count == next->first)
+    {
+        count += next->second;
+        next   = this->freeRanges.erase(next);
+    }
+
+    if (next != this->freeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += count;
+            return;
+        }
+    }
+
+    this->freeRanges.emplace(offset, count);
+}
+
+GeometryPool::GeometryPool(Device& device) :
+    device(device)
+{
+    this->indexArena.stride = sizeof(uint32_t);
+    this->indexArena.usage  = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+}
+
+GeometryPool::~GeometryPool()
+{
+    this->device.uploads().waitIdle();
+
+    for (auto& arena : this->vertexArenas)
+    {
+        if (arena.buffer != nullptr)
+            this->device.destroyBuffer(arena.buffer, arena.memory);
+    }
+
+    if (this->indexArena.buffer != nullptr)
+        this->device.destroyBuffer(this->indexArena.buffer, this->indexArena.memory);
+}
+
+uint32_t
+GeometryPool::vertexArenaFor(VkDeviceSize stride)
+{
+    for (uint32_t i = 0; i < this->vertexArenas.size(); i++)
+    {
+        if (this->vertexArenas[i].stride == stride)
+            return i;
+    }
+
+    Arena arena  = { };
+    arena.stride = stride;
+    arena.usage  = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    this->vertexArenas.push_back(std::move(arena));
+
+    return static_cast<uint32_t>(this->vertexArenas.size() - 1);
+}
+
+uint32_t
+GeometryPool::allocateFrom(Arena& arena, uint32_t count, uint32_t Range::* offset, uint32_t Range::* rangeCount, uint32_t vertexArena)
+{
+    uint32_t allocated = 0;
+    if (arena.allocate(count, allocated))
+        return allocated;
+
+    // Packed, the live ranges leave one free range at the end; grow when even that is short
+    const uint32_t initial = &arena == &this->indexArena ? INITIAL_INDICES : INITIAL_VERTICES;
+    uint32_t capacity      = std::max(arena.capacity, initial);
+    while (capacity - arena.used < count)
+        capacity *= 2;
+
+    this->rebuild(arena, capacity, offset, rangeCount, vertexArena);
+
+    const bool fits = arena.allocate(count, allocated);
+    assert(fits && "Rebuilt Arena Must Fit the Allocation");
+    (void)fits;
+
+    return allocated;
+}
+
+void
+GeometryPool::rebuild(Arena& arena, uint32_t capacity, uint32_t Range::* offset, uint32_t Range::* count, uint32_t vertexArena)
+{
+    VkBuffer buffer         = nullptr;
+    MemoryAllocation memory = { };
+
+    this->device.createBuffer(capacity * arena.stride,
+        arena.usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        buffer,
+        memory,
+        true);
+
+    // Live ranges of this arena, in offset order so the packed layout keeps their order
+    std::vector<Range*> live = { };
+    for (auto& range : this->ranges)
+    {
+        const bool inArena = &arena == &this->indexArena || range.vertexArena == vertexArena;
+        if (range.live && inArena && range.*count > 0)
+            live.push_back(&range);
+    }
+
+    std::sort(live.begin(), live.end(), [offset](const Range* a, const Range* b) { return a->*offset < b->*offset; });
+
+    UploadTicket ticket = 0;
+    uint32_t packed     = 0;
+    for (Range* range : live)
+    {
+        // Copies recorded behind pending uploads, so those move along too
+        ticket = this->device.uploads().copy(arena.buffer,
+            buffer,
+            range->*count * arena.stride,
+            range->*offset * arena.stride,
+            packed * arena.stride,
+            false);
+
+        range->*offset  = packed;
+        packed         += range->*count;
+    }
+
+    if (arena.buffer != nullptr)
+    {
+        // Frames in flight may still draw from the old buffer
+        this->device.uploads().wait(std::max(ticket, this->device.uploads().flush()));
+        vkDeviceWaitIdle(this->device.device());
+        this->device.destroyBuffer(arena.buffer, arena.memory);
+        this->compactions++;
+    }
+
+    arena.buffer     = buffer;
+    arena.memory     = memory;
+    arena.capacity   = capacity;
+    arena.used       = packed;
+    arena.freeRanges.clear();
+
+    if (packed < capacity)
+        arena.freeRanges.emplace(packed, capacity - packed);
+}
+
+GeometryPool::Handle
+GeometryPool::allocate(VkDeviceSize vertexStride, uint32_t vertexCount, uint32_t indexCount)
+{
+    Handle handle = INVALID_HANDLE;
+    if (!this->spare.empty())
+    {
+        handle = this->spare.back();
+        this->spare.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(this->ranges.size());
+        this->ranges.push_back({ });
+    }
+
+    Range range       = { };
+    range.vertexArena = this->vertexArenaFor(vertexStride);
+    range.vertexCount = vertexCount;
+
+    // Each part is only counted once placed, so a rebuild on the way skips it
+    range.vertexOffset = this->allocateFrom(this->vertexArenas[range.vertexArena], vertexCount,
+        &Range::vertexOffset, &Range::vertexCount, range.vertexArena);
+    range.live         = true;
+
+    this->ranges[handle] = range;
+
+    if (indexCount > 0)
+    {
+        const uint32_t firstIndex = this->allocateFrom(this->indexArena, indexCount, &Range::firstIndex, &Range::indexCount, 0);
+        this->ranges[handle].firstIndex = firstIndex;
+        this->ranges[handle].indexCount = indexCount;
+    }
+
+    return handle;
+}
+
+void
+GeometryPool::free(Handle handle)
+{
+    Range& range = this->ranges[handle];
+    assert(range.live && "Range Already Freed");
+
+    this->vertexArenas[range.vertexArena].free(range.vertexOffset, range.vertexCount);
+    if (range.indexCount > 0)
+        this->indexArena.free(range.firstIndex, range.indexCount);
+
+    range = { };
+    this->spare.push_back(handle);
+}
+
+UploadTicket
+GeometryPool::uploadVertices(Handle handle, const void* vertices)
+{
+    const Range& range = this->ranges[handle];
+    const Arena& arena = this->vertexArenas[range.vertexArena];
+
+    return this->device.uploads().upload(arena.buffer, range.vertexOffset * arena.stride, vertices, range.vertexCount * arena.stride, false);
+}
+
+UploadTicket
+GeometryPool::uploadVertices(Handle handle, const UploadManager::Fill& fill)
+{
+    const Range& range = this->ranges[handle];
+    const Arena& arena = this->vertexArenas[range.vertexArena];
+
+    return this->device.uploads().upload(arena.buffer, range.vertexOffset * arena.stride, range.vertexCount * arena.stride, arena.stride, fill, false);
+}
+
+UploadTicket
+GeometryPool::uploadIndices(Handle handle, const uint32_t* indices)
+{
+    const Range& range = this->ranges[handle];
+
+    return this->device.uploads().upload(this->indexArena.buffer,
+        range.firstIndex * this->indexArena.stride,
+        indices,
+        range.indexCount * this->indexArena.stride,
+        false);
+}
+
+void
+GeometryPool::bind(VkCommandBuffer commandBuffer, Handle handle) const
+{
+    const VkBuffer buffers[]    = { this->getVertexBuffer(handle) };
+    const VkDeviceSize offset[] = { 0 };
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offset);
+
+    if (this->indexArena.buffer != nullptr)
+        vkCmdBindIndexBuffer(commandBuffer, this->indexArena.buffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+GeometryStats
+GeometryPool::getStats() const
+{
+    GeometryStats stats = { };
+
+    for (const auto& arena : this->vertexArenas)
+        stats.arenas.push_back({ arena.stride, static_cast<uint64_t>(arena.capacity) * arena.stride, static_cast<uint64_t>(arena.used) * arena.stride, false });
+
+    const Arena& indices = this->indexArena;
+    stats.arenas.push_back({ indices.stride, static_cast<uint64_t>(indices.capacity) * indices.stride, static_cast<uint64_t>(indices.used) * indices.stride, true });
+
+    for (const auto& range : this->ranges)
+        stats.liveRanges += range.live ? 1 : 0;
+
+    stats.compactions = this->compactions;
+    return stats;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include <InstancingBenchmark.hpp>
+
+InstancingBenchmark::InstancingBenchmark(std::shared_ptr<Model> model) :
+    model(std::move(model))
+{ }
+
+void
+InstancingBenchmark::layoutObjects(std::vector<Object>& objects) const
+{
+    objects.clear();
+    objects.reserve(OBJECTS);
+
+    const Model::Bounds& bounds = this->model->getBounds();
+    const float diagonal        = glm::length(bounds.max - bounds.min);
+    const float scale           = diagonal > 0.0f ? 1.0f / diagonal : 1.0f;
+    const glm::vec3 center      = (bounds.min + bounds.max) * 0.5f;
+    const uint32_t columns      = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(OBJECTS))));
+
+    for (uint32_t i = 0; i < OBJECTS; i++)
+    {
+        const float column = static_cast<float>(i % columns) - 0.5f * static_cast<float>(columns - 1);
+        const float row    = static_cast<float>(i / columns + 1);
+
+        auto object                  = Object::createObject();
+        object.model                 = this->model;
+        object.color                 = { 0.1f, 0.8f, 0.1f };
+        object.transform.scale       = { scale, scale, scale };
+        object.transform.translation = glm::vec3(column * SPACING, 0.0f, row * SPACING) - center * scale;
+
+        objects.push_back(std::move(object));
+    }
+}
+
+void
+InstancingBenchmark::beginStep(RenderSystem::DrawPath drawPath, bool parallel, bool occlusion, RenderSystem& renderSystem)
+{
+    renderSystem.setDrawPath(drawPath);
+    renderSystem.setParallelRecording(parallel);
+    renderSystem.setOcclusionCulling(occlusion);
+
+    this->current                  = { };
+    this->current.drawPath         = drawPath;
+    this->current.parallel         = parallel;
+    this->current.occlusion        = occlusion;
+    this->current.recordingThreads = renderSystem.getRecordingThreads();
+    this->elapsed                  = 0.0f;
+}
+
+void
+InstancingBenchmark::begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->steps.clear();
+    this->gpuDrivenSkipped = false;
+    this->beginStep(RenderSystem::DrawPath::PerObject, false, false, renderSystem);
+    this->layoutObjects(objects);
+}
+
+bool
+InstancingBenchmark::update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->elapsed += frameTime;
+    if (this->elapsed > WARMUP_SECONDS)
+    {
+        this->current.frames++;
+        this->current.seconds         += frameTime;
+        this->current.cpuMilliseconds += stats.cpuMilliseconds;
+        this->current.drawCalls       += stats.drawCalls;
+        this->current.bindsAvoided    += stats.bindsAvoided;
+        this->current.occluded        += stats.occluded;
+        this->current.triangles       += stats.triangles;
+    }
+
+    if (this->elapsed < WARMUP_SECONDS + MEASURE_SECONDS)
+        return true;
+
+    this->steps.push_back(this->current);
+    switch (this->current.drawPath)
+    {
+    case RenderSystem::DrawPath::PerObject:
+        if (this->current.parallel)
+            this->beginStep(RenderSystem::DrawPath::Instanced, false, false, renderSystem);
+        else
+            this->beginStep(RenderSystem::DrawPath::PerObject, true, false, renderSystem);
+        return true;
+    case RenderSystem::DrawPath::Instanced:
+        this->gpuDrivenSkipped = !renderSystem.supportsGpuDriven();
+        if (this->gpuDrivenSkipped)
+            return false;
+
+        this->beginStep(RenderSystem::DrawPath::GpuDriven, false, false, renderSystem);
+        return true;
+    default:
+        if (this->current.occlusion)
+            return false;
+
+        this->beginStep(RenderSystem::DrawPath::GpuDriven, false, true, renderSystem);
+        return true;
+    }
+}
+
+void
+InstancingBenchmark::setCamera(Camera& camera, float aspect) const
+{
+    const float gridDepth = std::sqrt(static_cast<float>(OBJECTS)) * SPACING;
+
+    camera.setViewTarget(glm::vec3(0.0f, -4.0f, -1.0f), glm::vec3(0.0f, 0.0f, 0.25f * gridDepth));
+    camera.setPerspectiveProjection(glm::radians(55.0f), aspect, 0.1f, 2.0f * gridDepth);
+}
+
+std::string
+InstancingBenchmark::stepName(const Step& step)
+{
+    std::string name = { };
+    switch (step.drawPath)
+    {
+    case RenderSystem::DrawPath::PerObject:
+        name = "per object";
+        break;
+    case RenderSystem::DrawPath::Instanced:
+        name = "instanced ";
+        break;
+    default:
+        name = "GPU-driven";
+        break;
+    }
+
+    if (step.parallel)
+        name += " on " + std::to_string(step.recordingThreads) + " threads";
+
+    if (step.occlusion)
+        name += ", occlusion culled";
+
+    return name;
+}
+
+void
+InstancingBenchmark::print(std::ostream& out) const
+{
+    out << "Instancing benchmark:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    for (const auto& step : this->steps)
+    {
+        const double frames = static_cast<double>(std::max(step.frames, 1u));
+
+        out << "\t" << OBJECTS << " objects, " << stepName(step) << ": "
+            << 1000.0 * step.seconds / frames << " ms/frame, "
+            << step.cpuMilliseconds / frames << " ms recording, "
+            << static_cast<double>(step.drawCalls) / frames << " draw calls/frame, "
+            << static_cast<double>(step.bindsAvoided) / frames << " binds avoided/frame";
+
+        if (step.drawPath != RenderSystem::DrawPath::GpuDriven)
+            out << ", " << static_cast<double>(step.triangles) / frames / 1000000.0 << "M triangles/frame";
+
+        if (step.occlusion)
+            out << ", " << static_cast<double>(step.occluded) / frames << " occluded/frame";
+
+        out << std::endl;
+    }
+
+    if (!this->steps.empty() && this->steps[0].cpuMilliseconds > 0.0)
+    {
+        const double before = this->steps[0].cpuMilliseconds / std::max(this->steps[0].frames, 1u);
+        for (size_t i = 1; i < this->steps.size(); i++)
+        {
+            const double after = this->steps[i].cpuMilliseconds / std::max(this->steps[i].frames, 1u);
+            if (after > 0.0)
+                out << "\trecording " << before / after << "x faster " << stepName(this->steps[i]) << std::endl;
+        }
+    }
+
+    if (this->gpuDrivenSkipped)
+        out << "\tGPU-driven skipped, device lacks drawIndirectCount" << std::endl;
+
+    out << std::defaultfloat;
+}
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+#include <Objects/ObjectLoader.h>
+
+#include <LoaderBenchmark.hpp>
+
+// Bytes of one grid vertex in the synthetic file, with its v, vt and vn records and two triangles
+static constexpr uint64_t BYTES_PER_GRID_VERTEX = 200;
+
+struct ParsedObj
+{
+    tinyobj::attrib_t attrib                   = { };
+    std::vector<tinyobj::shape_t> shapes       = { };
+    std::vector<tinyobj::material_t> materials = { };
+};
+
+static const char*
+loaderName(Model::Builder::LoaderMode mode)
+{
+    switch (mode)
+    {
+        case Model::Builder::LoaderMode::Stream:
+            return "LoadObj      ";
+        case Model::Builder::LoaderMode::Mapped:
+            return "LoadObjMapped";
+    }
+
+    return "Unknown";
+}
+
+static void
+parse(Model::Builder::LoaderMode mode, const std::string& filePath, ParsedObj& parsed)
+{
+    std::string warn, err = "";
+    bool loaded           = false;
+    if (mode == Model::Builder::LoaderMode::Mapped)
+        loaded = tinyobj::LoadObjMapped(&parsed.attrib, &parsed.shapes, &parsed.materials, &warn, &err, filePath.c_str());
+    else
+        loaded = tinyobj::LoadObj(&parsed.attrib, &parsed.shapes, &parsed.materials, &warn, &err, filePath.c_str());
+
+    if (!loaded)
+        throw std::runtime_error(warn + err);
+}
+
+static size_t
+indexCount(const ParsedObj& parsed)
+{
+    size_t count = 0;
+    for (const auto& shape : parsed.shapes)
+        count += shape.mesh.indices.size();
+
+    return count;
+}
+
+static bool
+sameMesh(const ParsedObj& a, const ParsedObj& b)
+{
+    if (a.attrib.vertices != b.attrib.vertices || a.attrib.normals != b.attrib.normals ||
+        a.attrib.texcoords != b.attrib.texcoords || a.shapes.size() != b.shapes.size())
+        return false;
+
+    for (size_t shape = 0; shape < a.shapes.size(); shape++)
+    {
+        const auto& first  = a.shapes[shape].mesh.indices;
+        const auto& second = b.shapes[shape].mesh.indices;
+        if (first.size() != second.size())
+            return false;
+
+        for (size_t i = 0; i < first.size(); i++)
+        {
+            if (first[i].vertex_index != second[i].vertex_index ||
+                first[i].normal_index != second[i].normal_index ||
+                first[i].texcoord_index != second[i].texcoord_index)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+LoaderBenchmark::LoaderBenchmark(const std::string& filePath, uint32_t megabytes) :
+    filePath(filePath),
+    megabytes(megabytes)
+{
+    if (this->filePath.empty())
+        this->generate();
+
+    this->fileBytes = std::filesystem::file_size(this->filePath);
+}
+
+LoaderBenchmark::~LoaderBenchmark()
+{
+    if (this->generated)
+    {
+        std::error_code ignored = { };
+        std::filesystem::remove(this->filePath, ignored);
+    }
+}
+
+void
+LoaderBenchmark::generate()
+{
+    if (this->megabytes == 0)
+        throw std::runtime_error("Synthetic OBJ Size Must not be Zero!");
+
+    this->filePath  = (std::filesystem::temp_directory_path() / "LoaderBenchmark.obj").string();
+    this->generated = true;
+
+    std::ofstream file(this->filePath, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to Open File: " + this->filePath);
+
+    const uint64_t bytes = static_cast<uint64_t>(this->megabytes) << 20;
+    const uint32_t side  = std::max(2u, static_cast<uint32_t>(std::sqrt(static_cast<double>(bytes / BYTES_PER_GRID_VERTEX))));
+    const float step     = 1.0f / static_cast<float>(side - 1);
+
+    // Written a line at a time into one buffer, flushed once it fills
+    std::string buffer = { };
+    buffer.reserve(1 << 20);
+    char line[128]     = { };
+
+    const auto append = [&](int length)
+    {
+        buffer.append(line, static_cast<size_t>(length));
+        if (buffer.size() > (1 << 20) - sizeof(line))
+        {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+
+    // A gently rolling height field, so the values have all their digits
+    for (uint32_t y = 0; y < side; y++)
+    {
+        for (uint32_t x = 0; x < side; x++)
+        {
+            const float u      = static_cast<float>(x) * step;
+            const float v      = static_cast<float>(y) * step;
+            const float height = 0.05f * std::sin(u * 12.0f) * std::cos(v * 9.0f);
+
+            append(std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", u - 0.5f, height, v - 0.5f));
+            append(std::snprintf(line, sizeof(line), "vt %.6f %.6f\n", u, v));
+            append(std::snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", -height, 1.0f, height));
+        }
+    }
+
+    for (uint32_t y = 0; y + 1 < side; y++)
+    {
+        for (uint32_t x = 0; x + 1 < side; x++)
+        {
+            const uint32_t a = y * side + x + 1;
+            const uint32_t b = a + 1;
+            const uint32_t c = a + side;
+            const uint32_t d = c + 1;
+
+            append(std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, b, b, b));
+            append(std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\n", b, b, b, c, c, c, d, d, d));
+        }
+    }
+
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file)
+        throw std::runtime_error("Failed to Write File: " + this->filePath);
+}
+
+void
+LoaderBenchmark::run()
+{
+    this->results   = { };
+    this->identical = true;
+    this->threads   = std::max(std::thread::hardware_concurrency(), 1u);
+
+    Result stream = { };
+    stream.mode   = Model::Builder::LoaderMode::Stream;
+    this->results.push_back(stream);
+
+    Result mapped = { };
+    mapped.mode   = Model::Builder::LoaderMode::Mapped;
+    this->results.push_back(mapped);
+
+    ParsedObj first = { };
+    for (uint32_t run = 0; run < RUNS; run++)
+    {
+        for (auto& result : this->results)
+        {
+            ParsedObj parsed = { };
+
+            const auto start = std::chrono::steady_clock::now();
+            parse(result.mode, this->filePath, parsed);
+            const auto end   = std::chrono::steady_clock::now();
+
+            const double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+            result.bestMilliseconds   = run == 0 ? milliseconds : std::min(result.bestMilliseconds, milliseconds);
+            result.meanMilliseconds  += milliseconds / static_cast<double>(RUNS);
+            result.vertices           = parsed.attrib.vertices.size() / 3;
+            result.indices            = indexCount(parsed);
+
+            if (run != 0)
+                continue;
+
+            // The first loader's parse is the reference for the others
+            if (&result == &this->results.front())
+                first = std::move(parsed);
+            else if (!sameMesh(first, parsed))
+                this->identical = false;
+        }
+    }
+}
+
+void
+LoaderBenchmark::print(std::ostream& out) const
+{
+    const double megabytes = static_cast<double>(this->fileBytes) / (1024.0 * 1024.0);
+    const uint64_t chunks  = std::min<uint64_t>(this->fileBytes / MAPPED_CHUNK_BYTES + 1, this->threads);
+
+    out << "Loader benchmark: " << this->filePath << (this->generated ? " (synthetic)" : "") << ", " << RUNS << " runs" << std::endl;
+    out << std::fixed << std::setprecision(2);
+    out << "\t" << megabytes << " MiB, LoadObjMapped splits it into " << chunks << " chunks on " << this->threads << " threads" << std::endl;
+
+    for (const auto& result : this->results)
+    {
+        out << "\t" << loaderName(result.mode) << ": "
+            << result.bestMilliseconds << " ms best, " << result.meanMilliseconds << " ms mean, "
+            << 1000.0 * megabytes / std::max(result.bestMilliseconds, 1e-9) << " MiB/s, "
+            << result.vertices << " positions, " << result.indices << " indices" << std::endl;
+    }
+
+    if (this->results.size() == 2)
+    {
+        const double speedup = this->results[0].bestMilliseconds / std::max(this->results[1].bestMilliseconds, 1e-9);
+        out << "\tMapped speedup: " << speedup << "x" << std::endl;
+    }
+
+    out << "\tMeshes " << (this->identical ? "match" : "DIFFER") << std::endl;
+    out << std::defaultfloat;
+}
\ No newline at end of file
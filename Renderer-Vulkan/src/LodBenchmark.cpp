@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include <LodBenchmark.hpp>
+
+LodBenchmark::LodBenchmark(std::shared_ptr<Model> model) :
+    model(std::move(model))
+{ }
+
+void
+LodBenchmark::layoutObjects(std::vector<Object>& objects) const
+{
+    objects.clear();
+    objects.reserve(this->current.objects);
+
+    const Model::Bounds& bounds = this->model->getBounds();
+    const float diagonal        = glm::length(bounds.max - bounds.min);
+    const float scale           = diagonal > 0.0f ? 1.0f / diagonal : 1.0f;
+    const glm::vec3 center      = (bounds.min + bounds.max) * 0.5f;
+    const uint32_t columns      = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(this->current.objects))));
+
+    // Rows run away from the camera, so the far ones fall to coarser LODs
+    for (uint32_t i = 0; i < this->current.objects; i++)
+    {
+        const float column = static_cast<float>(i % columns) - 0.5f * static_cast<float>(columns - 1);
+        const float row    = static_cast<float>(i / columns + 1);
+
+        auto object                  = Object::createObject();
+        object.model                 = this->model;
+        object.color                 = { 0.1f, 0.8f, 0.1f };
+        object.transform.scale       = { scale, scale, scale };
+        object.transform.translation = glm::vec3(column * SPACING, 0.0f, row * SPACING) - center * scale;
+
+        objects.push_back(std::move(object));
+    }
+}
+
+void
+LodBenchmark::begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->steps.clear();
+    this->current         = { };
+    this->current.objects = 1;
+    this->elapsed         = 0.0f;
+
+    renderSystem.setLodSelection(this->current.lodSelection);
+    this->layoutObjects(objects);
+}
+
+bool
+LodBenchmark::update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->elapsed += frameTime;
+    if (this->elapsed > WARMUP_SECONDS)
+    {
+        this->current.frames++;
+        this->current.seconds             += frameTime;
+        this->current.triangles           += stats.triangles;
+        this->current.fullDetailTriangles += stats.fullDetailTriangles;
+    }
+
+    if (this->elapsed < WARMUP_SECONDS + MEASURE_SECONDS)
+        return true;
+
+    this->steps.push_back(this->current);
+
+    // Every object count runs with LOD selection first, then at full detail
+    Step next = { };
+    if (this->current.lodSelection)
+    {
+        next.objects      = this->current.objects;
+        next.lodSelection = false;
+    }
+    else
+    {
+        next.objects      = this->current.objects * 2;
+        next.lodSelection = true;
+    }
+
+    if (next.objects > MAX_OBJECTS)
+        return false;
+
+    const bool relayout = next.objects != this->current.objects;
+    this->current       = next;
+    this->elapsed       = 0.0f;
+
+    renderSystem.setLodSelection(this->current.lodSelection);
+    if (relayout)
+        this->layoutObjects(objects);
+
+    return true;
+}
+
+void
+LodBenchmark::setCamera(Camera& camera, float aspect) const
+{
+    const float gridDepth = std::sqrt(static_cast<float>(MAX_OBJECTS)) * SPACING;
+
+    camera.setViewTarget(glm::vec3(0.0f, -2.0f, -1.0f), glm::vec3(0.0f, 0.0f, 0.25f * gridDepth));
+    camera.setPerspectiveProjection(glm::radians(55.0f), aspect, 0.1f, 2.0f * gridDepth);
+}
+
+void
+LodBenchmark::print(std::ostream& out) const
+{
+    out << "LOD benchmark:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    for (const auto& step : this->steps)
+    {
+        const double frames  = static_cast<double>(std::max(step.frames, 1u));
+        const double seconds = std::max(step.seconds, 1e-9);
+        const double full    = static_cast<double>(std::max<uint64_t>(step.fullDetailTriangles, 1));
+        const double share   = 100.0 * static_cast<double>(step.triangles) / full;
+
+        out << "\t" << std::setw(4) << step.objects << " objects, " << (step.lodSelection ? "LOD        " : "full detail") << ": "
+            << 1000.0 * seconds / frames << " ms/frame, "
+            << static_cast<double>(step.triangles) / frames / 1000.0 << "k triangles/frame (" << share << "% of full detail), "
+            << static_cast<double>(step.triangles) / seconds / 1000000.0 << "M triangles/s" << std::endl;
+    }
+
+    out << std::defaultfloat;
+}
\ No newline at end of file
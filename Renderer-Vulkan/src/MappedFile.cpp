@@ -0,0 +1,90 @@
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <MappedFile.hpp>
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& filePath)
+{
+    this->file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (this->file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to Open File: " + filePath);
+
+    LARGE_INTEGER fileSize = { };
+    if (!GetFileSizeEx(this->file, &fileSize))
+    {
+        CloseHandle(this->file);
+        throw std::runtime_error("Failed to Query File Size: " + filePath);
+    }
+
+    this->size_ = static_cast<size_t>(fileSize.QuadPart);
+    if (this->size_ == 0)
+        return;
+
+    this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (this->mapping != nullptr)
+        this->data_ = static_cast<const char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (this->data_ == nullptr)
+    {
+        if (this->mapping != nullptr)
+            CloseHandle(this->mapping);
+        CloseHandle(this->file);
+        throw std::runtime_error("Failed to Map File: " + filePath);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (this->data_ != nullptr)
+        UnmapViewOfFile(this->data_);
+    if (this->mapping != nullptr)
+        CloseHandle(this->mapping);
+    CloseHandle(this->file);
+}
+#else
+MappedFile::MappedFile(const std::string& filePath)
+{
+    this->fd = open(filePath.c_str(), O_RDONLY);
+    if (this->fd < 0)
+        throw std::runtime_error("Failed to Open File: " + filePath);
+
+    struct stat fileInfo = { };
+    if (fstat(this->fd, &fileInfo) != 0)
+    {
+        close(this->fd);
+        throw std::runtime_error("Failed to Query File Size: " + filePath);
+    }
+
+    this->size_ = static_cast<size_t>(fileInfo.st_size);
+    if (this->size_ == 0)
+        return;
+
+    void* address = mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, this->fd, 0);
+    if (address == MAP_FAILED)
+    {
+        close(this->fd);
+        throw std::runtime_error("Failed to Map File: " + filePath);
+    }
+
+    this->data_ = static_cast<const char*>(address);
+}
+
+MappedFile::~MappedFile()
+{
+    if (this->data_ != nullptr)
+        munmap(const_cast<char*>(this->data_), this->size_);
+    close(this->fd);
+}
+#endif
\ No newline at end of file
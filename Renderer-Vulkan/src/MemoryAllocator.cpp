@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include <MemoryAllocator.hpp>
+
+static uint32_t
+floorLog2(uint64_t value)
+{
+    uint32_t log2 = 0;
+    while (value >>= 1)
+        log2++;
+
+    return log2;
+}
+
+static uint32_t
+lowestBit(uint64_t value)
+{
+    uint32_t bit = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        bit++;
+    }
+
+    return bit;
+}
+
+static VkDeviceSize
+alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+MemoryAllocator::Tlsf::Tlsf(VkDeviceSize size)
+{
+    for (auto& row : this->heads)
+        std::fill(std::begin(row), std::end(row), NONE);
+
+    if (size == 0)
+        return;
+
+    const uint32_t node    = this->createNode();
+    this->nodes[node].size = size;
+    this->nodes[node].free = true;
+    this->insertFree(node);
+}
+
+void
+MemoryAllocator::Tlsf::mapping(VkDeviceSize size, uint32_t& fl, uint32_t& sl)
+{
+    if (size < SMALL_SIZE)
+    {
+        fl = 0;
+        sl = static_cast<uint32_t>(size / (SMALL_SIZE / SL_COUNT));
+        return;
+    }
+
+    const uint32_t log2 = floorLog2(size);
+    fl                  = log2 - SMALL_SIZE_LOG2 + 1;
+    sl                  = static_cast<uint32_t>(size >> (log2 - SL_BITS)) ^ SL_COUNT;
+}
+
+uint32_t
+MemoryAllocator::Tlsf::createNode()
+{
+    if (!this->spare.empty())
+    {
+        const uint32_t node = this->spare.back();
+        this->spare.pop_back();
+        this->nodes[node]   = { };
+        return node;
+    }
+
+    this->nodes.emplace_back();
+    return static_cast<uint32_t>(this->nodes.size() - 1);
+}
+
+void
+MemoryAllocator::Tlsf::insertFree(uint32_t node)
+{
+    uint32_t fl = 0, sl = 0;
+    mapping(this->nodes[node].size, fl, sl);
+
+    const uint32_t head          = this->heads[fl][sl];
+    this->nodes[node].prevFree   = NONE;
+    this->nodes[node].nextFree   = head;
+    if (head != NONE)
+        this->nodes[head].prevFree = node;
+
+    this->heads[fl][sl]  = node;
+    this->flBitmap      |= uint64_t(1) << fl;
+    this->slBitmap[fl]  |= 1u << sl;
+}
+
+void
+MemoryAllocator::Tlsf::removeFree(uint32_t node)
+{
+    uint32_t fl = 0, sl = 0;
+    mapping(this->nodes[node].size, fl, sl);
+
+    const uint32_t prevFree = this->nodes[node].prevFree;
+    const uint32_t nextFree = this->nodes[node].nextFree;
+    if (prevFree != NONE)
+        this->nodes[prevFree].nextFree = nextFree;
+    else
+        this->heads[fl][sl] = nextFree;
+
+    if (nextFree != NONE)
+        this->nodes[nextFree].prevFree = prevFree;
+
+    if (this->heads[fl][sl] == NONE)
+    {
+        this->slBitmap[fl] &= ~(1u << sl);
+        if (this->slBitmap[fl] == 0)
+            this->flBitmap &= ~(uint64_t(1) << fl);
+    }
+}
+
+VkDeviceSize
+MemoryAllocator::Tlsf::searchSize(VkDeviceSize size, VkDeviceSize alignment)
+{
+    size      = alignUp(std::max<VkDeviceSize>(size, 1), MIN_ALIGN);
+    alignment = std::max(alignment, MIN_ALIGN);
+
+    // Every node starts MIN_ALIGN aligned, so only larger alignments need room for padding
+    if (alignment > MIN_ALIGN)
+        size += alignment - MIN_ALIGN;
+
+    // Round up to the next size class, so whatever heads it is large enough. Small classes
+    // are MIN_ALIGN wide, which size already is a multiple of
+    if (size >= SMALL_SIZE)
+        size = alignUp(size, VkDeviceSize(1) << (floorLog2(size) - SL_BITS));
+
+    return size;
+}
+
+uint32_t
+MemoryAllocator::Tlsf::findFree(VkDeviceSize size) const
+{
+    uint32_t fl = 0, sl = 0;
+    mapping(size, fl, sl);
+    if (fl >= FL_COUNT)
+        return NONE;
+
+    uint32_t slMap = this->slBitmap[fl] & (~0u << sl);
+    if (slMap == 0)
+    {
+        const uint64_t flMap = fl + 1 < 64 ? this->flBitmap & (~uint64_t(0) << (fl + 1)) : 0;
+        if (flMap == 0)
+            return NONE;
+
+        fl    = lowestBit(flMap);
+        slMap = this->slBitmap[fl];
+    }
+
+    return this->heads[fl][lowestBit(slMap)];
+}
+
+void
+MemoryAllocator::Tlsf::split(uint32_t node, VkDeviceSize size)
+{
+    assert(size < this->nodes[node].size && "Split Must Leave a Remainder");
+
+    // createNode may grow nodes, so nothing holds a reference across it
+    const uint32_t rest      = this->createNode();
+    const uint32_t next      = this->nodes[node].next;
+    this->nodes[rest].offset = this->nodes[node].offset + size;
+    this->nodes[rest].size   = this->nodes[node].size - size;
+    this->nodes[rest].prev   = node;
+    this->nodes[rest].next   = next;
+    this->nodes[rest].free   = true;
+    if (next != NONE)
+        this->nodes[next].prev = rest;
+
+    this->nodes[node].next = rest;
+    this->nodes[node].size = size;
+    this->insertFree(rest);
+}
+
+uint32_t
+MemoryAllocator::Tlsf::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+{
+    size      = alignUp(std::max<VkDeviceSize>(size, 1), MIN_ALIGN);
+    alignment = std::max(alignment, MIN_ALIGN);
+
+    uint32_t node = this->findFree(searchSize(size, alignment));
+    if (node == NONE)
+        return NONE;
+
+    this->removeFree(node);
+    this->nodes[node].free = false;
+
+    // The padding goes back as a free node of its own; the one before is never free
+    const VkDeviceSize padding = alignUp(this->nodes[node].offset, alignment) - this->nodes[node].offset;
+    if (padding > 0)
+    {
+        this->split(node, padding);
+        const uint32_t front = node;
+        node                 = this->nodes[front].next;
+
+        this->removeFree(node);
+        this->nodes[node].free  = false;
+        this->nodes[front].free = true;
+        this->insertFree(front);
+    }
+
+    if (this->nodes[node].size > size)
+        this->split(node, size);
+
+    this->used += this->nodes[node].size;
+    offset      = this->nodes[node].offset;
+
+    return node;
+}
+
+void
+MemoryAllocator::Tlsf::free(uint32_t node)
+{
+    assert(!this->nodes[node].free && "Node Already Free");
+
+    this->used            -= this->nodes[node].size;
+    this->nodes[node].free = true;
+
+    // Merge with free physical neighbours, so no two free nodes are ever adjacent
+    const uint32_t prev = this->nodes[node].prev;
+    if (prev != NONE && this->nodes[prev].free)
+    {
+        this->removeFree(prev);
+        this->nodes[prev].size += this->nodes[node].size;
+        this->nodes[prev].next  = this->nodes[node].next;
+        if (this->nodes[node].next != NONE)
+            this->nodes[this->nodes[node].next].prev = prev;
+
+        this->spare.push_back(node);
+        node = prev;
+    }
+
+    const uint32_t next = this->nodes[node].next;
+    if (next != NONE && this->nodes[next].free)
+    {
+        this->removeFree(next);
+        this->nodes[node].size += this->nodes[next].size;
+        this->nodes[node].next  = this->nodes[next].next;
+        if (this->nodes[next].next != NONE)
+            this->nodes[this->nodes[next].next].prev = node;
+
+        this->spare.push_back(next);
+    }
+
+    this->insertFree(node);
+}
+
+MemoryAllocator::MemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize) :
+    device(device),
+    preferredBlockSize(preferredBlockSize)
+{
+    VkPhysicalDeviceProperties properties = { };
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &this->memoryProperties);
+
+    this->bufferImageGranularity = properties.limits.bufferImageGranularity;
+    this->maxAllocationCount     = properties.limits.maxMemoryAllocationCount;
+
+    this->pools.resize(2 * this->memoryProperties.memoryTypeCount);
+    for (uint32_t i = 0; i < this->pools.size(); i++)
+        this->pools[i].memoryType = i / 2;
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    for (auto& pool : this->pools)
+    {
+        for (auto& block : pool.blocks)
+        {
+            if (block.memory != nullptr)
+                this->freeMemory(block.memory, block.mapped != nullptr);
+        }
+    }
+}
+
+uint32_t
+MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < this->memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (this->memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("Failed to Find Suitable Memory Type!");
+}
+
+uint32_t
+MemoryAllocator::poolIndex(uint32_t memoryType, Tiling tiling) const
+{
+    // Without a granularity to respect, both tilings share the linear pool
+    const bool separate = this->bufferImageGranularity > 1 && tiling == Tiling::Optimal;
+    return 2 * memoryType + (separate ? 1 : 0);
+}
+
+VkDeviceSize
+MemoryAllocator::largestBlockSize(uint32_t memoryType) const
+{
+    // Small heaps get proportionally small blocks
+    const uint32_t heap         = this->memoryProperties.memoryTypes[memoryType].heapIndex;
+    const VkDeviceSize heapSize = this->memoryProperties.memoryHeaps[heap].size;
+
+    return std::min(this->preferredBlockSize, std::max<VkDeviceSize>(heapSize / 8, MIN_ALIGN));
+}
+
+VkDeviceSize
+MemoryAllocator::blockSizeFor(const Pool& pool, VkDeviceSize size) const
+{
+    const VkDeviceSize largestSize = this->largestBlockSize(pool.memoryType);
+
+    // The first blocks start at an eighth of that and double, so small scenes stay small
+    uint32_t liveBlocks = 0;
+    for (const auto& block : pool.blocks)
+        liveBlocks += block.memory != nullptr ? 1 : 0;
+
+    VkDeviceSize blockSize = largestSize >> (3 - std::min(liveBlocks, 3u));
+    while (blockSize < size && blockSize < largestSize)
+        blockSize *= 2;
+
+    return std::max(blockSize, size);
+}
+
+VkDeviceMemory
+MemoryAllocator::allocateMemory(uint32_t memoryType, VkDeviceSize size, char** mapped)
+{
+    if (this->allocationCount >= this->maxAllocationCount)
+        throw std::runtime_error("Device Memory Allocation Count Exceeded!");
+
+    VkMemoryAllocateInfo allocInfo = { };
+    allocInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize       = size;
+    allocInfo.memoryTypeIndex      = memoryType;
+
+    VkDeviceMemory memory = nullptr;
+    if (vkAllocateMemory(this->device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Allocate Device Memory!");
+
+    this->allocationCount++;
+    this->allocateCalls++;
+
+    *mapped = nullptr;
+    if (this->memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void* data = nullptr;
+        if (vkMapMemory(this->device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Map Device Memory!");
+
+        *mapped = static_cast<char*>(data);
+    }
+
+    return memory;
+}
+
+void
+MemoryAllocator::freeMemory(VkDeviceMemory memory, bool mapped)
+{
+    if (mapped)
+        vkUnmapMemory(this->device, memory);
+
+    vkFreeMemory(this->device, memory, nullptr);
+    this->allocationCount--;
+}
+
+MemoryAllocation
+MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, Tiling tiling)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    const uint32_t memoryType = this->findMemoryType(requirements.memoryTypeBits, properties);
+    MemoryAllocation allocation = { };
+    allocation.pool             = this->poolIndex(memoryType, tiling);
+    Pool& pool                  = this->pools[allocation.pool];
+
+    // Large resources would leave most of a block unusable around them
+    if (requirements.size > this->largestBlockSize(memoryType) / 2)
+    {
+        char* mapped          = nullptr;
+        allocation.memory     = this->allocateMemory(memoryType, requirements.size, &mapped);
+        allocation.size       = requirements.size;
+        allocation.mapped     = mapped;
+        allocation.dedicated  = true;
+        pool.dedicatedCount++;
+        pool.dedicatedBytes  += requirements.size;
+
+        return allocation;
+    }
+
+    VkDeviceSize offset = 0;
+    uint32_t node       = NONE;
+    uint32_t block      = 0;
+    for (; block < pool.blocks.size(); block++)
+    {
+        if (pool.blocks[block].memory == nullptr)
+            continue;
+
+        node = pool.blocks[block].tlsf.allocate(requirements.size, requirements.alignment, offset);
+        if (node != NONE)
+            break;
+    }
+
+    if (node == NONE)
+    {
+        // Sized for the class the request is looked up in, not just its bytes, or a block
+        // between the two would be too small for findFree
+        const VkDeviceSize blockSize = this->blockSizeFor(pool, Tlsf::searchSize(requirements.size, requirements.alignment));
+
+        block = 0;
+        while (block < pool.blocks.size() && pool.blocks[block].memory != nullptr)
+            block++;
+
+        Block created  = Block(blockSize);
+        created.memory = this->allocateMemory(memoryType, blockSize, &created.mapped);
+        if (block < pool.blocks.size())
+            pool.blocks[block] = std::move(created);
+        else
+            pool.blocks.push_back(std::move(created));
+
+        node = pool.blocks[block].tlsf.allocate(requirements.size, requirements.alignment, offset);
+        if (node == NONE)
+            throw std::runtime_error("Fresh Memory Block Does Not Fit the Allocation!");
+    }
+
+    const Block& owner = pool.blocks[block];
+    allocation.memory  = owner.memory;
+    allocation.offset  = offset;
+    allocation.size    = requirements.size;
+    allocation.mapped  = owner.mapped != nullptr ? owner.mapped + offset : nullptr;
+    allocation.block   = block;
+    allocation.node    = node;
+
+    return allocation;
+}
+
+void
+MemoryAllocator::free(MemoryAllocation& allocation)
+{
+    if (allocation.memory == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    Pool& pool = this->pools[allocation.pool];
+    if (allocation.dedicated)
+    {
+        this->freeMemory(allocation.memory, allocation.mapped != nullptr);
+        pool.dedicatedCount--;
+        pool.dedicatedBytes -= allocation.size;
+        allocation           = { };
+        return;
+    }
+
+    Block& block = pool.blocks[allocation.block];
+    assert(block.memory == allocation.memory && "Allocation Does Not Belong to Its Block");
+    block.tlsf.free(allocation.node);
+    allocation = { };
+
+    // Empty blocks are returned unless they are the last one of the pool
+    if (!block.tlsf.empty())
+        return;
+
+    const bool lastBlock = std::none_of(pool.blocks.begin(), pool.blocks.end(),
+        [&block](const Block& other) { return &other != &block && other.memory != nullptr; });
+
+    if (!lastBlock)
+    {
+        this->freeMemory(block.memory, block.mapped != nullptr);
+        block = Block(0);
+    }
+}
+
+MemoryStats
+MemoryAllocator::getStats()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    MemoryStats stats        = { };
+    stats.allocationCount    = this->allocationCount;
+    stats.maxAllocationCount = this->maxAllocationCount;
+    stats.allocateCalls      = this->allocateCalls;
+    stats.heaps.resize(this->memoryProperties.memoryHeapCount);
+
+    for (uint32_t i = 0; i < this->memoryProperties.memoryHeapCount; i++)
+    {
+        stats.heaps[i].size        = this->memoryProperties.memoryHeaps[i].size;
+        stats.heaps[i].deviceLocal = (this->memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    for (const auto& pool : this->pools)
+    {
+        MemoryStats::Heap& heap = stats.heaps[this->memoryProperties.memoryTypes[pool.memoryType].heapIndex];
+        heap.dedicatedCount    += pool.dedicatedCount;
+        heap.dedicatedBytes    += pool.dedicatedBytes;
+
+        for (const auto& block : pool.blocks)
+        {
+            if (block.memory == nullptr)
+                continue;
+
+            heap.blockCount++;
+            heap.blockBytes += block.size;
+            heap.usedBytes  += block.tlsf.usedBytes();
+        }
+    }
+
+    return stats;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include <MeshCache.hpp>
+#include <Utilities.hpp>
+
+static uint64_t
+alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Written without offset + size, which a corrupt header can overflow past the file size
+static bool
+sectionFits(uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+    return offset % MeshCache::SECTION_ALIGNMENT == 0 && offset <= fileSize && size <= fileSize - offset;
+}
+
+MeshCache::Entry::Entry(const std::string& filePath, uint64_t sourceHash) :
+    file(filePath)
+{
+    if (this->file.size() < sizeof(Header))
+        throw std::runtime_error("Mesh Cache File is Truncated: " + filePath);
+
+    Header header = { };
+    memcpy(&header, this->file.data(), sizeof(Header));
+
+    const uint64_t vertexBytes = static_cast<uint64_t>(header.vertexCount) * sizeof(Model::Vertex);
+    const uint64_t indexBytes  = static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t);
+    const uint64_t lodBytes    = static_cast<uint64_t>(header.lodCount) * sizeof(Model::Lod);
+
+    if (memcmp(header.magic, Header().magic, sizeof(header.magic)) != 0   ||
+        header.version      != VERSION                                    ||
+        header.vertexStride != sizeof(Model::Vertex)                      ||
+        header.sourceHash   != sourceHash                                 ||
+        !sectionFits(header.vertexOffset, vertexBytes, this->file.size()) ||
+        !sectionFits(header.indexOffset, indexBytes, this->file.size())   ||
+        !sectionFits(header.lodOffset, lodBytes, this->file.size())       ||
+        header.lodCount     == 0)
+        throw std::runtime_error("Mesh Cache File is Stale or Corrupt: " + filePath);
+
+    const Model::Lod* lods = reinterpret_cast<const Model::Lod*>(this->file.data() + header.lodOffset);
+    for (uint32_t i = 0; i < header.lodCount; i++)
+    {
+        if (static_cast<uint64_t>(lods[i].firstIndex) + lods[i].indexCount > header.indexCount)
+            throw std::runtime_error("Mesh Cache File is Stale or Corrupt: " + filePath);
+    }
+
+    this->mesh_.vertices    = reinterpret_cast<const Model::Vertex*>(this->file.data() + header.vertexOffset);
+    this->mesh_.vertexCount = header.vertexCount;
+    this->mesh_.indices     = reinterpret_cast<const uint32_t*>(this->file.data() + header.indexOffset);
+    this->mesh_.indexCount  = header.indexCount;
+    this->mesh_.lods        = lods;
+    this->mesh_.lodCount    = header.lodCount;
+    this->mesh_.bounds      = header.bounds;
+}
+
+MeshCache::MeshCache(const std::string& directory) :
+    directory(directory)
+{ }
+
+std::string
+MeshCache::entryPath(uint64_t sourceHash) const
+{
+    char name[17] = { };
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(sourceHash));
+
+    return this->directory + "/" + name + ".mesh";
+}
+
+uint64_t
+MeshCache::hashSource(const std::string& filePath) const
+{
+    uint64_t hash = hashBytes(&VERSION, sizeof(VERSION), sizeof(Model::Vertex));
+
+    MappedFile obj = { filePath };
+    hash           = hashBytes(obj.data(), obj.size(), hash);
+
+    // Also key on every .mtl the .obj pulls in, resolved like tinyobj::LoadObj does
+    const std::string_view text = obj.size() > 0 ? std::string_view(obj.data(), obj.size()) : std::string_view();
+    for (size_t position = text.find("mtllib"); position != std::string_view::npos; position = text.find("mtllib", position + 6))
+    {
+        size_t lineStart = position;
+        while (lineStart > 0 && (text[lineStart - 1] == ' ' || text[lineStart - 1] == '\t'))
+            lineStart--;
+
+        if (lineStart > 0 && text[lineStart - 1] != '\n' && text[lineStart - 1] != '\r')
+            continue;
+
+        size_t lineEnd = text.find_first_of("\r\n", position);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+
+        std::string_view names = text.substr(position + 6, lineEnd - position - 6);
+        while (!names.empty())
+        {
+            const size_t nameStart = names.find_first_not_of(" \t");
+            if (nameStart == std::string_view::npos)
+                break;
+
+            names                  = names.substr(nameStart);
+            const size_t nameEnd   = std::min(names.find_first_of(" \t"), names.size());
+            const std::string name = std::string(names.substr(0, nameEnd));
+            names                  = names.substr(nameEnd);
+
+            hash = hashBytes(name.data(), name.size(), hash);
+            if (std::filesystem::is_regular_file(name))
+            {
+                MappedFile mtl = { name };
+                hash           = hashBytes(mtl.data(), mtl.size(), hash);
+            }
+        }
+    }
+
+    return hash;
+}
+
+std::unique_ptr<MeshCache::Entry>
+MeshCache::load(uint64_t sourceHash) const
+{
+    const std::string path = this->entryPath(sourceHash);
+    if (!std::filesystem::is_regular_file(path))
+        return nullptr;
+
+    try
+    {
+        return std::make_unique<Entry>(path, sourceHash);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+bool
+MeshCache::store(uint64_t sourceHash, const Model::Builder& builder) const
+{
+    Header header       = { };
+    header.sourceHash   = sourceHash;
+    header.vertexCount  = static_cast<uint32_t>(builder.vertices.size());
+    header.indexCount   = static_cast<uint32_t>(builder.indices.size());
+    header.lodCount     = static_cast<uint32_t>(builder.lods.size());
+    header.bounds       = builder.bounds;
+    header.vertexOffset = alignUp(sizeof(Header), SECTION_ALIGNMENT);
+    header.indexOffset  = alignUp(header.vertexOffset + builder.vertices.size() * sizeof(Model::Vertex), SECTION_ALIGNMENT);
+    header.lodOffset    = alignUp(header.indexOffset + builder.indices.size() * sizeof(uint32_t), SECTION_ALIGNMENT);
+
+    const std::string path     = this->entryPath(sourceHash);
+    const std::string tempPath = path + ".tmp";
+
+    try
+    {
+        std::filesystem::create_directories(this->directory);
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            const char zeros[SECTION_ALIGNMENT] = { };
+
+            const std::streamsize vertexBytes = static_cast<std::streamsize>(builder.vertices.size() * sizeof(Model::Vertex));
+            const std::streamsize indexBytes  = static_cast<std::streamsize>(builder.indices.size() * sizeof(uint32_t));
+            const std::streamsize lodBytes    = static_cast<std::streamsize>(builder.lods.size() * sizeof(Model::Lod));
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            file.write(zeros, static_cast<std::streamsize>(header.vertexOffset - sizeof(Header)));
+            file.write(reinterpret_cast<const char*>(builder.vertices.data()), vertexBytes);
+            file.write(zeros, static_cast<std::streamsize>(header.indexOffset - header.vertexOffset) - vertexBytes);
+            file.write(reinterpret_cast<const char*>(builder.indices.data()), indexBytes);
+            file.write(zeros, static_cast<std::streamsize>(header.lodOffset - header.indexOffset) - indexBytes);
+            file.write(reinterpret_cast<const char*>(builder.lods.data()), lodBytes);
+
+            if (!file)
+                throw std::runtime_error("Failed to Write Mesh Cache File: " + tempPath);
+        }
+
+        // Readers only ever see a complete file
+        std::filesystem::rename(tempPath, path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::error_code ignored = { };
+        std::filesystem::remove(tempPath, ignored);
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <MeshSimplifier.hpp>
+
+// Border planes are weighted up so open edges keep their silhouette
+static constexpr double BORDER_WEIGHT = 10.0;
+
+// Collapses may turn a triangle's normal by at most about 60 degrees, which also rules out flips
+static constexpr float MIN_NORMAL_COSINE = 0.5f;
+
+struct Edge
+{
+    uint64_t key      = 0;  // Lower position id in the upper half
+    uint32_t from     = 0;  // Directed as in the triangle
+    uint32_t to       = 0;
+    uint32_t triangle = 0;
+};
+
+// Every triangle edge in position ids, sorted so the triangles sharing an edge are adjacent
+static void
+collectEdges(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& positionOf, std::vector<Edge>& edges)
+{
+    edges.clear();
+    edges.reserve(indices.size());
+
+    for (size_t t = 0; t < indices.size() / 3; t++)
+    {
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            const uint32_t from = positionOf[indices[3 * t + corner]];
+            const uint32_t to   = positionOf[indices[3 * t + (corner + 1) % 3]];
+            const uint64_t key  = (static_cast<uint64_t>(std::min(from, to)) << 32) | std::max(from, to);
+
+            edges.push_back({ key, from, to, static_cast<uint32_t>(t) });
+        }
+    }
+
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.key < b.key; });
+}
+
+MeshSimplifier::Quadric
+MeshSimplifier::Quadric::fromPlane(const glm::vec3& normal, float distance, double weight)
+{
+    const double a = normal.x;
+    const double b = normal.y;
+    const double c = normal.z;
+    const double d = distance;
+
+    Quadric quadric = { };
+    quadric.a2      = weight * a * a;
+    quadric.ab      = weight * a * b;
+    quadric.ac      = weight * a * c;
+    quadric.ad      = weight * a * d;
+    quadric.b2      = weight * b * b;
+    quadric.bc      = weight * b * c;
+    quadric.bd      = weight * b * d;
+    quadric.c2      = weight * c * c;
+    quadric.cd      = weight * c * d;
+    quadric.d2      = weight * d * d;
+    quadric.weight  = weight;
+
+    return quadric;
+}
+
+MeshSimplifier::Quadric&
+MeshSimplifier::Quadric::operator+=(const Quadric& other)
+{
+    this->a2     += other.a2;
+    this->ab     += other.ab;
+    this->ac     += other.ac;
+    this->ad     += other.ad;
+    this->b2     += other.b2;
+    this->bc     += other.bc;
+    this->bd     += other.bd;
+    this->c2     += other.c2;
+    this->cd     += other.cd;
+    this->d2     += other.d2;
+    this->weight += other.weight;
+
+    return *this;
+}
+
+double
+MeshSimplifier::Quadric::evaluate(const glm::vec3& point) const
+{
+    const double x = point.x;
+    const double y = point.y;
+    const double z = point.z;
+
+    return this->a2 * x * x + this->b2 * y * y + this->c2 * z * z +
+           2.0 * (this->ab * x * y + this->ac * x * z + this->bc * y * z) +
+           2.0 * (this->ad * x + this->bd * y + this->cd * z) +
+           this->d2;
+}
+
+MeshSimplifier::MeshSimplifier(const std::vector<Model::Vertex>& vertices, const uint32_t* indices, size_t indexCount) :
+    vertices(vertices),
+    indices_(indices, indices + indexCount)
+{
+    this->groupPositions();
+    this->computeQuadrics();
+
+    this->collapsedTo.resize(this->wedgeBase.size() - 1);
+    std::iota(this->collapsedTo.begin(), this->collapsedTo.end(), 0);
+}
+
+const glm::vec3&
+MeshSimplifier::position(uint32_t positionId) const
+{
+    return this->vertices[this->wedges[this->wedgeBase[positionId]]].position;
+}
+
+void
+MeshSimplifier::groupPositions()
+{
+    const size_t vertexCount = this->vertices.size();
+
+    this->wedges.resize(vertexCount);
+    std::iota(this->wedges.begin(), this->wedges.end(), 0);
+    std::sort(this->wedges.begin(), this->wedges.end(), [this](uint32_t a, uint32_t b)
+    {
+        const glm::vec3& pa = this->vertices[a].position;
+        const glm::vec3& pb = this->vertices[b].position;
+        if (pa.x != pb.x)
+            return pa.x < pb.x;
+        if (pa.y != pb.y)
+            return pa.y < pb.y;
+        if (pa.z != pb.z)
+            return pa.z < pb.z;
+
+        return a < b;
+    });
+
+    this->positionOf.resize(vertexCount);
+    this->wedgeBase.clear();
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const uint32_t v = this->wedges[i];
+        if (i == 0 || !(this->vertices[v].position == this->vertices[this->wedges[i - 1]].position))
+            this->wedgeBase.push_back(static_cast<uint32_t>(i));
+
+        this->positionOf[v] = static_cast<uint32_t>(this->wedgeBase.size() - 1);
+    }
+
+    this->wedgeBase.push_back(static_cast<uint32_t>(vertexCount));
+
+    // Colors are what the renderer shows, so positions where they change stay put
+    const size_t positionCount = this->wedgeBase.size() - 1;
+    this->colorSeam.assign(positionCount, false);
+    for (size_t p = 0; p < positionCount; p++)
+    {
+        const glm::vec3& color = this->vertices[this->wedges[this->wedgeBase[p]]].color;
+        for (uint32_t i = this->wedgeBase[p] + 1; i < this->wedgeBase[p + 1]; i++)
+        {
+            if (!(this->vertices[this->wedges[i]].color == color))
+            {
+                this->colorSeam[p] = true;
+                break;
+            }
+        }
+    }
+}
+
+void
+MeshSimplifier::computeQuadrics()
+{
+    this->quadrics.assign(this->wedgeBase.size() - 1, Quadric());
+
+    // Area weighted plane of every triangle
+    for (size_t t = 0; t < this->indices_.size() / 3; t++)
+    {
+        const uint32_t p0 = this->positionOf[this->indices_[3 * t + 0]];
+        const uint32_t p1 = this->positionOf[this->indices_[3 * t + 1]];
+        const uint32_t p2 = this->positionOf[this->indices_[3 * t + 2]];
+
+        const glm::vec3 normal = glm::cross(this->position(p1) - this->position(p0), this->position(p2) - this->position(p0));
+        const float length     = glm::length(normal);
+        if (length == 0.0f)
+            continue;
+
+        const glm::vec3 unit  = normal / length;
+        const Quadric quadric = Quadric::fromPlane(unit, -glm::dot(unit, this->position(p0)), 0.5 * length);
+
+        this->quadrics[p0] += quadric;
+        this->quadrics[p1] += quadric;
+        this->quadrics[p2] += quadric;
+    }
+
+    // Plus a plane through every open edge, perpendicular to its triangle
+    std::vector<Edge> edges = { };
+    collectEdges(this->indices_, this->positionOf, edges);
+
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        const bool shared = (i > 0 && edges[i - 1].key == edges[i].key) ||
+                            (i + 1 < edges.size() && edges[i + 1].key == edges[i].key);
+        if (shared)
+            continue;
+
+        const uint32_t t       = edges[i].triangle;
+        const glm::vec3& p0    = this->position(this->positionOf[this->indices_[3 * t + 0]]);
+        const glm::vec3& p1    = this->position(this->positionOf[this->indices_[3 * t + 1]]);
+        const glm::vec3& p2    = this->position(this->positionOf[this->indices_[3 * t + 2]]);
+        const glm::vec3 edge   = this->position(edges[i].to) - this->position(edges[i].from);
+        const glm::vec3 normal = glm::cross(edge, glm::cross(p1 - p0, p2 - p0));
+        const float length     = glm::length(normal);
+        if (length == 0.0f)
+            continue;
+
+        const glm::vec3 unit  = normal / length;
+        const Quadric quadric = Quadric::fromPlane(unit, -glm::dot(unit, this->position(edges[i].from)), BORDER_WEIGHT * glm::dot(edge, edge));
+
+        this->quadrics[edges[i].from] += quadric;
+        this->quadrics[edges[i].to]   += quadric;
+    }
+}
+
+float
+MeshSimplifier::collapseError(uint32_t from, uint32_t to) const
+{
+    Quadric quadric = this->quadrics[from];
+    quadric        += this->quadrics[to];
+
+    if (quadric.weight <= 0.0)
+        return 0.0f;
+
+    return static_cast<float>(std::sqrt(std::max(quadric.evaluate(this->position(to)), 0.0) / quadric.weight));
+}
+
+uint32_t
+MeshSimplifier::nearestWedge(uint32_t vertex, uint32_t positionId) const
+{
+    const Model::Vertex& source = this->vertices[vertex];
+
+    uint32_t nearest = this->wedges[this->wedgeBase[positionId]];
+    float distance   = -1.0f;
+
+    for (uint32_t i = this->wedgeBase[positionId]; i < this->wedgeBase[positionId + 1]; i++)
+    {
+        const Model::Vertex& candidate = this->vertices[this->wedges[i]];
+        const glm::vec3 color          = candidate.color  - source.color;
+        const glm::vec3 normal         = candidate.normal - source.normal;
+        const glm::vec2 uv             = candidate.uv     - source.uv;
+        const float candidateDistance  = glm::dot(color, color) + glm::dot(normal, normal) + glm::dot(uv, uv);
+
+        if (distance < 0.0f || candidateDistance < distance)
+        {
+            nearest  = this->wedges[i];
+            distance = candidateDistance;
+        }
+    }
+
+    return nearest;
+}
+
+size_t
+MeshSimplifier::collapsePass(size_t targetTriangles, float maxError)
+{
+    const size_t positionCount = this->wedgeBase.size() - 1;
+    const size_t triangleCount = this->indices_.size() / 3;
+
+    std::vector<Edge> edges = { };
+    collectEdges(this->indices_, this->positionOf, edges);
+
+    // Classify positions by the edges around them in the current mesh
+    std::vector<uint8_t> borderEdges = std::vector<uint8_t>(positionCount, 0);
+    std::vector<Kind> kind           = std::vector<Kind>(positionCount, Kind::Interior);
+    for (size_t i = 0; i < edges.size();)
+    {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j].key == edges[i].key)
+            j++;
+
+        const uint32_t a = static_cast<uint32_t>(edges[i].key >> 32);
+        const uint32_t b = static_cast<uint32_t>(edges[i].key);
+        if (j - i == 1)
+        {
+            borderEdges[a] = static_cast<uint8_t>(std::min(borderEdges[a] + 1, 3));
+            borderEdges[b] = static_cast<uint8_t>(std::min(borderEdges[b] + 1, 3));
+        }
+        else if (j - i > 2)
+            kind[a] = kind[b] = Kind::Locked;
+
+        i = j;
+    }
+
+    for (size_t p = 0; p < positionCount; p++)
+    {
+        if (this->colorSeam[p] || (borderEdges[p] != 0 && borderEdges[p] != 2))
+            kind[p] = Kind::Locked;
+        else if (borderEdges[p] == 2 && kind[p] != Kind::Locked)
+            kind[p] = Kind::Border;
+    }
+
+    // Cheapest allowed direction of every edge
+    std::vector<Collapse> candidates = { };
+    for (size_t i = 0; i < edges.size();)
+    {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j].key == edges[i].key)
+            j++;
+
+        const uint32_t a      = static_cast<uint32_t>(edges[i].key >> 32);
+        const uint32_t b      = static_cast<uint32_t>(edges[i].key);
+        const bool borderEdge = j - i == 1;
+        i                     = j;
+
+        if (a == b)
+            continue;
+
+        Collapse best = { 0, 0, -1.0f };
+        for (const auto& [from, to] : { std::make_pair(a, b), std::make_pair(b, a) })
+        {
+            if (kind[from] == Kind::Locked || (kind[from] == Kind::Border && !borderEdge))
+                continue;
+
+            const float error = this->collapseError(from, to);
+            if (error <= maxError && (best.error < 0.0f || error < best.error))
+                best = { from, to, error };
+        }
+
+        if (best.error >= 0.0f)
+            candidates.push_back(best);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+    // Triangles around each position, to check collapses for flipped faces
+    std::vector<uint32_t> triangleBase = std::vector<uint32_t>(positionCount + 1, 0);
+    for (const auto index : this->indices_)
+        triangleBase[this->positionOf[index] + 1]++;
+
+    for (size_t p = 0; p < positionCount; p++)
+        triangleBase[p + 1] += triangleBase[p];
+
+    std::vector<uint32_t> triangles = std::vector<uint32_t>(this->indices_.size());
+    std::vector<uint32_t> filled    = std::vector<uint32_t>(triangleBase.begin(), triangleBase.end() - 1);
+    for (size_t i = 0; i < this->indices_.size(); i++)
+        triangles[filled[this->positionOf[this->indices_[i]]]++] = static_cast<uint32_t>(i / 3);
+
+    // Collapses in one pass must not share a triangle, so each flip check stays valid
+    std::vector<bool> touched = std::vector<bool>(positionCount, false);
+    size_t removed            = 0;
+
+    for (const auto& collapse : candidates)
+    {
+        if (triangleCount - removed <= targetTriangles)
+            break;
+
+        if (touched[collapse.from] || touched[collapse.to])
+            continue;
+
+        bool flips    = false;
+        size_t shared = 0;
+        for (uint32_t i = triangleBase[collapse.from]; i < triangleBase[collapse.from + 1] && !flips; i++)
+        {
+            const uint32_t t    = triangles[i];
+            uint32_t corners[3] = { };
+            for (size_t corner = 0; corner < 3; corner++)
+                corners[corner] = this->positionOf[this->indices_[3 * t + corner]];
+
+            if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to)
+            {
+                shared++;
+                continue;
+            }
+
+            const glm::vec3 before = glm::cross(this->position(corners[1]) - this->position(corners[0]),
+                                                this->position(corners[2]) - this->position(corners[0]));
+            for (auto& corner : corners)
+                corner = corner == collapse.from ? collapse.to : corner;
+
+            const glm::vec3 after  = glm::cross(this->position(corners[1]) - this->position(corners[0]),
+                                                this->position(corners[2]) - this->position(corners[0]));
+
+            const float lengths = glm::length(before) * glm::length(after);
+            if (glm::length(before) > 0.0f && glm::dot(before, after) <= MIN_NORMAL_COSINE * lengths)
+                flips = true;
+        }
+
+        if (flips)
+            continue;
+
+        this->collapsedTo[collapse.from] = collapse.to;
+        this->quadrics[collapse.to]     += this->quadrics[collapse.from];
+        this->error_                     = std::max(this->error_, collapse.error);
+        removed                         += shared;
+
+        touched[collapse.from] = true;
+        touched[collapse.to]   = true;
+        for (uint32_t i = triangleBase[collapse.from]; i < triangleBase[collapse.from + 1]; i++)
+        {
+            for (size_t corner = 0; corner < 3; corner++)
+                touched[this->positionOf[this->indices_[3 * triangles[i] + corner]]] = true;
+        }
+    }
+
+    if (removed == 0)
+        return 0;
+
+    // Move corners onto their collapse targets and drop the triangles that degenerated
+    size_t written = 0;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        uint32_t corners[3]   = { };
+        uint32_t positions[3] = { };
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            corners[corner]   = this->indices_[3 * t + corner];
+            positions[corner] = this->collapsedTo[this->positionOf[corners[corner]]];
+
+            if (positions[corner] != this->positionOf[corners[corner]])
+                corners[corner] = this->nearestWedge(corners[corner], positions[corner]);
+        }
+
+        if (positions[0] == positions[1] || positions[1] == positions[2] || positions[0] == positions[2])
+            continue;
+
+        for (size_t corner = 0; corner < 3; corner++)
+            this->indices_[written++] = corners[corner];
+    }
+
+    this->indices_.resize(written);
+
+    return triangleCount - written / 3;
+}
+
+void
+MeshSimplifier::simplify(size_t targetIndexCount, float maxError)
+{
+    const size_t targetTriangles = targetIndexCount / 3;
+
+    while (this->indices_.size() / 3 > targetTriangles)
+    {
+        if (this->collapsePass(targetTriangles, maxError) == 0)
+            break;
+    }
+}
\ No newline at end of file
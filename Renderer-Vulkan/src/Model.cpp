@@ -1,46 +1,144 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstring>
-#include <unordered_map>
 
-#define TINYOBJLOADER_IMPLEMENTATION
 #include <Objects/ObjectLoader.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
+#include <MeshCache.hpp>
+#include <MeshSimplifier.hpp>
 #include <Model.hpp>
 #include <Utilities.hpp>
+#include <VertexWelder.hpp>
 
+// Post-transform cache modelled by analyzeVertexCache (FIFO) and reorderForVertexCache (LRU)
+static constexpr uint32_t ANALYZE_CACHE_SIZE  = 16;
+static constexpr uint32_t OPTIMIZE_CACHE_SIZE = 32;
 
-namespace std
+// A LOD is only kept if it drops at least this share of the previous one's triangles
+static constexpr float LOD_MIN_REDUCTION = 0.15f;
+
+// Largest value of a 16-bit quantized position component
+static constexpr float POSITION_STEPS = 65535.0f;
+
+// Unit vector folded onto the octahedron and flattened to [-1, 1]^2
+static glm::vec2
+encodeOctahedral(const glm::vec3& normal)
 {
-    template <>
-    struct hash<Model::Vertex>
+    const float sum = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+    if (sum == 0.0f)
+        return glm::vec2(0.0f, 0.0f);
+
+    glm::vec2 encoded = glm::vec2(normal.x / sum, normal.y / sum);
+    if (normal.z < 0.0f)
     {
-        size_t operator()(Model::Vertex const& vertex) const {
-            size_t seed = 0;
-            hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-            return seed;
-        }
-    };
+        encoded = glm::vec2(
+            (1.0f - glm::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - glm::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f));
+    }
+
+    return encoded;
 }
 
-Model::Model(Device& device, const Builder& builder) :
-    device(device)
+static int16_t
+toSnorm16(float value)
 {
-    this->createVertexBuffers(builder.vertices);
-    this->createIndexBuffer(builder.indices);
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
 }
 
-Model::~Model()
+static uint8_t
+toUnorm8(float value)
 {
-    vkDestroyBuffer(this->device.device(), this->vertexBuffer, nullptr);
-    vkFreeMemory(this->device.device(), this->vertexBufferMemory, nullptr);
+    return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// IEEE 754 half, rounded to nearest even; overflow becomes infinity and NaN stays NaN
+static uint16_t
+toHalf(float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign     = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa       = bits & 0x7fffff;
 
-    if (this->hasIndexBuffer)
+    if (exponent == 0xff)
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0));
+
+    const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if (halfExponent >= 0x1f)
+        return static_cast<uint16_t>(sign | 0x7c00);
+
+    // Subnormal halves keep the implicit leading bit in the mantissa
+    uint32_t shift = 13;
+    if (halfExponent <= 0)
     {
-        vkDestroyBuffer(this->device.device(), this->indexBuffer, nullptr);
-        vkFreeMemory(this->device.device(), this->indexBufferMemory, nullptr);
+        if (halfExponent < -10)
+            return static_cast<uint16_t>(sign);
+
+        mantissa |= 0x800000;
+        shift    += static_cast<uint32_t>(1 - halfExponent);
     }
+
+    uint32_t half         = (halfExponent > 0 ? static_cast<uint32_t>(halfExponent) << 10 : 0) | (mantissa >> shift);
+    const uint32_t rest   = mantissa & ((1u << shift) - 1);
+    const uint32_t middle = 1u << (shift - 1);
+
+    // Carrying out of the mantissa correctly bumps the exponent
+    if (rest > middle || (rest == middle && (half & 1) != 0))
+        half++;
+
+    return static_cast<uint16_t>(sign | half);
+}
+
+Model::Model(Device& device, const Builder& builder, VertexFormat vertexFormat) :
+    Model(device, builder.meshData(), vertexFormat)
+{ }
+
+Model::Model(Device& device, const MeshData& mesh, VertexFormat vertexFormat) :
+    Model(device, mesh.bounds)
+{
+    this->vertexFormat = vertexFormat;
+    this->vertexCount  = mesh.vertexCount;
+    this->indexCount   = mesh.indexCount;
+    assert(this->vertexCount >= 3 && "Vertex Count Must be At Least 3");
+
+    float maxDistance2 = 0.0f;
+    for (uint32_t i = 0; i < mesh.vertexCount; i++)
+    {
+        const glm::vec3 offset = mesh.vertices[i].position - this->sphere.center;
+        maxDistance2           = std::max(maxDistance2, glm::dot(offset, offset));
+    }
+
+    this->sphere.radius = std::min(this->sphere.radius, std::sqrt(maxDistance2));
+
+    this->geometry = this->device.geometry().allocate(this->getVertexStride(), this->vertexCount, this->indexCount);
+    this->uploadVertices(mesh.vertices);
+    this->uploadIndices(mesh.indices);
+
+    if (mesh.lodCount > 0)
+        this->lods.assign(mesh.lods, mesh.lods + mesh.lodCount);
+    else
+        this->lods = { { 0, mesh.indexCount, 0.0f } };
+}
+
+Model::Model(Device& device, const Bounds& bounds) :
+    device(device),
+    bounds(bounds)
+{
+    // Around the bounds until a constructor with the vertices tightens it
+    this->sphere.center = 0.5f * (bounds.min + bounds.max);
+    this->sphere.radius = 0.5f * glm::length(bounds.max - bounds.min);
+}
+
+Model::~Model()
+{
+    this->device.uploads().wait(this->uploadTicket);
+
+    if (this->geometry != GeometryPool::INVALID_HANDLE)
+        this->device.geometry().free(this->geometry);
 }
 
 std::vector<VkVertexInputBindingDescription>
@@ -57,7 +155,7 @@ Model::Vertex::getBindingDescriptions()
 std::vector<VkVertexInputAttributeDescription>
 Model::Vertex::getAttributeDescriptions()
 {
-    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
     attributeDescriptions[0].binding  = 0;
     attributeDescriptions[0].location = 0;
     attributeDescriptions[0].format   = VK_FORMAT_R32G32B32_SFLOAT;
@@ -68,9 +166,82 @@ Model::Vertex::getAttributeDescriptions()
     attributeDescriptions[1].format   = VK_FORMAT_R32G32B32_SFLOAT;
     attributeDescriptions[1].offset   = offsetof(Vertex, color);
 
+    attributeDescriptions[2].binding  = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format   = VK_FORMAT_R32G32B32_SFLOAT;
+    attributeDescriptions[2].offset   = offsetof(Vertex, normal);
+
+    attributeDescriptions[3].binding  = 0;
+    attributeDescriptions[3].location = 3;
+    attributeDescriptions[3].format   = VK_FORMAT_R32G32_SFLOAT;
+    attributeDescriptions[3].offset   = offsetof(Vertex, uv);
+
+    return attributeDescriptions;
+}
+
+std::vector<VkVertexInputBindingDescription>
+Model::QuantizedVertex::getBindingDescriptions()
+{
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding   = 0;
+    bindingDescriptions[0].stride    = sizeof(QuantizedVertex);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription>
+Model::QuantizedVertex::getAttributeDescriptions()
+{
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
+    attributeDescriptions[0].binding  = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format   = VK_FORMAT_R16G16B16A16_UNORM;
+    attributeDescriptions[0].offset   = offsetof(QuantizedVertex, position);
+
+    attributeDescriptions[1].binding  = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format   = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[1].offset   = offsetof(QuantizedVertex, color);
+
+    attributeDescriptions[2].binding  = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format   = VK_FORMAT_R16G16_SNORM;
+    attributeDescriptions[2].offset   = offsetof(QuantizedVertex, normal);
+
+    attributeDescriptions[3].binding  = 0;
+    attributeDescriptions[3].location = 3;
+    attributeDescriptions[3].format   = VK_FORMAT_R16G16_SFLOAT;
+    attributeDescriptions[3].offset   = offsetof(QuantizedVertex, uv);
+
     return attributeDescriptions;
 }
 
+Model::QuantizedVertex
+Model::QuantizedVertex::quantize(const Vertex& vertex, const Bounds& bounds)
+{
+    const glm::vec3 extent = bounds.max - bounds.min;
+    QuantizedVertex packed = { };
+
+    for (int i = 0; i < 3; i++)
+    {
+        const float t      = extent[i] > 0.0f ? (vertex.position[i] - bounds.min[i]) / extent[i] : 0.0f;
+        packed.position[i] = static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * POSITION_STEPS));
+        packed.color[i]    = toUnorm8(vertex.color[i]);
+    }
+
+    packed.color[3]        = 255;
+
+    const glm::vec2 normal = encodeOctahedral(vertex.normal);
+    packed.normal[0]       = toSnorm16(normal.x);
+    packed.normal[1]       = toSnorm16(normal.y);
+
+    packed.uv[0]           = toHalf(vertex.uv.x);
+    packed.uv[1]           = toHalf(vertex.uv.y);
+
+    return packed;
+}
+
 #include <iostream>
 void
 Model::Builder::loadModel(const std::string& filePath)
@@ -80,19 +251,42 @@ Model::Builder::loadModel(const std::string& filePath)
     std::vector<tinyobj::material_t> materials = { };
     std::string warn, err                      = "";
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.c_str()))
+    bool loaded = false;
+    if (this->loaderMode == LoaderMode::Mapped)
+        loaded = tinyobj::LoadObjMapped(&attrib, &shapes, &materials, &warn, &err, filePath.c_str());
+    else
+        loaded = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.c_str());
+
+    if (!loaded)
         throw std::runtime_error(warn + err);
 
     this->vertices.clear();
     this->indices.clear();
 
-    std::unordered_map<Vertex, uint32_t> uniqueVertices = { };
-    int objectNumber = 0;
+    size_t cornerCount = 0;
+    for (const auto& shape : shapes)
+        cornerCount += shape.mesh.indices.size();
+
+    this->indices.reserve(cornerCount);
+
+    // Most corners repeat an (v, vn, vt) tuple already seen, which skips building and hashing the vertex
+    VertexWelder welder = { this->vertices, attrib.vertices.size() / 3 };
+    int objectNumber    = 0;
     for (const auto& shape : shapes)
     {
         objectNumber++;
         for (const auto& index : shape.mesh.indices)
         {
+            // The color below only tells the first, second and remaining shapes apart
+            VertexWelder::SourceKey key = { index.vertex_index, index.normal_index, index.texcoord_index, std::min(objectNumber, 3) };
+
+            uint32_t welded = welder.find(key);
+            if (welded != VertexWelder::NOT_FOUND)
+            {
+                this->indices.push_back(welded);
+                continue;
+            }
+
             Vertex vertex = { };
             if (index.vertex_index >= 0)
             {
@@ -101,12 +295,7 @@ Model::Builder::loadModel(const std::string& filePath)
                     attrib.vertices[3 * index.vertex_index + 1],
                     attrib.vertices[3 * index.vertex_index + 2],
                 };
-                if (objectNumber == 1)
-                    vertex.color = { 1.0f, 0.0f, 0.0f };
-                else if (objectNumber == 2)
-                    vertex.color = { 0.0f, 1.0f, 0.0f };
-                else
-                    vertex.color = { 0.0f, 0.0f, 1.0f };
+                vertex.color = objectColor(objectNumber);
                 //vertex.color = {
                 //    attrib.colors[3 * index.vertex_index + 0],
                 //    attrib.colors[3 * index.vertex_index + 1],
@@ -131,112 +320,456 @@ Model::Builder::loadModel(const std::string& filePath)
                 };
             }
 
-            if (uniqueVertices.count(vertex) == 0)
+            this->indices.push_back(welder.weld(key, vertex));
+        }
+    }
+
+    this->bounds = { };
+    if (!this->vertices.empty())
+    {
+        this->bounds.min = this->bounds.max = this->vertices[0].position;
+        for (const auto& vertex : this->vertices)
+        {
+            this->bounds.min = glm::min(this->bounds.min, vertex.position);
+            this->bounds.max = glm::max(this->bounds.max, vertex.position);
+        }
+    }
+
+    this->lods = { { 0, static_cast<uint32_t>(this->indices.size()), 0.0f } };
+    if (this->generateLods)
+        this->buildLodChain();
+
+    if (this->optimizeVertexCache)
+    {
+        this->vertexCacheBefore = this->analyzeVertexCache();
+        this->reorderForVertexCache();
+        this->reorderForVertexFetch();
+        this->vertexCacheAfter  = this->analyzeVertexCache();
+    }
+}
+
+void
+Model::Builder::buildLodChain()
+{
+    if (this->lods.empty())
+        this->lods = { { 0, static_cast<uint32_t>(this->indices.size()), 0.0f } };
+
+    const Lod base       = this->lods[0];
+    const float maxError = this->lodErrorBudget * glm::length(this->bounds.max - this->bounds.min);
+
+    this->lods.resize(1);
+    this->indices.resize(static_cast<size_t>(base.firstIndex) + base.indexCount);
+
+    // One continuous collapse sequence, snapshotted each time the triangle count halves
+    MeshSimplifier simplifier = { this->vertices, this->indices.data() + base.firstIndex, base.indexCount };
+    while (this->lods.size() < MAX_LODS)
+    {
+        const uint32_t previous = this->lods.back().indexCount;
+        simplifier.simplify(previous / 6 * 3, maxError);
+
+        const uint32_t indexCount = static_cast<uint32_t>(simplifier.indices().size());
+        if (indexCount == 0 || indexCount > previous * (1.0f - LOD_MIN_REDUCTION))
+            break;
+
+        this->lods.push_back({ static_cast<uint32_t>(this->indices.size()), indexCount, simplifier.error() });
+        this->indices.insert(this->indices.end(), simplifier.indices().begin(), simplifier.indices().end());
+    }
+}
+
+glm::vec3
+Model::Builder::objectColor(int objectNumber)
+{
+    if (objectNumber == 1)
+        return { 1.0f, 0.0f, 0.0f };
+    else if (objectNumber == 2)
+        return { 0.0f, 1.0f, 0.0f };
+    else
+        return { 0.0f, 0.0f, 1.0f };
+}
+
+VertexCacheStats
+Model::Builder::analyzeVertexCache() const
+{
+    VertexCacheStats stats = { };
+
+    const uint32_t* indices = this->indices.data();
+    size_t indexCount       = this->indices.size();
+    if (!this->lods.empty())
+    {
+        indices    += this->lods[0].firstIndex;
+        indexCount  = this->lods[0].indexCount;
+    }
+
+    if (indexCount == 0)
+        return stats;
+
+    // A vertex is still cached if fewer than ANALYZE_CACHE_SIZE misses happened since it was loaded
+    std::vector<uint32_t> loadedAt = std::vector<uint32_t>(this->vertices.size(), 0);
+    std::vector<bool> referenced   = std::vector<bool>(this->vertices.size(), false);
+    uint32_t time                  = ANALYZE_CACHE_SIZE + 1;
+    uint32_t misses                = 0;
+    uint32_t uniqueVertices        = 0;
+
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        const uint32_t index = indices[i];
+        if (time - loadedAt[index] > ANALYZE_CACHE_SIZE)
+        {
+            loadedAt[index] = time++;
+            misses++;
+        }
+
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            uniqueVertices++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+
+    return stats;
+}
+
+// Forsyth's score of a vertex at cachePosition (-1 if not cached) with remaining unemitted triangles
+static float
+vertexCacheScore(int cachePosition, uint32_t remaining)
+{
+    if (remaining == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The last triangle's vertices are deliberately not favoured, so strips do not form
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (OPTIMIZE_CACHE_SIZE - 3), 1.5f);
+    }
+
+    // Boost vertices with few triangles left so they get finished off
+    return score + 2.0f / std::sqrt(static_cast<float>(remaining));
+}
+
+// Forsyth's linear-speed vertex cache optimization of one triangle list, in place
+static void
+optimizeTriangleOrder(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Triangles using each vertex; the first remaining[v] of a vertex's range are not emitted yet
+    std::vector<uint32_t> remaining     = std::vector<uint32_t>(vertexCount, 0);
+    std::vector<uint32_t> adjacencyBase = std::vector<uint32_t>(vertexCount + 1, 0);
+    for (size_t i = 0; i < indexCount; i++)
+        remaining[indices[i]]++;
+
+    for (size_t v = 0; v < vertexCount; v++)
+        adjacencyBase[v + 1] = adjacencyBase[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency = std::vector<uint32_t>(indexCount);
+    std::vector<uint32_t> filled    = std::vector<uint32_t>(vertexCount, 0);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            const uint32_t v                          = indices[3 * t + corner];
+            adjacency[adjacencyBase[v] + filled[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition   = std::vector<int>(vertexCount, -1);
+    std::vector<float> vertexScore   = std::vector<float>(vertexCount);
+    std::vector<float> triangleScore = std::vector<float>(triangleCount, 0.0f);
+    std::vector<bool> emitted        = std::vector<bool>(triangleCount, false);
+    std::vector<uint32_t> reordered  = { };
+    reordered.reserve(indexCount);
+
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        vertexScore[v] = vertexCacheScore(-1, remaining[v]);
+        for (uint32_t i = adjacencyBase[v]; i < adjacencyBase[v + 1]; i++)
+            triangleScore[adjacency[i]] += vertexScore[v];
+    }
+
+    // Room for the emitted triangle's vertices on top of the modelled cache
+    std::vector<uint32_t> cache    = { };
+    std::vector<uint32_t> newCache = { };
+    cache.reserve(OPTIMIZE_CACHE_SIZE + 3);
+    newCache.reserve(OPTIMIZE_CACHE_SIZE + 3);
+
+    size_t best       = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+    size_t scanCursor = 0;
+
+    while (best != SIZE_MAX)
+    {
+        emitted[best] = true;
+        newCache.clear();
+
+        for (size_t corner = 0; corner < 3; corner++)
+        {
+            const uint32_t v = indices[3 * best + corner];
+            reordered.push_back(v);
+            newCache.push_back(v);
+
+            // Move the triangle past the remaining ones in the vertex's adjacency range
+            const uint32_t first = adjacencyBase[v];
+            const uint32_t last  = first + --remaining[v];
+            for (uint32_t i = first; i <= last; i++)
+            {
+                if (adjacency[i] == best)
+                {
+                    std::swap(adjacency[i], adjacency[last]);
+                    break;
+                }
+            }
+        }
+
+        for (const auto v : cache)
+        {
+            if (std::find(newCache.begin(), newCache.begin() + 3, v) == newCache.begin() + 3)
+                newCache.push_back(v);
+        }
+
+        // Rescore everything that was or is cached, then pick the best triangle among its neighbours
+        for (size_t position = 0; position < newCache.size(); position++)
+        {
+            const uint32_t v  = newCache[position];
+            cachePosition[v]  = position < OPTIMIZE_CACHE_SIZE ? static_cast<int>(position) : -1;
+
+            const float score = vertexCacheScore(cachePosition[v], remaining[v]);
+            const float delta = score - vertexScore[v];
+            vertexScore[v]    = score;
+
+            for (uint32_t i = adjacencyBase[v]; i < adjacencyBase[v] + remaining[v]; i++)
+                triangleScore[adjacency[i]] += delta;
+        }
+
+        float bestScore = -1.0f;
+        best            = SIZE_MAX;
+
+        for (const auto v : newCache)
+        {
+            for (uint32_t i = adjacencyBase[v]; i < adjacencyBase[v] + remaining[v]; i++)
             {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
+                if (triangleScore[adjacency[i]] > bestScore)
+                {
+                    bestScore = triangleScore[adjacency[i]];
+                    best      = adjacency[i];
+                }
             }
+        }
+
+        if (newCache.size() > OPTIMIZE_CACHE_SIZE)
+            newCache.resize(OPTIMIZE_CACHE_SIZE);
+
+        std::swap(cache, newCache);
+
+        // Nothing cached has triangles left; continue with the next unemitted one in input order
+        if (best == SIZE_MAX)
+        {
+            while (scanCursor < triangleCount && emitted[scanCursor])
+                scanCursor++;
 
-            indices.push_back(uniqueVertices[vertex]);
+            if (scanCursor < triangleCount)
+                best = scanCursor;
         }
     }
+
+    std::copy(reordered.begin(), reordered.end(), indices);
 }
 
 void
-Model::createVertexBuffers(const std::vector<Vertex>& vertices)
+Model::Builder::reorderForVertexCache()
 {
-    this->vertexCount = static_cast<uint32_t>(vertices.size());
-    assert(this->vertexCount >= 3 && "Vertex Count Must be At Least 3");
+    if (this->lods.empty())
+    {
+        optimizeTriangleOrder(this->indices.data(), this->indices.size(), this->vertices.size());
+        return;
+    }
 
-    VkDeviceSize bufferSize            = sizeof(vertices[0]) * this->vertexCount;
-    VkBuffer stagingBuffer             = nullptr;
-    VkDeviceMemory stagingBufferMemory = nullptr;
+    for (const auto& lod : this->lods)
+        optimizeTriangleOrder(this->indices.data() + lod.firstIndex, lod.indexCount, this->vertices.size());
+}
 
-    this->device.createBuffer(bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer,
-        stagingBufferMemory);
+void
+Model::Builder::reorderForVertexFetch()
+{
+    // Renumber vertices in the order the index buffer first uses them
+    std::vector<uint32_t> remap   = std::vector<uint32_t>(this->vertices.size(), UINT32_MAX);
+    std::vector<Vertex> reordered = { };
+    reordered.reserve(this->vertices.size());
 
-    void* data = nullptr;
-    vkMapMemory(this->device.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(this->device.device(), stagingBufferMemory);
+    for (auto& index : this->indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(this->vertices[index]);
+        }
 
-    this->device.createBuffer(bufferSize,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        this->vertexBuffer,
-        this->vertexBufferMemory);
+        index = remap[index];
+    }
 
-    this->device.copyBuffer(stagingBuffer, this->vertexBuffer, bufferSize);
+    this->vertices = std::move(reordered);
+}
 
-    vkDestroyBuffer(this->device.device(), stagingBuffer, nullptr);
-    vkFreeMemory(this->device.device(), stagingBufferMemory, nullptr);
+Model::MeshData
+Model::Builder::meshData() const
+{
+    MeshData mesh    = { };
+    mesh.vertices    = this->vertices.data();
+    mesh.vertexCount = static_cast<uint32_t>(this->vertices.size());
+    mesh.indices     = this->indices.data();
+    mesh.indexCount  = static_cast<uint32_t>(this->indices.size());
+    mesh.lods        = this->lods.data();
+    mesh.lodCount    = static_cast<uint32_t>(this->lods.size());
+    mesh.bounds      = this->bounds;
+
+    return mesh;
 }
 
 void
-Model::createIndexBuffer(const std::vector<uint32_t>& indices)
+Model::uploadVertices(const Vertex* vertices)
 {
-    this->indexCount = static_cast<uint32_t>(indices.size());
-    hasIndexBuffer   = indexCount > 0;
-
-    if (!hasIndexBuffer)
+    if (this->vertexFormat == VertexFormat::Float)
+    {
+        this->uploadTicket = std::max(this->uploadTicket, this->device.geometry().uploadVertices(this->geometry, vertices));
         return;
+    }
 
-    VkDeviceSize bufferSize            = sizeof(indices[0]) * this->indexCount;
-    VkBuffer stagingBuffer             = nullptr;
-    VkDeviceMemory stagingBufferMemory = nullptr;
+    // Quantized straight into the staging ring, with no copy of the whole mesh in between
+    const Bounds& bounds = this->bounds;
+    const auto quantize  = [vertices, &bounds](void* staging, VkDeviceSize offset, VkDeviceSize size)
+    {
+        QuantizedVertex* packed = static_cast<QuantizedVertex*>(staging);
+        const Vertex* source    = vertices + offset / sizeof(QuantizedVertex);
+        const size_t count      = static_cast<size_t>(size / sizeof(QuantizedVertex));
 
-    this->device.createBuffer(bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer,
-        stagingBufferMemory);
+        for (size_t i = 0; i < count; i++)
+            packed[i] = QuantizedVertex::quantize(source[i], bounds);
+    };
+
+    this->uploadTicket = std::max(this->uploadTicket, this->device.geometry().uploadVertices(this->geometry, quantize));
+}
 
-    void* data = nullptr;
-    vkMapMemory(this->device.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
-    vkUnmapMemory(this->device.device(), stagingBufferMemory);
+void
+Model::uploadIndices(const uint32_t* indices)
+{
+    if (this->indexCount == 0)
+        return;
 
-    this->device.createBuffer(bufferSize,
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        this->indexBuffer,
-        this->indexBufferMemory);
+    this->uploadTicket = std::max(this->uploadTicket, this->device.geometry().uploadIndices(this->geometry, indices));
+}
 
-    this->device.copyBuffer(stagingBuffer, this->indexBuffer, bufferSize);
+uint64_t
+Model::LoadOptions::hash(uint64_t seed) const
+{
+    uint64_t hash = hashBytes(&this->optimizeVertexCache, sizeof(this->optimizeVertexCache), seed);
+    hash          = hashBytes(&this->generateLods, sizeof(this->generateLods), hash);
+    hash          = hashBytes(&this->lodErrorBudget, sizeof(this->lodErrorBudget), hash);
 
-    vkDestroyBuffer(this->device.device(), stagingBuffer, nullptr);
-    vkFreeMemory(this->device.device(), stagingBufferMemory, nullptr);
+    return hash;
 }
 
 std::unique_ptr<Model>
-Model::createModelFromFile(Device& device, const std::string& filePath)
+Model::createModelFromFile(Device& device, const std::string& filePath, StartupStats* stats)
 {
-    Builder builder = { };
-    builder.loadModel(filePath);
+    return createModelFromFile(device, filePath, stats, LoadOptions());
+}
 
-    return std::make_unique<Model>(device, builder);
+std::unique_ptr<Model>
+Model::createModelFromFile(Device& device, const std::string& filePath, StartupStats* stats, const LoadOptions& options)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    MeshCache cache              = { };
+    const uint64_t key           = options.hash(cache.hashSource(filePath));
+    std::unique_ptr<Model> model = nullptr;
+    StartupStats::ModelLoad load = { };
+    load.filePath                = filePath;
+
+    // Warm path: the cooked file is mapped and copied straight into the staging buffers
+    if (auto entry = cache.load(key))
+    {
+        model     = std::make_unique<Model>(device, entry->mesh(), options.vertexFormat);
+        load.warm = true;
+    }
+    else
+    {
+        Builder builder             = { };
+        builder.optimizeVertexCache = options.optimizeVertexCache;
+        builder.generateLods        = options.generateLods;
+        builder.lodErrorBudget      = options.lodErrorBudget;
+        builder.loaderMode          = options.loaderMode;
+        builder.loadModel(filePath);
+        cache.store(key, builder);
+
+        model            = std::make_unique<Model>(device, builder, options.vertexFormat);
+        load.optimized   = builder.optimizeVertexCache;
+        load.cacheBefore = builder.vertexCacheBefore;
+        load.cacheAfter  = builder.vertexCacheAfter;
+    }
+
+    if (stats)
+    {
+        for (const auto& lod : model->lods)
+            load.lodTriangles.push_back(lod.indexCount / 3);
+
+        load.lodError     = model->lods.back().error;
+        load.quantized    = model->vertexFormat == VertexFormat::Quantized;
+        load.vertexBytes  = model->getVertexBufferSize();
+
+        const auto end    = std::chrono::high_resolution_clock::now();
+        load.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        stats->modelLoads.push_back(load);
+    }
+
+    return model;
 }
 
-void
-Model::bind(const VkCommandBuffer& commandBuffer)
+VkDeviceSize
+Model::getVertexStride() const
+{
+    return this->vertexFormat == VertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+}
+
+VkDeviceSize
+Model::getVertexBufferSize() const
+{
+    return this->getVertexStride() * this->vertexCount;
+}
+
+uint32_t
+Model::selectLod(float maxError) const
 {
-    const VkBuffer buffers[]    = { this->vertexBuffer };
-    const VkDeviceSize offset[] = { 0 };
+    // Errors only grow along the chain
+    uint32_t lod = 0;
+    while (lod + 1 < this->lods.size() && this->lods[lod + 1].error <= maxError)
+        lod++;
 
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offset);
+    return lod;
+}
 
-    if (this->hasIndexBuffer)
-        vkCmdBindIndexBuffer(commandBuffer, this->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+void
+Model::bind(const VkCommandBuffer& commandBuffer)
+{
+    this->device.geometry().bind(commandBuffer, this->geometry);
 }
 
 void
-Model::draw(const VkCommandBuffer& commandBuffer)
+Model::draw(const VkCommandBuffer& commandBuffer, uint32_t lod, uint32_t instanceCount, uint32_t firstInstance)
 {
-    if (this->hasIndexBuffer)
-        vkCmdDrawIndexed(commandBuffer, this->indexCount, 1, 0, 0, 0);
+    assert(lod < this->lods.size() && "LOD Out of Range");
+
+    // Ranges move when the pool compacts, so they are looked up on every draw
+    const GeometryPool::Range& range = this->device.geometry().getRange(this->geometry);
+
+    if (this->indexCount > 0)
+        vkCmdDrawIndexed(commandBuffer, this->lods[lod].indexCount, instanceCount, range.firstIndex + this->lods[lod].firstIndex, static_cast<int32_t>(range.vertexOffset), firstInstance);
     else
-        vkCmdDraw(commandBuffer, this->vertexCount, 1, 0, 0);
+        vkCmdDraw(commandBuffer, this->vertexCount, instanceCount, range.vertexOffset, firstInstance);
 }
\ No newline at end of file
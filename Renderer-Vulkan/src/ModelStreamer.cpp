@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <ModelStreamer.hpp>
+
+// Raw OBJ index (1-based, negative is relative, 0 is absent) to a 0-based one, or -1
+static int
+resolveIndex(int index, size_t count, const char* kind)
+{
+    if (index == 0)
+        return -1;
+
+    const int resolved = index > 0 ? index - 1 : static_cast<int>(count) + index;
+
+    if (resolved < 0 || static_cast<size_t>(resolved) >= count)
+        throw std::runtime_error(std::string("Invalid ") + kind + " Index in Face: " + std::to_string(index));
+
+    return resolved;
+}
+
+ModelStreamer::ChunkedUpload::ChunkedUpload(Device& device, VkBufferUsageFlags usage, VkDeviceSize chunkSize) :
+    device(device),
+    usage(usage),
+    chunkSize(chunkSize),
+    staging(static_cast<size_t>(chunkSize))
+{ }
+
+ModelStreamer::ChunkedUpload::~ChunkedUpload()
+{
+    if (this->buffer != nullptr)
+    {
+        this->device.uploads().wait(this->ticket);
+        this->device.destroyBuffer(this->buffer, this->bufferMemory);
+    }
+}
+
+void
+ModelStreamer::ChunkedUpload::append(const void* data, VkDeviceSize size)
+{
+    assert(size <= this->chunkSize && "Append Must Fit in One Chunk");
+
+    if (this->staged + size > this->chunkSize)
+        this->flush();
+
+    memcpy(this->staging.data() + this->staged, data, static_cast<size_t>(size));
+    this->staged += size;
+}
+
+void
+ModelStreamer::ChunkedUpload::flush()
+{
+    if (this->staged == 0)
+        return;
+
+    this->reserve(this->uploaded + this->staged);
+
+    // The chunk is copied into the staging ring, so it is free again right after. The
+    // buffer stays with the transfer queue, it is only read by copyTo
+    this->ticket    = this->device.uploads().upload(this->buffer, this->uploaded, this->staging.data(), this->staged, false);
+    this->uploaded += this->staged;
+    this->staged    = 0;
+}
+
+void
+ModelStreamer::ChunkedUpload::reserve(VkDeviceSize size)
+{
+    if (size <= this->capacity)
+        return;
+
+    this->resize(std::max({ size, this->capacity * 2, this->chunkSize }));
+}
+
+void
+ModelStreamer::ChunkedUpload::resize(VkDeviceSize size)
+{
+    VkBuffer buffer               = nullptr;
+    MemoryAllocation bufferMemory = { };
+
+    this->device.createBuffer(size,
+        this->usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        buffer,
+        bufferMemory);
+
+    if (this->buffer != nullptr)
+    {
+        // The old buffer can only go once the copy out of it is done
+        if (this->uploaded > 0)
+            this->ticket = this->device.uploads().copy(this->buffer, buffer, this->uploaded, 0, 0, false);
+
+        this->device.uploads().wait(this->ticket);
+        this->device.destroyBuffer(this->buffer, this->bufferMemory);
+    }
+
+    this->buffer       = buffer;
+    this->bufferMemory = bufferMemory;
+    this->capacity     = size;
+}
+
+UploadTicket
+ModelStreamer::ChunkedUpload::copyTo(VkBuffer dst, VkDeviceSize dstOffset)
+{
+    this->flush();
+
+    // The pool buffers are shared with the graphics family, so nothing is handed over
+    if (this->uploaded > 0)
+        this->ticket = this->device.uploads().copy(this->buffer, dst, this->uploaded, 0, dstOffset, false);
+
+    return this->ticket;
+}
+
+void
+ModelStreamer::vertexCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z, tinyobj::real_t)
+{
+    auto* streamer = static_cast<ModelStreamer*>(userData);
+    streamer->positions.insert(streamer->positions.end(), { x, y, z });
+}
+
+void
+ModelStreamer::normalCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t z)
+{
+    auto* streamer = static_cast<ModelStreamer*>(userData);
+    streamer->normals.insert(streamer->normals.end(), { x, y, z });
+}
+
+void
+ModelStreamer::texcoordCallback(void* userData, tinyobj::real_t x, tinyobj::real_t y, tinyobj::real_t)
+{
+    auto* streamer = static_cast<ModelStreamer*>(userData);
+    streamer->texcoords.insert(streamer->texcoords.end(), { x, y });
+}
+
+void
+ModelStreamer::indexCallback(void* userData, tinyobj::index_t* indices, int indexCount)
+{
+    auto* streamer = static_cast<ModelStreamer*>(userData);
+    if (indexCount < 3)
+        return;
+
+    streamer->objectHasFaces = true;
+
+    // Fan the polygon around its first corner
+    const uint32_t first = streamer->emitCorner(indices[0]);
+    uint32_t previous    = streamer->emitCorner(indices[1]);
+    for (int i = 2; i < indexCount; i++)
+    {
+        const uint32_t current    = streamer->emitCorner(indices[i]);
+        const uint32_t triangle[] = { first, previous, current };
+
+        streamer->indexUpload->append(triangle, sizeof(triangle));
+        streamer->indexCount += 3;
+        previous              = current;
+    }
+}
+
+void
+ModelStreamer::groupCallback(void* userData, const char**, int)
+{
+    static_cast<ModelStreamer*>(userData)->nextObject();
+}
+
+void
+ModelStreamer::objectCallback(void* userData, const char*)
+{
+    static_cast<ModelStreamer*>(userData)->nextObject();
+}
+
+void
+ModelStreamer::nextObject()
+{
+    // Like tinyobj, a 'g' or 'o' line only starts a new shape once the current one has faces
+    if (this->objectHasFaces)
+    {
+        this->objectNumber++;
+        this->objectHasFaces = false;
+    }
+}
+
+uint32_t
+ModelStreamer::emitCorner(const tinyobj::index_t& index)
+{
+    const VertexWelder::SourceKey key = {
+        resolveIndex(index.vertex_index,   this->positions.size() / 3, "Vertex"),
+        resolveIndex(index.normal_index,   this->normals.size()   / 3, "Normal"),
+        resolveIndex(index.texcoord_index, this->texcoords.size() / 2, "Texcoord"),
+        std::min(this->objectNumber, 3),
+    };
+
+    uint32_t welded = this->welder->find(key);
+    if (welded != VertexWelder::NOT_FOUND)
+        return welded;
+
+    Model::Vertex vertex = { };
+    if (key.vertexIndex >= 0)
+    {
+        vertex.position = {
+            this->positions[3 * key.vertexIndex + 0],
+            this->positions[3 * key.vertexIndex + 1],
+            this->positions[3 * key.vertexIndex + 2],
+        };
+        vertex.color = Model::Builder::objectColor(this->objectNumber);
+    }
+
+    if (key.normalIndex >= 0)
+    {
+        vertex.normal = {
+            this->normals[3 * key.normalIndex + 0],
+            this->normals[3 * key.normalIndex + 1],
+            this->normals[3 * key.normalIndex + 2],
+        };
+    }
+
+    if (key.texcoordIndex >= 0)
+    {
+        vertex.uv = {
+            this->texcoords[2 * key.texcoordIndex + 0],
+            this->texcoords[2 * key.texcoordIndex + 1],
+        };
+    }
+
+    if (this->vertexCount == 0)
+        this->bounds.min = this->bounds.max = vertex.position;
+
+    this->bounds.min = glm::min(this->bounds.min, vertex.position);
+    this->bounds.max = glm::max(this->bounds.max, vertex.position);
+
+    welded = this->vertexCount++;
+    this->vertexUpload->append(&vertex, sizeof(vertex));
+    this->welder->insert(key, welded);
+
+    return welded;
+}
+
+std::unique_ptr<Model>
+ModelStreamer::load(const std::string& filePath, StartupStats* stats)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    std::ifstream file(filePath);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to Open File: " + filePath);
+
+    // Half the budget each, in whole vertices and whole triangles
+    const VkDeviceSize vertexChunk = std::max<VkDeviceSize>(1, this->hostBudget / 2 / sizeof(Model::Vertex)) * sizeof(Model::Vertex);
+    const VkDeviceSize indexChunk  = std::max<VkDeviceSize>(1, this->hostBudget / 2 / (3 * sizeof(uint32_t))) * 3 * sizeof(uint32_t);
+
+    this->positions.clear();
+    this->normals.clear();
+    this->texcoords.clear();
+    this->welder         = std::make_unique<VertexWelder>(static_cast<size_t>(vertexChunk / sizeof(Model::Vertex)));
+    this->vertexUpload   = std::make_unique<ChunkedUpload>(this->device, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexChunk);
+    this->indexUpload    = std::make_unique<ChunkedUpload>(this->device, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexChunk);
+    this->vertexCount    = 0;
+    this->indexCount     = 0;
+    this->objectNumber   = 1;
+    this->objectHasFaces = false;
+    this->bounds         = { };
+
+    tinyobj::callback_t callback = { };
+    callback.vertex_cb           = vertexCallback;
+    callback.normal_cb           = normalCallback;
+    callback.texcoord_cb         = texcoordCallback;
+    callback.index_cb            = indexCallback;
+    callback.group_cb            = groupCallback;
+    callback.object_cb           = objectCallback;
+
+    std::string warn, err = "";
+    if (!tinyobj::LoadObjWithCallback(file, callback, this, nullptr, &warn, &err))
+        throw std::runtime_error(warn + err);
+
+    if (this->vertexCount < 3)
+        throw std::runtime_error("Vertex Count Must be At Least 3: " + filePath);
+
+    std::unique_ptr<Model> model = std::unique_ptr<Model>(new Model(this->device, this->bounds));
+    model->vertexCount           = this->vertexCount;
+    model->indexCount            = this->indexCount;
+    model->lods                  = { { 0, this->indexCount, 0.0f } };
+
+    // Every position in the file, so at worst a little loose where some go unused
+    float maxDistance2 = 0.0f;
+    for (size_t i = 0; i + 2 < this->positions.size(); i += 3)
+    {
+        const glm::vec3 position = { this->positions[i], this->positions[i + 1], this->positions[i + 2] };
+        const glm::vec3 offset   = position - model->sphere.center;
+        maxDistance2             = std::max(maxDistance2, glm::dot(offset, offset));
+    }
+
+    model->sphere.radius = std::min(model->sphere.radius, std::sqrt(maxDistance2));
+
+    GeometryPool& geometry = this->device.geometry();
+    model->geometry        = geometry.allocate(sizeof(Model::Vertex), this->vertexCount, this->indexCount);
+
+    const GeometryPool::Range& range = geometry.getRange(model->geometry);
+    const UploadTicket vertexTicket  = this->vertexUpload->copyTo(geometry.getVertexBuffer(model->geometry), range.vertexOffset * sizeof(Model::Vertex));
+    const UploadTicket indexTicket   = this->indexUpload->copyTo(geometry.getIndexBuffer(), range.firstIndex * sizeof(uint32_t));
+    model->uploadTicket              = std::max(vertexTicket, indexTicket);
+
+    // Nothing from this load outlives it; the chunk buffers go once copied into the pool
+    this->positions    = { };
+    this->normals      = { };
+    this->texcoords    = { };
+    this->welder       = nullptr;
+    this->vertexUpload = nullptr;
+    this->indexUpload  = nullptr;
+
+    if (stats)
+    {
+        StartupStats::ModelLoad load = { };
+        load.filePath                = filePath;
+        load.streamed                = true;
+        load.lodTriangles            = { this->indexCount / 3 };
+        load.vertexBytes             = model->getVertexBufferSize();
+
+        const auto end    = std::chrono::high_resolution_clock::now();
+        load.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        stats->modelLoads.push_back(load);
+    }
+
+    return model;
+}
\ No newline at end of file
@@ -0,0 +1,4 @@
+// tinyobjloader is header only; its implementation (and the platform headers
+// LoadObjMapped() needs for memory-mapping) is compiled once, here.
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <Objects/ObjectLoader.h>
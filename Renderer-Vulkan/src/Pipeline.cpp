@@ -1,139 +1,77 @@
-#include <fstream>
-#include <iostream>
-#include <cassert>
+#include <algorithm>
+#include <cstring>
 
 #include <Pipeline.hpp>
 #include <Device.hpp>
 #include <Model.hpp>
 
-Pipeline::Pipeline(Device& device, const std::string_view& vert_path, const std::string_view& frag_path, const PipelineConfigInfo& config) :
-    device(device)
+void
+SpecializationConstants::setBits(uint32_t id, const void* value)
 {
-    this->createGraphicsPipeline(vert_path, frag_path, config);
+    auto found       = std::lower_bound(this->entries.begin(), this->entries.end(), id,
+        [](const VkSpecializationMapEntry& entry, uint32_t constantID) { return entry.constantID < constantID; });
+    const auto index = found - this->entries.begin();
+
+    if (found == this->entries.end() || found->constantID != id)
+    {
+        this->entries.insert(found, { id, 0, sizeof(uint32_t) });
+        this->values.insert(this->values.begin() + index, 0);
+
+        // Each value sits at its entry's index
+        for (size_t i = 0; i < this->entries.size(); i++)
+            this->entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+    }
+
+    memcpy(&this->values[index], value, sizeof(uint32_t));
 }
 
-Pipeline::~Pipeline()
+void
+SpecializationConstants::set(uint32_t id, bool value)
 {
-    vkDestroyShaderModule(this->device.device(), this->vertShaderModule, nullptr);
-    vkDestroyShaderModule(this->device.device(), this->fragShaderModule, nullptr);
-    vkDestroyPipeline(this->device.device(), this->graphicsPipeline, nullptr);
+    const VkBool32 boolean = value ? VK_TRUE : VK_FALSE;
+    this->setBits(id, &boolean);
 }
 
-const std::vector<char>
-Pipeline::readFile(const std::string& file_path)
+void
+SpecializationConstants::set(uint32_t id, int32_t value)
 {
-    std::ifstream file(file_path, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open())
-        throw std::runtime_error("Failed to Open File: " + file_path);
-
-    size_t fileSize = static_cast<size_t>(file.tellg());
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
+    this->setBits(id, &value);
+}
 
-    return buffer;
+void
+SpecializationConstants::set(uint32_t id, uint32_t value)
+{
+    this->setBits(id, &value);
 }
 
-void Pipeline::createGraphicsPipeline(const std::string_view& vertPath, const std::string_view& fragPath, const PipelineConfigInfo& config)
+void
+SpecializationConstants::set(uint32_t id, float value)
 {
-    auto vertCode = this->readFile(vertPath.data());
-    auto fragCode = this->readFile(fragPath.data());
-
-    assert(config.pipelineLayout != VK_NULL_HANDLE && "Cannot Create Graphics Pipeline, no pipeline_layout Provided in 'config'");
-    assert(config.renderPass != VK_NULL_HANDLE && "Cannot Create Graphics Pipeline, no render_pass Provided in 'config'");
-
-    this->createShaderModule(vertCode, &vertShaderModule);
-    this->createShaderModule(fragCode, &fragShaderModule);
-
-    VkPipelineShaderStageCreateInfo shaderStage[2] = { };
-
-    shaderStage[0].sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    shaderStage[0].stage                           = VK_SHADER_STAGE_VERTEX_BIT;
-    shaderStage[0].module                          = vertShaderModule;
-    shaderStage[0].pName                           = "main";
-    shaderStage[0].flags                           = 0;
-    shaderStage[0].pNext                           = nullptr;
-    shaderStage[0].pSpecializationInfo             = nullptr;
-
-    shaderStage[1].sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    shaderStage[1].stage                           = VK_SHADER_STAGE_FRAGMENT_BIT;
-    shaderStage[1].module                          = fragShaderModule;
-    shaderStage[1].pName                           = "main";
-    shaderStage[1].flags                           = 0;
-    shaderStage[1].pNext                           = nullptr;
-    shaderStage[1].pSpecializationInfo             = nullptr;
-
-    auto bindingDescriptions                       = Model::Vertex::getBindingDescriptions();
-    auto attributeDescriptions                     = Model::Vertex::getAttributeDescriptions();
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo     = VkPipelineVertexInputStateCreateInfo();
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexAttributeDescriptionCount          = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.vertexBindingDescriptionCount            = static_cast<uint32_t>(bindingDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions             = attributeDescriptions.data();
-    vertexInputInfo.pVertexBindingDescriptions               = bindingDescriptions.data();
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment = { };
-    colorBlendAttachment.colorWriteMask                      =
-        VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
-        VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable                         = VK_FALSE;
-    colorBlendAttachment.srcColorBlendFactor                 = VK_BLEND_FACTOR_ONE;   // Optional
-    colorBlendAttachment.dstColorBlendFactor                 = VK_BLEND_FACTOR_ZERO;  // Optional
-    colorBlendAttachment.colorBlendOp                        = VK_BLEND_OP_ADD;       // Optional
-    colorBlendAttachment.srcAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE;   // Optional
-    colorBlendAttachment.dstAlphaBlendFactor                 = VK_BLEND_FACTOR_ZERO;  // Optional
-    colorBlendAttachment.alphaBlendOp                        = VK_BLEND_OP_ADD;       // Optional
-
-    VkPipelineColorBlendStateCreateInfo colorBlendInfo       = { };
-    colorBlendInfo.sType                                     = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlendInfo.logicOpEnable                             = VK_FALSE;
-    colorBlendInfo.logicOp                                   = VK_LOGIC_OP_COPY;  // Optional
-    colorBlendInfo.attachmentCount                           = 1;
-    colorBlendInfo.pAttachments                              = &colorBlendAttachment;
-    colorBlendInfo.blendConstants[0]                         = 0.0f;              // Optional
-    colorBlendInfo.blendConstants[1]                         = 0.0f;              // Optional
-    colorBlendInfo.blendConstants[2]                         = 0.0f;              // Optional
-    colorBlendInfo.blendConstants[3]                         = 0.0f;              // Optional
-
-    VkGraphicsPipelineCreateInfo graphicsPipelineInfo        = VkGraphicsPipelineCreateInfo();
-    graphicsPipelineInfo.sType                               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    graphicsPipelineInfo.stageCount                          = 2;
-    graphicsPipelineInfo.pStages                             = shaderStage;
-    graphicsPipelineInfo.pVertexInputState                   = &vertexInputInfo;
-    graphicsPipelineInfo.pInputAssemblyState                 = &config.inputAssemblyInput;
-    graphicsPipelineInfo.pViewportState                      = &config.viewportInfo;
-    graphicsPipelineInfo.pRasterizationState                 = &config.rasterizationInfo;
-    graphicsPipelineInfo.pMultisampleState                   = &config.multisampleInfo;
-    graphicsPipelineInfo.pColorBlendState                    = &colorBlendInfo;
-    graphicsPipelineInfo.pDepthStencilState                  = &config.depthStencilInfo;
-
-    graphicsPipelineInfo.pDynamicState                       = &config.dynamicStateInfo;
-    graphicsPipelineInfo.layout                              = config.pipelineLayout;
-    graphicsPipelineInfo.renderPass                          = config.renderPass;
-    graphicsPipelineInfo.subpass                             = config.subpass;
-
-    graphicsPipelineInfo.basePipelineIndex                   = -1;
-    graphicsPipelineInfo.basePipelineHandle                  = VK_NULL_HANDLE;
-
-    if (vkCreateGraphicsPipelines(this->device.device(), VK_NULL_HANDLE, 1, &graphicsPipelineInfo, nullptr, &this->graphicsPipeline) != VK_SUCCESS)
-        throw std::runtime_error("Failed to Create Graphics Pipeline");
+    this->setBits(id, &value);
 }
 
-void Pipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule)
+VkSpecializationInfo
+SpecializationConstants::info() const
 {
-    VkShaderModuleCreateInfo createInfo = VkShaderModuleCreateInfo();
-    createInfo.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize                 = code.size();
-    createInfo.pCode                    = reinterpret_cast<const uint32_t*>(code.data());
+    VkSpecializationInfo info = { };
+    info.mapEntryCount        = static_cast<uint32_t>(this->entries.size());
+    info.pMapEntries          = this->entries.data();
+    info.dataSize             = this->values.size() * sizeof(uint32_t);
+    info.pData                = this->values.data();
 
-    if (vkCreateShaderModule(this->device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS)
-        throw std::runtime_error("Failed to Create Shader Module");
+    return info;
 }
 
+Pipeline::Pipeline(Device& device, const std::string_view& vert_path, const std::string_view& frag_path, const PipelineConfigInfo& config) :
+    pipeline(device.pipelines().graphics(std::string(vert_path), std::string(frag_path), config)),
+    bindPoint(VK_PIPELINE_BIND_POINT_GRAPHICS)
+{ }
+
+Pipeline::Pipeline(Device& device, const std::string_view& compPath, VkPipelineLayout pipelineLayout) :
+    pipeline(device.pipelines().compute(std::string(compPath), pipelineLayout)),
+    bindPoint(VK_PIPELINE_BIND_POINT_COMPUTE)
+{ }
+
 void Pipeline::defaultPipelineConfig(PipelineConfigInfo& config)
 {
     config.inputAssemblyInput.sType                   = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -182,9 +120,13 @@ void Pipeline::defaultPipelineConfig(PipelineConfigInfo& config)
     config.dynamicStateInfo.pDynamicStates            = config.dynamicStateEnables.data();
     config.dynamicStateInfo.dynamicStateCount         = static_cast<uint32_t>(config.dynamicStateEnables.size());
     config.dynamicStateInfo.flags                     = 0;
+
+    config.bindingDescriptions                        = Model::Vertex::getBindingDescriptions();
+    config.attributeDescriptions                      = Model::Vertex::getAttributeDescriptions();
 }
 
 void Pipeline::bind(const VkCommandBuffer& command_buffer)
 {
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->graphicsPipeline);
+    // Rethrows what failed the compile; shared_future::get is safe from recording workers
+    vkCmdBindPipeline(command_buffer, this->bindPoint, this->pipeline.get());
 }
\ No newline at end of file
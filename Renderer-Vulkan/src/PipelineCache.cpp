@@ -0,0 +1,117 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <PipelineCache.hpp>
+
+PipelineCache::PipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties, const std::string& filePath) :
+    device(device),
+    filePath(filePath)
+{
+    std::vector<char> data = { };
+
+    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    if (file.is_open())
+    {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+        if (!file || !isCompatible(data, properties))
+        {
+            std::cerr << "Pipeline Cache File is Stale or Corrupt: " << filePath << std::endl;
+            data.clear();
+        }
+    }
+
+    this->warm = !data.empty();
+
+    VkPipelineCacheCreateInfo cacheInfo = { };
+    cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize           = data.size();
+    cacheInfo.pInitialData              = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(this->device, &cacheInfo, nullptr, &this->cache) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Pipeline Cache!");
+}
+
+PipelineCache::~PipelineCache()
+{
+    this->save();
+    vkDestroyPipelineCache(this->device, this->cache, nullptr);
+}
+
+bool
+PipelineCache::isCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties)
+{
+    VkPipelineCacheHeaderVersionOne header = { };
+    if (data.size() < sizeof(header))
+        return false;
+
+    memcpy(&header, data.data(), sizeof(header));
+
+    // Another driver or GPU would reject the data at best
+    return header.headerSize    >= sizeof(header)                         &&
+           header.headerSize    <= data.size()                            &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE   &&
+           header.vendorID      == properties.vendorID                    &&
+           header.deviceID      == properties.deviceID                    &&
+           memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool
+PipelineCache::save() const
+{
+    const std::string tempPath = this->filePath + ".tmp";
+
+    try
+    {
+        size_t size = 0;
+        if (vkGetPipelineCacheData(this->device, this->cache, &size, nullptr) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Get Pipeline Cache Data!");
+
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(this->device, this->cache, &size, data.data()) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Get Pipeline Cache Data!");
+
+        const std::filesystem::path directory = std::filesystem::path(this->filePath).parent_path();
+        if (!directory.empty())
+            std::filesystem::create_directories(directory);
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(size));
+
+            if (!file)
+                throw std::runtime_error("Failed to Write Pipeline Cache File: " + tempPath);
+        }
+
+        // Readers only ever see a complete file
+        std::filesystem::rename(tempPath, this->filePath);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::error_code ignored = { };
+        std::filesystem::remove(tempPath, ignored);
+        return false;
+    }
+
+    return true;
+}
+
+void
+PipelineCache::record(const std::string& shaderPath, double milliseconds)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->creations.push_back({ shaderPath, this->warm, milliseconds });
+}
+
+std::vector<StartupStats::PipelineCreation>
+PipelineCache::getCreations() const
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->creations;
+}
\ No newline at end of file
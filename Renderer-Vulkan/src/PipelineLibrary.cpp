@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <Pipeline.hpp>
+#include <PipelineLibrary.hpp>
+#include <Utilities.hpp>
+
+// Appends the bytes of a value without padding, so equal values give equal keys
+template <typename T>
+static void
+append(std::string& key, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T>, "Value Must Have No Padding");
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static void
+append(std::string& key, const T* values, uint32_t count)
+{
+    append(key, count);
+    for (uint32_t i = 0; i < count; i++)
+        append(key, values[i]);
+}
+
+static void
+append(std::string& key, float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    append(key, bits);
+}
+
+// Waits for a compile still running, as it writes into the pipeline
+static void
+destroyPipeline(VkDevice device, const PipelineLibrary::Future& future)
+{
+    try
+    {
+        vkDestroyPipeline(device, future.get(), nullptr);
+    }
+    catch (const std::exception&)
+    {
+        // Already thrown to whoever asked for it
+    }
+}
+
+size_t
+PipelineLibrary::KeyHash::operator()(const std::string& key) const
+{
+    return static_cast<size_t>(hashBytes(key.data(), key.size()));
+}
+
+PipelineLibrary::PipelineLibrary(VkDevice device, PipelineCache& cache, uint32_t threadCount) :
+    device(device),
+    cache(cache),
+    workers((threadCount > 0 ? threadCount : std::max(std::thread::hardware_concurrency(), 1u)) + 1)
+{ }
+
+PipelineLibrary::~PipelineLibrary()
+{
+    for (auto& [key, entry] : this->pipelines)
+        destroyPipeline(this->device, entry.future);
+
+    for (auto& [hash, shaderModule] : this->shaderModules)
+        vkDestroyShaderModule(this->device, shaderModule, nullptr);
+}
+
+void
+PipelineLibrary::wait()
+{
+    std::vector<Future> futures = { };
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (const auto& [key, entry] : this->pipelines)
+            futures.push_back(entry.future);
+    }
+
+    for (const auto& future : futures)
+        future.get();
+}
+
+std::vector<char>
+PipelineLibrary::readFile(const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("Failed to Open File: " + filePath);
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    std::vector<char> buffer(fileSize);
+
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+
+    return buffer;
+}
+
+VkShaderModule
+PipelineLibrary::shaderModule(const std::string& filePath, uint64_t& contentHash)
+{
+    const std::vector<char> code = readFile(filePath);
+    contentHash                  = hashBytes(code.data(), code.size());
+
+    auto found = this->shaderModules.find(contentHash);
+    if (found != this->shaderModules.end())
+        return found->second;
+
+    VkShaderModuleCreateInfo createInfo = VkShaderModuleCreateInfo();
+    createInfo.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize                 = code.size();
+    createInfo.pCode                    = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule = nullptr;
+    if (vkCreateShaderModule(this->device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Shader Module");
+
+    this->shaderModules.emplace(contentHash, shaderModule);
+    return shaderModule;
+}
+
+void
+PipelineLibrary::addRenderPass(VkRenderPass renderPass, const VkRenderPassCreateInfo& createInfo)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->renderPasses[renderPass] = renderPassKey(createInfo);
+}
+
+void
+PipelineLibrary::removeRenderPass(VkRenderPass renderPass)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->renderPasses.erase(renderPass);
+}
+
+void
+PipelineLibrary::releaseLayout(VkPipelineLayout pipelineLayout)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    for (auto entry = this->pipelines.begin(); entry != this->pipelines.end();)
+    {
+        if (entry->second.pipelineLayout != pipelineLayout)
+        {
+            ++entry;
+            continue;
+        }
+
+        destroyPipeline(this->device, entry->second.future);
+        entry = this->pipelines.erase(entry);
+    }
+}
+
+std::string
+PipelineLibrary::renderPassKey(const VkRenderPassCreateInfo& createInfo)
+{
+    // Everything but load and store ops and layouts, which compatible passes may differ in.
+    // Attachments are referenced by index, stricter than the format and samples the
+    // specification compares, so an equal key always means compatible
+    std::string key = { };
+    append(key, createInfo.flags);
+
+    append(key, createInfo.attachmentCount);
+    for (uint32_t i = 0; i < createInfo.attachmentCount; i++)
+    {
+        append(key, createInfo.pAttachments[i].flags);
+        append(key, createInfo.pAttachments[i].format);
+        append(key, createInfo.pAttachments[i].samples);
+    }
+
+    const auto appendReferences = [&key](const VkAttachmentReference* references, uint32_t count)
+    {
+        append(key, count);
+        for (uint32_t i = 0; i < count; i++)
+            append(key, references[i].attachment);
+    };
+
+    append(key, createInfo.subpassCount);
+    for (uint32_t i = 0; i < createInfo.subpassCount; i++)
+    {
+        const VkSubpassDescription& subpass = createInfo.pSubpasses[i];
+        append(key, subpass.flags);
+        append(key, subpass.pipelineBindPoint);
+        appendReferences(subpass.pInputAttachments, subpass.inputAttachmentCount);
+        appendReferences(subpass.pColorAttachments, subpass.colorAttachmentCount);
+        appendReferences(subpass.pResolveAttachments, subpass.pResolveAttachments != nullptr ? subpass.colorAttachmentCount : 0);
+        appendReferences(subpass.pDepthStencilAttachment, subpass.pDepthStencilAttachment != nullptr ? 1 : 0);
+        append(key, subpass.pPreserveAttachments, subpass.preserveAttachmentCount);
+    }
+
+    append(key, createInfo.pDependencies, createInfo.dependencyCount);
+
+    return key;
+}
+
+std::string
+PipelineLibrary::graphicsKey(uint64_t vertHash, uint64_t fragHash, const std::string& renderPassKey, const PipelineConfigInfo& config)
+{
+    std::string key = { };
+    append(key, vertHash);
+    append(key, fragHash);
+
+    append(key, config.bindingDescriptions.data(), static_cast<uint32_t>(config.bindingDescriptions.size()));
+    append(key, config.attributeDescriptions.data(), static_cast<uint32_t>(config.attributeDescriptions.size()));
+
+    // Viewports and scissors are dynamic; only their counts are baked in
+    append(key, config.viewportInfo.viewportCount);
+    append(key, config.viewportInfo.scissorCount);
+
+    append(key, config.inputAssemblyInput.topology);
+    append(key, config.inputAssemblyInput.primitiveRestartEnable);
+
+    const VkPipelineRasterizationStateCreateInfo& rasterization = config.rasterizationInfo;
+    append(key, rasterization.depthClampEnable);
+    append(key, rasterization.rasterizerDiscardEnable);
+    append(key, rasterization.polygonMode);
+    append(key, rasterization.cullMode);
+    append(key, rasterization.frontFace);
+    append(key, rasterization.depthBiasEnable);
+    append(key, rasterization.depthBiasConstantFactor);
+    append(key, rasterization.depthBiasClamp);
+    append(key, rasterization.depthBiasSlopeFactor);
+    append(key, rasterization.lineWidth);
+
+    const VkPipelineMultisampleStateCreateInfo& multisample = config.multisampleInfo;
+    append(key, multisample.rasterizationSamples);
+    append(key, multisample.sampleShadingEnable);
+    append(key, multisample.minSampleShading);
+    append(key, multisample.alphaToCoverageEnable);
+    append(key, multisample.alphaToOneEnable);
+    append(key, multisample.pSampleMask, multisample.pSampleMask != nullptr ? (multisample.rasterizationSamples + 31) / 32 : 0);
+
+    const VkPipelineDepthStencilStateCreateInfo& depthStencil = config.depthStencilInfo;
+    append(key, depthStencil.depthTestEnable);
+    append(key, depthStencil.depthWriteEnable);
+    append(key, depthStencil.depthCompareOp);
+    append(key, depthStencil.depthBoundsTestEnable);
+    append(key, depthStencil.stencilTestEnable);
+    append(key, depthStencil.front);
+    append(key, depthStencil.back);
+    append(key, depthStencil.minDepthBounds);
+    append(key, depthStencil.maxDepthBounds);
+
+    append(key, config.dynamicStateInfo.pDynamicStates, config.dynamicStateInfo.dynamicStateCount);
+
+    append(key, config.pipelineLayout);
+    append(key, config.subpass);
+    key += renderPassKey;
+
+    // Sorted by id, so the same constants give the same key
+    for (const auto& entry : config.specialization.getEntries())
+        append(key, entry.constantID);
+
+    append(key, config.specialization.getValues().data(), static_cast<uint32_t>(config.specialization.getValues().size()));
+
+    return key;
+}
+
+PipelineLibrary::Future
+PipelineLibrary::graphics(const std::string& vertPath, const std::string& fragPath, const PipelineConfigInfo& config)
+{
+    assert(config.pipelineLayout != VK_NULL_HANDLE && "Cannot Create Graphics Pipeline, no pipeline_layout Provided in 'config'");
+    assert(config.renderPass != VK_NULL_HANDLE && "Cannot Create Graphics Pipeline, no render_pass Provided in 'config'");
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->requests++;
+
+    uint64_t vertHash               = 0;
+    uint64_t fragHash               = 0;
+    const VkShaderModule vertModule = this->shaderModule(vertPath, vertHash);
+    const VkShaderModule fragModule = this->shaderModule(fragPath, fragHash);
+
+    const auto renderPass = this->renderPasses.find(config.renderPass);
+    if (renderPass == this->renderPasses.end())
+        throw std::runtime_error("Render Pass Was Not Added to the Pipeline Library!");
+
+    std::string key = graphicsKey(vertHash, fragHash, renderPass->second, config);
+    auto found      = this->pipelines.find(key);
+    if (found != this->pipelines.end())
+        return found->second.future;
+
+    // The dynamic states point into the copy rather than the caller's vector
+    PipelineConfigInfo copy = config;
+    if (config.dynamicStateInfo.pDynamicStates == config.dynamicStateEnables.data())
+        copy.dynamicStateInfo.pDynamicStates = copy.dynamicStateEnables.data();
+
+    Future future = this->workers.submit([this, vertModule, fragModule, vertPath, config = std::move(copy)]() {
+        const VkSpecializationInfo specializationInfo  = config.specialization.info();
+        const VkSpecializationInfo* specialization     = config.specialization.empty() ? nullptr : &specializationInfo;
+
+        VkPipelineShaderStageCreateInfo shaderStage[2] = { };
+
+        shaderStage[0].sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStage[0].stage                           = VK_SHADER_STAGE_VERTEX_BIT;
+        shaderStage[0].module                          = vertModule;
+        shaderStage[0].pName                           = "main";
+        shaderStage[0].pSpecializationInfo             = specialization;
+
+        shaderStage[1].sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStage[1].stage                           = VK_SHADER_STAGE_FRAGMENT_BIT;
+        shaderStage[1].module                          = fragModule;
+        shaderStage[1].pName                           = "main";
+        shaderStage[1].pSpecializationInfo             = specialization;
+
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo     = VkPipelineVertexInputStateCreateInfo();
+        vertexInputInfo.sType                                    = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputInfo.vertexAttributeDescriptionCount          = static_cast<uint32_t>(config.attributeDescriptions.size());
+        vertexInputInfo.vertexBindingDescriptionCount            = static_cast<uint32_t>(config.bindingDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions             = config.attributeDescriptions.data();
+        vertexInputInfo.pVertexBindingDescriptions               = config.bindingDescriptions.data();
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachment = { };
+        colorBlendAttachment.colorWriteMask                      =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable                         = VK_FALSE;
+        colorBlendAttachment.srcColorBlendFactor                 = VK_BLEND_FACTOR_ONE;   // Optional
+        colorBlendAttachment.dstColorBlendFactor                 = VK_BLEND_FACTOR_ZERO;  // Optional
+        colorBlendAttachment.colorBlendOp                        = VK_BLEND_OP_ADD;       // Optional
+        colorBlendAttachment.srcAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE;   // Optional
+        colorBlendAttachment.dstAlphaBlendFactor                 = VK_BLEND_FACTOR_ZERO;  // Optional
+        colorBlendAttachment.alphaBlendOp                        = VK_BLEND_OP_ADD;       // Optional
+
+        VkPipelineColorBlendStateCreateInfo colorBlendInfo       = { };
+        colorBlendInfo.sType                                     = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        colorBlendInfo.logicOpEnable                             = VK_FALSE;
+        colorBlendInfo.logicOp                                   = VK_LOGIC_OP_COPY;  // Optional
+        colorBlendInfo.attachmentCount                           = 1;
+        colorBlendInfo.pAttachments                              = &colorBlendAttachment;
+
+        VkGraphicsPipelineCreateInfo graphicsPipelineInfo        = VkGraphicsPipelineCreateInfo();
+        graphicsPipelineInfo.sType                               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        graphicsPipelineInfo.stageCount                          = 2;
+        graphicsPipelineInfo.pStages                             = shaderStage;
+        graphicsPipelineInfo.pVertexInputState                   = &vertexInputInfo;
+        graphicsPipelineInfo.pInputAssemblyState                 = &config.inputAssemblyInput;
+        graphicsPipelineInfo.pViewportState                      = &config.viewportInfo;
+        graphicsPipelineInfo.pRasterizationState                 = &config.rasterizationInfo;
+        graphicsPipelineInfo.pMultisampleState                   = &config.multisampleInfo;
+        graphicsPipelineInfo.pColorBlendState                    = &colorBlendInfo;
+        graphicsPipelineInfo.pDepthStencilState                  = &config.depthStencilInfo;
+        graphicsPipelineInfo.pDynamicState                       = &config.dynamicStateInfo;
+        graphicsPipelineInfo.layout                              = config.pipelineLayout;
+        graphicsPipelineInfo.renderPass                          = config.renderPass;
+        graphicsPipelineInfo.subpass                             = config.subpass;
+        graphicsPipelineInfo.basePipelineIndex                   = -1;
+        graphicsPipelineInfo.basePipelineHandle                  = VK_NULL_HANDLE;
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        VkPipeline pipeline = nullptr;
+        if (vkCreateGraphicsPipelines(this->device, this->cache.handle(), 1, &graphicsPipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Create Graphics Pipeline");
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        this->cache.record(vertPath, std::chrono::duration<double, std::milli>(end - start).count());
+
+        return pipeline;
+    }).share();
+
+    this->pipelines.emplace(std::move(key), Entry{ future, config.pipelineLayout });
+    return future;
+}
+
+PipelineLibrary::Future
+PipelineLibrary::compute(const std::string& compPath, VkPipelineLayout pipelineLayout)
+{
+    assert(pipelineLayout != VK_NULL_HANDLE && "Cannot Create Compute Pipeline, no pipeline_layout Provided");
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->requests++;
+
+    uint64_t compHash               = 0;
+    const VkShaderModule compModule = this->shaderModule(compPath, compHash);
+
+    std::string key = { };
+    append(key, compHash);
+    append(key, pipelineLayout);
+
+    auto found = this->pipelines.find(key);
+    if (found != this->pipelines.end())
+        return found->second.future;
+
+    Future future = this->workers.submit([this, compModule, compPath, pipelineLayout]() {
+        VkComputePipelineCreateInfo computePipelineInfo = { };
+        computePipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        computePipelineInfo.stage.sType                 = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computePipelineInfo.stage.stage                 = VK_SHADER_STAGE_COMPUTE_BIT;
+        computePipelineInfo.stage.module                = compModule;
+        computePipelineInfo.stage.pName                 = "main";
+        computePipelineInfo.layout                      = pipelineLayout;
+        computePipelineInfo.basePipelineIndex           = -1;
+        computePipelineInfo.basePipelineHandle          = VK_NULL_HANDLE;
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        VkPipeline pipeline = nullptr;
+        if (vkCreateComputePipelines(this->device, this->cache.handle(), 1, &computePipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Create Compute Pipeline");
+
+        const auto end = std::chrono::high_resolution_clock::now();
+        this->cache.record(compPath, std::chrono::duration<double, std::milli>(end - start).count());
+
+        return pipeline;
+    }).share();
+
+    this->pipelines.emplace(std::move(key), Entry{ future, pipelineLayout });
+    return future;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cmath>
+
+#include <Rendering/DrawQueue.hpp>
+
+uint64_t
+DrawQueue::makeKey(uint32_t pipeline, uint32_t material, uint32_t model, float depth)
+{
+    const uint64_t pipelineField = pipeline & ((1ull << PIPELINE_BITS) - 1);
+    const uint64_t materialField = material & ((1ull << MATERIAL_BITS) - 1);
+    const uint64_t modelField    = model & ((1ull << MODEL_BITS) - 1);
+    const uint64_t depthField    = depthBucket(depth);
+
+    return (pipelineField << (MATERIAL_BITS + MODEL_BITS + DEPTH_BITS)) |
+           (materialField << (MODEL_BITS + DEPTH_BITS)) |
+           (modelField << DEPTH_BITS) |
+           depthField;
+}
+
+uint32_t
+DrawQueue::depthBucket(float depth)
+{
+    // Logarithmic, so near objects, where order matters most, get the finest buckets
+    const uint32_t maxBucket = (1u << DEPTH_BITS) - 1;
+    const float bucket       = std::log2(1.0f + std::max(depth, 0.0f)) * 2048.0f;
+
+    return bucket < static_cast<float>(maxBucket) ? static_cast<uint32_t>(bucket) : maxBucket;
+}
+
+void
+DrawQueue::sort()
+{
+    const uint32_t count = this->size();
+    if (count < 2)
+        return;
+
+    // Every pass's histogram in one read of the keys
+    std::vector<uint32_t> histograms(PASSES * RADIX, 0);
+    for (const Packet& packet : this->packets)
+    {
+        for (uint32_t pass = 0; pass < PASSES; pass++)
+            histograms[pass * RADIX + ((packet.key >> (pass * RADIX_BITS)) & (RADIX - 1))]++;
+    }
+
+    this->scratch.resize(count);
+    for (uint32_t pass = 0; pass < PASSES; pass++)
+    {
+        const uint32_t shift = pass * RADIX_BITS;
+        uint32_t* offsets    = histograms.data() + pass * RADIX;
+
+        // Every key has the same digit here, mostly the unused top of the key
+        if (offsets[(this->packets[0].key >> shift) & (RADIX - 1)] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RADIX; digit++)
+        {
+            const uint32_t digitCount  = offsets[digit];
+            offsets[digit]             = offset;
+            offset                    += digitCount;
+        }
+
+        for (const Packet& packet : this->packets)
+            this->scratch[offsets[(packet.key >> shift) & (RADIX - 1)]++] = packet;
+
+        this->packets.swap(this->scratch);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#include <Rendering/FrustumCuller.hpp>
+
+// Set bits of each mask byte; popcnt is not part of the SSE and AVX targets
+static constexpr std::array<uint8_t, 256> BIT_COUNTS = []()
+{
+    std::array<uint8_t, 256> counts = { };
+    for (uint32_t i = 1; i < 256; i++)
+        counts[i] = static_cast<uint8_t>(counts[i / 2] + (i & 1));
+
+    return counts;
+}();
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUM_CULLER_SIMD
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#ifdef FRUSTUM_CULLER_SIMD
+#if defined(__GNUC__) || defined(__clang__)
+#define FRUSTUM_CULLER_TARGET_SSE __attribute__((target("sse")))
+#define FRUSTUM_CULLER_TARGET_AVX __attribute__((target("avx,fma")))
+#else
+#define FRUSTUM_CULLER_TARGET_SSE
+#define FRUSTUM_CULLER_TARGET_AVX
+#endif
+
+// The 8 wide path needs AVX and FMA from the CPU, and the OS to save the ymm registers
+static bool
+cpuHasAvxFma()
+{
+#ifdef _MSC_VER
+    int info[4] = { 0, 0, 0, 0 };
+    __cpuid(info, 1);
+    const unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+#endif
+    const bool fma     = (ecx & (1u << 12)) != 0;
+    const bool osxsave = (ecx & (1u << 27)) != 0;
+    const bool avx     = (ecx & (1u << 28)) != 0;
+    if (!fma || !osxsave || !avx)
+        return false;
+
+#ifdef _MSC_VER
+    const unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int xcr0Low = 0, xcr0High = 0;
+    __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    const unsigned long long xcr0 = xcr0Low;
+#endif
+    return (xcr0 & 0x6) == 0x6;
+}
+
+// Each plane component broadcast to every lane
+struct PlanesSse
+{
+    __m128 x[6];
+    __m128 y[6];
+    __m128 z[6];
+    __m128 w[6];
+};
+
+struct PlanesAvx
+{
+    __m256 x[6];
+    __m256 y[6];
+    __m256 z[6];
+    __m256 w[6];
+};
+
+// All bits set in the lanes whose sphere reaches the inner side of plane p
+FRUSTUM_CULLER_TARGET_SSE static inline __m128
+insideSse(const PlanesSse& planes, int p, __m128 x, __m128 y, __m128 z, __m128 negRadius)
+{
+    const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes.x[p], x), _mm_mul_ps(planes.y[p], y)),
+                                       _mm_add_ps(_mm_mul_ps(planes.z[p], z), planes.w[p]));
+    return _mm_cmpge_ps(distance, negRadius);
+}
+
+FRUSTUM_CULLER_TARGET_AVX static inline __m256
+insideAvx(const PlanesAvx& planes, int p, __m256 x, __m256 y, __m256 z, __m256 negRadius)
+{
+    const __m256 distance = _mm256_fmadd_ps(planes.x[p], x, _mm256_fmadd_ps(planes.y[p], y, _mm256_fmadd_ps(planes.z[p], z, planes.w[p])));
+    return _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ);
+}
+
+FRUSTUM_CULLER_TARGET_SSE static uint32_t
+cullSse(const float* x, const float* y, const float* z, const float* negR, uint8_t* masks, uint32_t blocks, const std::array<glm::vec4, 6>& frustum)
+{
+    PlanesSse planes = { };
+    for (int p = 0; p < 6; p++)
+    {
+        planes.x[p] = _mm_set1_ps(frustum[p].x);
+        planes.y[p] = _mm_set1_ps(frustum[p].y);
+        planes.z[p] = _mm_set1_ps(frustum[p].z);
+        planes.w[p] = _mm_set1_ps(frustum[p].w);
+    }
+
+    uint32_t visible = 0;
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+        int mask = 0;
+        for (uint32_t half = 0; half < 2; half++)
+        {
+            const uint32_t i    = block * FrustumCuller::BLOCK + half * 4;
+            const __m128 cx     = _mm_loadu_ps(x + i);
+            const __m128 cy     = _mm_loadu_ps(y + i);
+            const __m128 cz     = _mm_loadu_ps(z + i);
+            const __m128 bound  = _mm_loadu_ps(negR + i);
+
+            // Unrolled by hand, so the planes stay in registers whatever the compiler
+            const __m128 inside = _mm_and_ps(
+                _mm_and_ps(_mm_and_ps(insideSse(planes, 0, cx, cy, cz, bound), insideSse(planes, 1, cx, cy, cz, bound)),
+                           _mm_and_ps(insideSse(planes, 2, cx, cy, cz, bound), insideSse(planes, 3, cx, cy, cz, bound))),
+                _mm_and_ps(insideSse(planes, 4, cx, cy, cz, bound), insideSse(planes, 5, cx, cy, cz, bound)));
+
+            mask |= _mm_movemask_ps(inside) << (half * 4);
+        }
+
+        masks[block]  = static_cast<uint8_t>(mask);
+        visible      += BIT_COUNTS[mask];
+    }
+
+    return visible;
+}
+
+FRUSTUM_CULLER_TARGET_AVX static uint32_t
+cullAvx(const float* x, const float* y, const float* z, const float* negR, uint8_t* masks, uint32_t blocks, const std::array<glm::vec4, 6>& frustum)
+{
+    PlanesAvx planes = { };
+    for (int p = 0; p < 6; p++)
+    {
+        planes.x[p] = _mm256_set1_ps(frustum[p].x);
+        planes.y[p] = _mm256_set1_ps(frustum[p].y);
+        planes.z[p] = _mm256_set1_ps(frustum[p].z);
+        planes.w[p] = _mm256_set1_ps(frustum[p].w);
+    }
+
+    uint32_t visible = 0;
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+        const uint32_t i   = block * FrustumCuller::BLOCK;
+        const __m256 cx    = _mm256_loadu_ps(x + i);
+        const __m256 cy    = _mm256_loadu_ps(y + i);
+        const __m256 cz    = _mm256_loadu_ps(z + i);
+        const __m256 bound = _mm256_loadu_ps(negR + i);
+
+        const __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_and_ps(insideAvx(planes, 0, cx, cy, cz, bound), insideAvx(planes, 1, cx, cy, cz, bound)),
+                          _mm256_and_ps(insideAvx(planes, 2, cx, cy, cz, bound), insideAvx(planes, 3, cx, cy, cz, bound))),
+            _mm256_and_ps(insideAvx(planes, 4, cx, cy, cz, bound), insideAvx(planes, 5, cx, cy, cz, bound)));
+
+        const int mask  = _mm256_movemask_ps(inside);
+        masks[block]    = static_cast<uint8_t>(mask);
+        visible        += BIT_COUNTS[mask];
+    }
+
+    return visible;
+}
+#endif
+
+static uint32_t
+cullScalar(const float* x, const float* y, const float* z, const float* negR, uint8_t* masks, uint32_t blocks, const std::array<glm::vec4, 6>& planes)
+{
+    uint32_t visible = 0;
+    for (uint32_t block = 0; block < blocks; block++)
+    {
+        uint8_t mask = 0;
+        for (uint32_t lane = 0; lane < FrustumCuller::BLOCK; lane++)
+        {
+            const uint32_t i = block * FrustumCuller::BLOCK + lane;
+
+            bool inside = true;
+            for (const auto& plane : planes)
+                inside = inside && plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >= negR[i];
+
+            if (inside)
+            {
+                mask |= static_cast<uint8_t>(1u << lane);
+                visible++;
+            }
+        }
+
+        masks[block] = mask;
+    }
+
+    return visible;
+}
+
+FrustumCuller::FrustumCuller()
+{
+#ifdef FRUSTUM_CULLER_SIMD
+    this->supported = cpuHasAvxFma() ? InstructionSet::Avx : InstructionSet::Sse;
+#endif
+    this->instructionSet = this->supported;
+}
+
+// An object's Model::Sphere in world space, radius in w
+static glm::vec4
+worldSphere(const Object& object)
+{
+    const Model::Sphere& sphere         = object.model->getBoundingSphere();
+    const TransformComponent& transform = object.transform;
+    const glm::vec3 scale               = glm::abs(transform.scale);
+    const glm::vec3 offset              = transform.scale * sphere.center;
+
+    // Exact unrotated. Rotation turns the scaled center about the translation, so growing
+    // the radius by its distance covers every rotation without the trigonometry of mat4()
+    glm::vec3 center = transform.translation + offset;
+    float radius     = sphere.radius * std::max({ scale.x, scale.y, scale.z });
+    if (transform.rotation != glm::vec3(0.0f))
+    {
+        center  = transform.translation;
+        radius += glm::length(offset);
+    }
+
+    return glm::vec4(center, radius);
+}
+
+// Slack for rounding, so a group never decides differently from its objects' own tests
+static float
+groupSlack(float radius)
+{
+    return radius * 1.0001f + 1e-5f;
+}
+
+void
+FrustumCuller::Spheres::resize(uint32_t count)
+{
+    const uint32_t padded = (count + BLOCK - 1) / BLOCK * BLOCK;
+
+    this->centerX.assign(padded, 0.0f);
+    this->centerY.assign(padded, 0.0f);
+    this->centerZ.assign(padded, 0.0f);
+    this->negRadius.assign(padded, FLT_MAX);
+}
+
+void
+FrustumCuller::Spheres::set(uint32_t index, const glm::vec3& center, float radius)
+{
+    this->centerX[index]   = center.x;
+    this->centerY[index]   = center.y;
+    this->centerZ[index]   = center.z;
+    this->negRadius[index] = -radius;
+}
+
+glm::vec4
+FrustumCuller::Spheres::get(uint32_t index) const
+{
+    return glm::vec4(this->centerX[index], this->centerY[index], this->centerZ[index], -this->negRadius[index]);
+}
+
+void
+FrustumCuller::fitGroup(uint32_t group)
+{
+    const uint32_t first = group * GROUP;
+    const uint32_t last  = std::min(first + GROUP, this->count);
+
+    // Centered on the box around the member spheres, then grown to reach the farthest one
+    glm::vec3 low  = glm::vec3(FLT_MAX);
+    glm::vec3 high = glm::vec3(-FLT_MAX);
+    for (uint32_t i = first; i < last; i++)
+    {
+        const glm::vec4 sphere = this->spheres.get(i);
+        low                    = glm::min(low, glm::vec3(sphere) - sphere.w);
+        high                   = glm::max(high, glm::vec3(sphere) + sphere.w);
+    }
+
+    const glm::vec3 center = (low + high) * 0.5f;
+    float radius           = 0.0f;
+    for (uint32_t i = first; i < last; i++)
+    {
+        const glm::vec4 sphere = this->spheres.get(i);
+        radius                 = std::max(radius, glm::length(glm::vec3(sphere) - center) + sphere.w);
+    }
+
+    radius = groupSlack(radius);
+    this->groups.set(group, center, radius);
+    this->groupRadius[group] = radius;
+}
+
+void
+FrustumCuller::growGroup(uint32_t group, const glm::vec4& sphere)
+{
+    const glm::vec4 current = this->groups.get(group);
+    const glm::vec3 toward  = glm::vec3(sphere) - glm::vec3(current);
+    const float distance    = glm::length(toward);
+
+    // Already enclosed; otherwise the smallest sphere around both
+    if (distance + sphere.w <= current.w)
+        return;
+
+    glm::vec3 center = glm::vec3(sphere);
+    float radius     = sphere.w;
+    if (distance + current.w > sphere.w)
+    {
+        radius = 0.5f * (distance + current.w + sphere.w);
+        center = glm::vec3(current) + toward * ((radius - current.w) / distance);
+    }
+
+    radius = groupSlack(radius);
+    this->groups.set(group, center, radius);
+    this->groupRadius[group] = radius;
+}
+
+void
+FrustumCuller::rebuild(std::vector<Object>& objects)
+{
+    this->count               = static_cast<uint32_t>(objects.size());
+    this->firstID             = objects.empty() ? 0 : objects.front().getID();
+    this->lastID              = objects.empty() ? 0 : objects.back().getID();
+    const uint32_t groupCount = (this->count + GROUP - 1) / GROUP;
+
+    this->spheres.resize(this->count);
+    this->masks.resize(this->spheres.negRadius.size() / BLOCK);
+    this->groups.resize(groupCount);
+    this->groupRadius.assign(this->groups.negRadius.size(), FLT_MAX);
+    this->groupReached.resize(this->groups.negRadius.size() / BLOCK);
+    this->groupInside.resize(this->groups.negRadius.size() / BLOCK);
+
+    for (uint32_t i = 0; i < this->count; i++)
+    {
+        const glm::vec4 sphere = worldSphere(objects[i]);
+        this->spheres.set(i, glm::vec3(sphere), sphere.w);
+    }
+
+    for (uint32_t group = 0; group < groupCount; group++)
+        this->fitGroup(group);
+}
+
+void
+FrustumCuller::sync(std::vector<Object>& objects)
+{
+    // Object IDs are never reused, so a relayout always changes the first or last one
+    const bool sameObjects = objects.size() == this->count &&
+        (objects.empty() || (objects.front().getID() == this->firstID && objects.back().getID() == this->lastID));
+
+    if (!sameObjects)
+        this->rebuild(objects);
+    else
+    {
+        for (const uint32_t index : this->movedObjects)
+        {
+            if (index >= this->count)
+                continue;
+
+            const glm::vec4 sphere = worldSphere(objects[index]);
+            this->spheres.set(index, glm::vec3(sphere), sphere.w);
+            this->growGroup(index / GROUP, sphere);
+        }
+    }
+
+    this->movedObjects.clear();
+}
+
+uint32_t
+FrustumCuller::cullBlocks(const float* x, const float* y, const float* z, const float* negR, uint8_t* masks, uint32_t blockCount,
+    const std::array<glm::vec4, 6>& planes) const
+{
+    switch (this->instructionSet)
+    {
+#ifdef FRUSTUM_CULLER_SIMD
+    case InstructionSet::Avx:
+        return cullAvx(x, y, z, negR, masks, blockCount, planes);
+    case InstructionSet::Sse:
+        return cullSse(x, y, z, negR, masks, blockCount, planes);
+#endif
+    default:
+        return cullScalar(x, y, z, negR, masks, blockCount, planes);
+    }
+}
+
+uint32_t
+FrustumCuller::cull(const std::array<glm::vec4, 6>& planes)
+{
+    const uint32_t blocks      = static_cast<uint32_t>(this->masks.size());
+    const uint32_t groupCount  = (this->count + GROUP - 1) / GROUP;
+    const uint32_t groupBlocks = static_cast<uint32_t>(this->groupReached.size());
+
+    // The group spheres first, through the same tests: once against their negated radii for
+    // the groups reaching the frustum, once against their radii for those wholly inside
+    this->cullBlocks(this->groups.centerX.data(), this->groups.centerY.data(), this->groups.centerZ.data(),
+        this->groups.negRadius.data(), this->groupReached.data(), groupBlocks, planes);
+    this->cullBlocks(this->groups.centerX.data(), this->groups.centerY.data(), this->groups.centerZ.data(),
+        this->groupRadius.data(), this->groupInside.data(), groupBlocks, planes);
+
+    uint32_t visible   = 0;
+    uint32_t runStart  = 0;  // First block of the groups crossing a plane, tested together
+    uint32_t runBlocks = 0;
+
+    const auto flushRun = [&]()
+    {
+        if (runBlocks == 0)
+            return;
+
+        const uint32_t first = runStart * BLOCK;
+        visible += this->cullBlocks(this->spheres.centerX.data() + first, this->spheres.centerY.data() + first,
+            this->spheres.centerZ.data() + first, this->spheres.negRadius.data() + first, this->masks.data() + runStart, runBlocks, planes);
+        runBlocks = 0;
+    };
+
+    for (uint32_t group = 0; group < groupCount; group++)
+    {
+        const uint32_t firstBlock = group * GROUP_BLOCKS;
+
+        // Most of a large scene lies outside, so whole bytes of groups are skipped at once
+        if (group % BLOCK == 0 && group + BLOCK <= groupCount && this->groupReached[group / BLOCK] == 0)
+        {
+            flushRun();
+            memset(this->masks.data() + firstBlock, 0x00, BLOCK * GROUP_BLOCKS);
+            group += BLOCK - 1;
+            continue;
+        }
+
+        const uint32_t blockCount = std::min(GROUP_BLOCKS, blocks - firstBlock);
+        const bool reached        = (this->groupReached[group / BLOCK] >> (group % BLOCK)) & 1;
+        const bool inside         = (this->groupInside[group / BLOCK] >> (group % BLOCK)) & 1;
+
+        if (reached && !inside)
+        {
+            if (runBlocks == 0)
+                runStart = firstBlock;
+
+            runBlocks += blockCount;
+            continue;
+        }
+
+        flushRun();
+
+        // Wholly outside or inside, decided without reading the objects' spheres
+        memset(this->masks.data() + firstBlock, reached ? 0xFF : 0x00, blockCount);
+        if (!reached)
+            continue;
+
+        const uint32_t objects = std::min(GROUP, this->count - group * GROUP);
+        visible               += objects;
+        if (objects % BLOCK != 0)
+            this->masks[firstBlock + blockCount - 1] = static_cast<uint8_t>((1u << (objects % BLOCK)) - 1);
+    }
+
+    flushRun();
+    return visible;
+}
+
+const char*
+FrustumCuller::getName(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+    case InstructionSet::Avx:
+        return "AVX";
+    case InstructionSet::Sse:
+        return "SSE";
+    default:
+        return "scalar";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,736 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#include <Rendering/GpuCulling.hpp>
+#include <Rendering/RenderSystem.hpp>
+#include <SwapChain.hpp>
+
+GpuCulling::GpuCulling(Device& device, VkDescriptorSetLayout drawSetLayout, const std::vector<VkBuffer>& cameraBuffers, VkDeviceSize cameraSize)
+    : device(device), cameraSize(cameraSize)
+{
+    this->createCullPipeline();
+    this->createHiZPipeline();
+    this->createFrameData(drawSetLayout, cameraBuffers);
+}
+
+GpuCulling::~GpuCulling()
+{
+    for (auto& frame : this->frames)
+    {
+        this->device.destroyBuffer(frame.objectBuffer, frame.objectMemory);
+        this->device.destroyBuffer(frame.meshBuffer, frame.meshMemory);
+        this->device.destroyBuffer(frame.visibleBuffer, frame.visibleMemory);
+        this->device.destroyBuffer(frame.drawBuffer, frame.drawMemory);
+        this->device.destroyBuffer(frame.countBuffer, frame.countMemory);
+        this->device.destroyBuffer(frame.statsBuffer, frame.statsMemory);
+        this->destroyHiZ(frame);
+    }
+
+    if (this->visibilityBuffer != nullptr)
+        this->device.destroyBuffer(this->visibilityBuffer, this->visibilityMemory);
+
+    this->cullPipeline = nullptr;
+    this->hizPipeline  = nullptr;
+
+    vkDestroySampler(this->device.device(), this->hizSampler, nullptr);
+    vkDestroyDescriptorPool(this->device.device(), this->descriptorPool, nullptr);
+    this->device.pipelines().releaseLayout(this->hizPipelineLayout);
+    vkDestroyPipelineLayout(this->device.device(), this->hizPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(this->device.device(), this->hizSetLayout, nullptr);
+    this->device.pipelines().releaseLayout(this->cullPipelineLayout);
+    vkDestroyPipelineLayout(this->device.device(), this->cullPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(this->device.device(), this->cullSetLayout, nullptr);
+}
+
+void
+GpuCulling::createCullPipeline()
+{
+    // Camera, then objects, meshes, visible objects, draws, counts, the Hi-Z pyramid,
+    // visibility and stats
+    VkDescriptorSetLayoutBinding bindings[9] = { };
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        bindings[i].binding         = i;
+        bindings[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    bindings[0].descriptorType                    = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[6].descriptorType                    = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = { };
+    setLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount                    = 9;
+    setLayoutInfo.pBindings                       = bindings;
+
+    if (vkCreateDescriptorSetLayout(this->device.device(), &setLayoutInfo, nullptr, &this->cullSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Descriptor Set Layout!");
+
+    VkPushConstantRange pushConstantRange         = { };
+    pushConstantRange.stageFlags                  = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset                      = 0;
+    pushConstantRange.size                        = sizeof(CullPush);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = { };
+    pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount             = 1;
+    pipelineLayoutInfo.pSetLayouts                = &this->cullSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount     = 1;
+    pipelineLayoutInfo.pPushConstantRanges        = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(this->device.device(), &pipelineLayoutInfo, nullptr, &this->cullPipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Pipeline Layout!");
+
+    this->cullPipeline = std::make_unique<Pipeline>(this->device, "Assets/Shaders/Cull.comp.spv", this->cullPipelineLayout);
+}
+
+void
+GpuCulling::createHiZPipeline()
+{
+    // The level above, or the depth attachment, then the level written
+    VkDescriptorSetLayoutBinding bindings[2] = { };
+    bindings[0].binding                      = 0;
+    bindings[0].descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount              = 1;
+    bindings[0].stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    bindings[1].binding                      = 1;
+    bindings[1].descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    bindings[1].descriptorCount              = 1;
+    bindings[1].stageFlags                   = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = { };
+    setLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount                    = 2;
+    setLayoutInfo.pBindings                       = bindings;
+
+    if (vkCreateDescriptorSetLayout(this->device.device(), &setLayoutInfo, nullptr, &this->hizSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Descriptor Set Layout!");
+
+    VkPushConstantRange pushConstantRange         = { };
+    pushConstantRange.stageFlags                  = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset                      = 0;
+    pushConstantRange.size                        = sizeof(HiZPush);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = { };
+    pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount             = 1;
+    pipelineLayoutInfo.pSetLayouts                = &this->hizSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount     = 1;
+    pipelineLayoutInfo.pPushConstantRanges        = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(this->device.device(), &pipelineLayoutInfo, nullptr, &this->hizPipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Pipeline Layout!");
+
+    this->hizPipeline = std::make_unique<Pipeline>(this->device, "Assets/Shaders/HiZ.comp.spv", this->hizPipelineLayout);
+
+    // Only read with texelFetch, which ignores filtering
+    VkSamplerCreateInfo samplerInfo = { };
+    samplerInfo.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter           = VK_FILTER_NEAREST;
+    samplerInfo.minFilter           = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod              = VK_LOD_CLAMP_NONE;
+
+    if (vkCreateSampler(this->device.device(), &samplerInfo, nullptr, &this->hizSampler) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Hi-Z Sampler!");
+}
+
+void
+GpuCulling::createFrameData(VkDescriptorSetLayout drawSetLayout, const std::vector<VkBuffer>& cameraBuffers)
+{
+    const uint32_t frameCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+    // A cull set, a draw set and a set per Hi-Z level per frame
+    const uint32_t setsPerFrame       = 2 + MAX_HIZ_LEVELS;
+
+    VkDescriptorPoolSize poolSizes[4] = { };
+    poolSizes[0].type                 = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount      = 2 * frameCount;
+    poolSizes[1].type                 = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount      = 8 * frameCount;
+    poolSizes[2].type                 = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[2].descriptorCount      = (1 + MAX_HIZ_LEVELS) * frameCount;
+    poolSizes[3].type                 = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    poolSizes[3].descriptorCount      = MAX_HIZ_LEVELS * frameCount;
+
+    VkDescriptorPoolCreateInfo poolInfo = { };
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets                    = setsPerFrame * frameCount;
+    poolInfo.poolSizeCount              = 4;
+    poolInfo.pPoolSizes                 = poolSizes;
+
+    if (vkCreateDescriptorPool(this->device.device(), &poolInfo, nullptr, &this->descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Descriptor Pool!");
+
+    std::vector<VkDescriptorSetLayout> setLayouts = { };
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        setLayouts.push_back(this->cullSetLayout);
+        setLayouts.push_back(drawSetLayout);
+        setLayouts.insert(setLayouts.end(), MAX_HIZ_LEVELS, this->hizSetLayout);
+    }
+
+    std::vector<VkDescriptorSet> sets(setLayouts.size());
+
+    VkDescriptorSetAllocateInfo allocInfo = { };
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = this->descriptorPool;
+    allocInfo.descriptorSetCount          = static_cast<uint32_t>(sets.size());
+    allocInfo.pSetLayouts                 = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(this->device.device(), &allocInfo, sets.data()) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Allocate Descriptor Sets!");
+
+    this->frames.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        FrameData& frame     = this->frames[i];
+        frame.cameraBuffer   = cameraBuffers[i];
+        frame.cullSet        = sets[setsPerFrame * i];
+        frame.result.drawSet = sets[setsPerFrame * i + 1];
+        std::copy_n(sets.begin() + setsPerFrame * i + 2, MAX_HIZ_LEVELS, frame.hizSets);
+
+        this->device.createBuffer(PIPELINE_COUNT * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            frame.countBuffer,
+            frame.countMemory);
+
+        this->device.createBuffer(sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.statsBuffer,
+            frame.statsMemory);
+
+        *static_cast<uint32_t*>(frame.statsMemory.mapped) = 0;
+
+        // A pyramid of one texel, until the first Late phase says how large the depth is
+        this->createHiZ(frame, { 1, 1 });
+        this->reserveVisibility(MIN_OBJECTS);
+        this->reserveMeshes(frame, MIN_MESHES);
+        this->reserveObjects(frame, MIN_OBJECTS);
+    }
+}
+
+void
+GpuCulling::createHiZ(FrameData& frame, VkExtent2D depthExtent)
+{
+    const uint32_t width  = std::max(depthExtent.width / 2, 1u);
+    const uint32_t height = std::max(depthExtent.height / 2, 1u);
+
+    // Down to a single texel
+    uint32_t levels = 1;
+    while ((std::max(width, height) >> levels) > 0 && levels < MAX_HIZ_LEVELS)
+        levels++;
+
+    frame.depthExtent = depthExtent;
+    frame.hizLevels   = levels;
+
+    VkImageCreateInfo imageInfo = { };
+    imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width      = width;
+    imageInfo.extent.height     = height;
+    imageInfo.extent.depth      = 1;
+    imageInfo.mipLevels         = levels;
+    imageInfo.arrayLayers       = 1;
+    imageInfo.format            = VK_FORMAT_R32_SFLOAT;
+    imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage             = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+
+    this->device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.hizImage, frame.hizMemory);
+
+    VkImageViewCreateInfo viewInfo           = { };
+    viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image                           = frame.hizImage;
+    viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format                          = VK_FORMAT_R32_SFLOAT;
+    viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel   = 0;
+    viewInfo.subresourceRange.levelCount     = levels;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount     = 1;
+
+    if (vkCreateImageView(this->device.device(), &viewInfo, nullptr, &frame.hizView) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Hi-Z Image View!");
+
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        viewInfo.subresourceRange.baseMipLevel = level;
+        viewInfo.subresourceRange.levelCount   = 1;
+
+        if (vkCreateImageView(this->device.device(), &viewInfo, nullptr, &frame.hizLevelViews[level]) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Create Hi-Z Image View!");
+    }
+
+    // Kept in VK_IMAGE_LAYOUT_GENERAL, written and sampled level by level
+    std::vector<VkDescriptorImageInfo> imageInfos = { };
+    std::vector<VkWriteDescriptorSet> writes      = { };
+    imageInfos.reserve(2 * levels + 1);
+
+    imageInfos.push_back({ this->hizSampler, frame.hizView, VK_IMAGE_LAYOUT_GENERAL });
+
+    VkWriteDescriptorSet write = { };
+    write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet               = frame.cullSet;
+    write.dstBinding           = 6;
+    write.descriptorCount      = 1;
+    write.descriptorType       = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo           = &imageInfos.back();
+    writes.push_back(write);
+
+    // The source of level 0 is the depth attachment, written by buildHiZ
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        imageInfos.push_back({ nullptr, frame.hizLevelViews[level], VK_IMAGE_LAYOUT_GENERAL });
+        write.dstSet         = frame.hizSets[level];
+        write.dstBinding     = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        write.pImageInfo     = &imageInfos.back();
+        writes.push_back(write);
+
+        if (level == 0)
+            continue;
+
+        imageInfos.push_back({ this->hizSampler, frame.hizLevelViews[level - 1], VK_IMAGE_LAYOUT_GENERAL });
+        write.dstBinding     = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo     = &imageInfos.back();
+        writes.push_back(write);
+    }
+
+    vkUpdateDescriptorSets(this->device.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void
+GpuCulling::destroyHiZ(FrameData& frame)
+{
+    for (uint32_t level = 0; level < frame.hizLevels; level++)
+        vkDestroyImageView(this->device.device(), frame.hizLevelViews[level], nullptr);
+
+    vkDestroyImageView(this->device.device(), frame.hizView, nullptr);
+    this->device.destroyImage(frame.hizImage, frame.hizMemory);
+
+    std::fill(std::begin(frame.hizLevelViews), std::end(frame.hizLevelViews), nullptr);
+    frame.hizView   = nullptr;
+    frame.hizImage  = nullptr;
+    frame.hizLevels = 0;
+}
+
+void
+GpuCulling::reserveVisibility(uint32_t objectCount)
+{
+    if (this->visibilityCapacity >= objectCount)
+        return;
+
+    // The other frame in flight may still read or write it
+    if (this->visibilityBuffer != nullptr)
+    {
+        vkDeviceWaitIdle(this->device.device());
+        this->device.destroyBuffer(this->visibilityBuffer, this->visibilityMemory);
+    }
+
+    this->visibilityCapacity = std::max({ objectCount, this->visibilityCapacity * 2, MIN_OBJECTS });
+    this->device.createBuffer(this->visibilityCapacity * sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        this->visibilityBuffer,
+        this->visibilityMemory);
+
+    // Cleared by the next cull, so nothing counts as visible last frame
+    this->visibilityCleared = false;
+
+    for (auto& frame : this->frames)
+    {
+        if (frame.objectBuffer != nullptr)
+            this->writeDescriptors(frame);
+    }
+}
+
+void
+GpuCulling::reserveObjects(FrameData& frame, uint32_t objectCount)
+{
+    // The frame's previous submission is done by now, so its buffers can be replaced
+    if (frame.objectCapacity >= objectCount)
+        return;
+
+    if (frame.objectBuffer != nullptr)
+    {
+        this->device.destroyBuffer(frame.objectBuffer, frame.objectMemory);
+        this->device.destroyBuffer(frame.visibleBuffer, frame.visibleMemory);
+        this->device.destroyBuffer(frame.drawBuffer, frame.drawMemory);
+    }
+
+    frame.objectCapacity = std::max({ objectCount, frame.objectCapacity * 2, MIN_OBJECTS });
+
+    this->device.createBuffer(frame.objectCapacity * sizeof(CullObject),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frame.objectBuffer,
+        frame.objectMemory);
+
+    // Every object could land in either pipeline, so each gets a full list
+    this->device.createBuffer(PIPELINE_COUNT * frame.objectCapacity * sizeof(RenderSystem::ObjectData),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        frame.visibleBuffer,
+        frame.visibleMemory);
+
+    this->device.createBuffer(PIPELINE_COUNT * frame.objectCapacity * sizeof(VkDrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        frame.drawBuffer,
+        frame.drawMemory);
+
+    this->writeDescriptors(frame);
+}
+
+void
+GpuCulling::reserveMeshes(FrameData& frame, uint32_t meshCount)
+{
+    if (frame.meshCapacity >= meshCount)
+        return;
+
+    if (frame.meshBuffer != nullptr)
+        this->device.destroyBuffer(frame.meshBuffer, frame.meshMemory);
+
+    frame.meshCapacity = std::max({ meshCount, frame.meshCapacity * 2, MIN_MESHES });
+
+    this->device.createBuffer(frame.meshCapacity * sizeof(CullMesh),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frame.meshBuffer,
+        frame.meshMemory);
+
+    // Before the first reserveObjects the sets are left for it to write
+    if (frame.objectBuffer != nullptr)
+        this->writeDescriptors(frame);
+}
+
+void
+GpuCulling::writeDescriptors(FrameData& frame)
+{
+    // Binding 6, the Hi-Z pyramid, is written by createHiZ
+    const VkDescriptorBufferInfo infos[9] = {
+        { frame.cameraBuffer, 0, this->cameraSize },
+        { frame.objectBuffer, 0, VK_WHOLE_SIZE },
+        { frame.meshBuffer, 0, VK_WHOLE_SIZE },
+        { frame.visibleBuffer, 0, VK_WHOLE_SIZE },
+        { frame.drawBuffer, 0, VK_WHOLE_SIZE },
+        { frame.countBuffer, 0, VK_WHOLE_SIZE },
+        { },
+        { this->visibilityBuffer, 0, VK_WHOLE_SIZE },
+        { frame.statsBuffer, 0, VK_WHOLE_SIZE }
+    };
+
+    VkWriteDescriptorSet writes[10] = { };
+    uint32_t writeCount             = 0;
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        if (i == 6)
+            continue;
+
+        VkWriteDescriptorSet& write = writes[writeCount++];
+        write.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet                = frame.cullSet;
+        write.dstBinding            = i;
+        write.descriptorCount       = 1;
+        write.descriptorType        = i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo           = &infos[i];
+    }
+
+    // RenderSystem's layout: the camera, then the ObjectData Cull.comp wrote
+    writes[writeCount]              = writes[0];
+    writes[writeCount++].dstSet     = frame.result.drawSet;
+
+    writes[writeCount]              = writes[3];
+    writes[writeCount].dstSet       = frame.result.drawSet;
+    writes[writeCount++].dstBinding = 1;
+
+    vkUpdateDescriptorSets(this->device.device(), writeCount, writes, 0, nullptr);
+}
+
+uint32_t
+GpuCulling::meshFor(Model& model)
+{
+    auto found = this->meshByModel.emplace(&model, static_cast<uint32_t>(this->meshes.size()));
+    if (!found.second)
+        return found.first->second;
+
+    const GeometryPool::Range& range = this->device.geometry().getRange(model.getGeometry());
+    const bool quantized             = model.getVertexFormat() == Model::VertexFormat::Quantized;
+
+    CullMesh mesh     = { };
+    mesh.boundsMin    = glm::vec4(model.getBounds().min, 1.0f);
+    mesh.boundsMax    = glm::vec4(model.getBounds().max, 1.0f);
+    mesh.sphere       = glm::vec4(model.getBoundingSphere().center, model.getBoundingSphere().radius);
+    mesh.vertexOffset = static_cast<int32_t>(range.vertexOffset);
+    mesh.pipeline     = quantized ? 1 : 0;
+    mesh.quantized    = quantized ? 1 : 0;
+
+    // Non-indexed models stay on the CPU paths
+    if (range.indexCount > 0)
+    {
+        mesh.lodCount = std::min(model.getLodCount(), Model::MAX_LODS);
+        for (uint32_t lod = 0; lod < mesh.lodCount; lod++)
+        {
+            const Model::Lod& source = model.getLod(lod);
+            mesh.lods[lod]           = { range.firstIndex + source.firstIndex, source.indexCount, source.error };
+        }
+    }
+
+    this->meshes.push_back(mesh);
+    return found.first->second;
+}
+
+const GpuCulling::Result&
+GpuCulling::cull(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<Object>& objects, Phase phase, VkExtent2D depthExtent)
+{
+    FrameData& frame = this->frames[frameIndex];
+    Result& result   = frame.result;
+
+    // The frame's last submission is done with the old pyramid
+    const bool resized = frame.depthExtent.width != depthExtent.width || frame.depthExtent.height != depthExtent.height;
+    if (phase == Phase::Early && resized)
+    {
+        this->destroyHiZ(frame);
+        this->createHiZ(frame, depthExtent);
+    }
+
+    // Counted by the Late phase of this frame's last submission, which its fence saw finish
+    uint32_t* stats    = static_cast<uint32_t*>(frame.statsMemory.mapped);
+    result.occluded    = *stats;
+    *stats             = 0;
+
+    result.objectCount = 0;
+    result.streaming   = 0;
+    std::fill(std::begin(result.pipelineModels), std::end(result.pipelineModels), nullptr);
+
+    // Ranges move when the pool compacts, so the table is rebuilt every frame
+    this->meshes.clear();
+    this->meshByModel.clear();
+
+    this->reserveObjects(frame, static_cast<uint32_t>(objects.size()));
+    this->reserveVisibility(static_cast<uint32_t>(objects.size()));
+
+    CullObject* cullObjects = static_cast<CullObject*>(frame.objectMemory.mapped);
+    for (uint32_t i = 0; i < objects.size(); i++)
+    {
+        Object& object = objects[i];
+
+        // Still on its way through the transfer queue
+        if (!this->device.uploads().isAcquired(object.model->getUploadTicket()))
+        {
+            result.streaming++;
+            continue;
+        }
+
+        const uint32_t mesh = this->meshFor(*object.model);
+        if (this->meshes[mesh].lodCount > 0 && result.pipelineModels[this->meshes[mesh].pipeline] == nullptr)
+            result.pipelineModels[this->meshes[mesh].pipeline] = object.model.get();
+
+        CullObject& cullObject = cullObjects[result.objectCount++];
+        cullObject.transform   = object.transform.mat4();
+        cullObject.color       = glm::vec4(object.color, object.alpha);
+        cullObject.mesh        = mesh;
+        cullObject.id          = i;
+    }
+
+    this->reserveMeshes(frame, static_cast<uint32_t>(this->meshes.size()));
+    if (!this->meshes.empty())
+        memcpy(frame.meshMemory.mapped, this->meshes.data(), this->meshes.size() * sizeof(CullMesh));
+
+    if (!this->visibilityCleared)
+    {
+        vkCmdFillBuffer(commandBuffer, this->visibilityBuffer, 0, VK_WHOLE_SIZE, 0);
+        this->visibilityCleared = true;
+    }
+
+    this->dispatchCull(commandBuffer, frame, phase);
+    return result;
+}
+
+const GpuCulling::Result&
+GpuCulling::cullOccluded(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkImageView depthView)
+{
+    FrameData& frame = this->frames[frameIndex];
+    this->buildHiZ(commandBuffer, frame, depthView);
+
+    // Early's draws are done with the counts, commands and ObjectData Late rewrites
+    VkMemoryBarrier drawnBarrier = { };
+    drawnBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    drawnBarrier.srcAccessMask   = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    drawnBarrier.dstAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &drawnBarrier, 0, nullptr, 0, nullptr);
+
+    this->dispatchCull(commandBuffer, frame, Phase::Late);
+
+    // The occluded count is read on the host once the frame's fence has signalled
+    VkBufferMemoryBarrier statsBarrier = { };
+    statsBarrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    statsBarrier.srcAccessMask         = VK_ACCESS_SHADER_WRITE_BIT;
+    statsBarrier.dstAccessMask         = VK_ACCESS_HOST_READ_BIT;
+    statsBarrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    statsBarrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    statsBarrier.buffer                = frame.statsBuffer;
+    statsBarrier.offset                = 0;
+    statsBarrier.size                  = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0, 0, nullptr, 1, &statsBarrier, 0, nullptr);
+
+    return frame.result;
+}
+
+void
+GpuCulling::buildHiZ(VkCommandBuffer commandBuffer, FrameData& frame, VkImageView depthView)
+{
+    // Last frame's pyramid is discarded, not read
+    VkImageMemoryBarrier imageBarrier            = { };
+    imageBarrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask                   = 0;
+    imageBarrier.dstAccessMask                   = VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrier.newLayout                       = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image                           = frame.hizImage;
+    imageBarrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageBarrier.subresourceRange.baseMipLevel   = 0;
+    imageBarrier.subresourceRange.levelCount     = frame.hizLevels;
+    imageBarrier.subresourceRange.baseArrayLayer = 0;
+    imageBarrier.subresourceRange.layerCount     = 1;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    // The depth attachment changes with the swap chain image
+    VkDescriptorImageInfo depthInfo = { this->hizSampler, depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+
+    VkWriteDescriptorSet write = { };
+    write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet               = frame.hizSets[0];
+    write.dstBinding           = 0;
+    write.descriptorCount      = 1;
+    write.descriptorType       = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo           = &depthInfo;
+
+    vkUpdateDescriptorSets(this->device.device(), 1, &write, 0, nullptr);
+
+    VkMemoryBarrier levelBarrier = { };
+    levelBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    levelBarrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+    levelBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT;
+
+    this->hizPipeline->bind(commandBuffer);
+
+    HiZPush push       = { };
+    push.sourceSize[0] = frame.depthExtent.width;
+    push.sourceSize[1] = frame.depthExtent.height;
+
+    for (uint32_t level = 0; level < frame.hizLevels; level++)
+    {
+        push.size[0] = std::max(push.sourceSize[0] / 2, 1u);
+        push.size[1] = std::max(push.sourceSize[1] / 2, 1u);
+
+        vkCmdBindDescriptorSets(commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            this->hizPipelineLayout,
+            0, 1, &frame.hizSets[level],
+            0, nullptr);
+        vkCmdPushConstants(commandBuffer, this->hizPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZPush), &push);
+        vkCmdDispatch(commandBuffer,
+            (push.size[0] + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+            (push.size[1] + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE,
+            1);
+
+        // Read by the next level, and the last by Cull.comp
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+
+        push.sourceSize[0] = push.size[0];
+        push.sourceSize[1] = push.size[1];
+    }
+}
+
+void
+GpuCulling::dispatchCull(VkCommandBuffer commandBuffer, FrameData& frame, Phase phase)
+{
+    vkCmdFillBuffer(commandBuffer, frame.countBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    // Also orders this dispatch after the last Late phase's visibility writes, this frame's
+    // or the one before
+    VkMemoryBarrier clearBarrier = { };
+    clearBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    clearBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    if (frame.result.objectCount > 0)
+    {
+        CullPush push     = { };
+        push.objectCount  = frame.result.objectCount;
+        push.capacity     = frame.objectCapacity;
+        push.phase        = static_cast<uint32_t>(phase);
+        push.depthSize[0] = frame.depthExtent.width;
+        push.depthSize[1] = frame.depthExtent.height;
+
+        this->cullPipeline->bind(commandBuffer);
+        vkCmdBindDescriptorSets(commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            this->cullPipelineLayout,
+            0, 1, &frame.cullSet,
+            0, nullptr);
+        vkCmdPushConstants(commandBuffer, this->cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPush), &push);
+        vkCmdDispatch(commandBuffer, (frame.result.objectCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+    }
+
+    // Draw commands and counts are read as indirect arguments, the ObjectData by Vertex.vert
+    VkMemoryBarrier cullBarrier = { };
+    cullBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullBarrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+    cullBarrier.dstAccessMask   = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+}
+
+void
+GpuCulling::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, uint32_t pipeline) const
+{
+    const FrameData& frame   = this->frames[frameIndex];
+    const VkDeviceSize first = static_cast<VkDeviceSize>(pipeline) * frame.objectCapacity;
+
+    vkCmdDrawIndexedIndirectCount(commandBuffer,
+        frame.drawBuffer,
+        first * sizeof(VkDrawIndexedIndirectCommand),
+        frame.countBuffer,
+        pipeline * sizeof(uint32_t),
+        frame.objectCapacity,
+        sizeof(VkDrawIndexedIndirectCommand));
+}
\ No newline at end of file
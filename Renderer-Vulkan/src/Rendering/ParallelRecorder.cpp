@@ -0,0 +1,96 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+
+#include <Rendering/ParallelRecorder.hpp>
+#include <SwapChain.hpp>
+
+ParallelRecorder::ParallelRecorder(Device& device, uint32_t workerCount) :
+    device(device),
+    workers(workerCount)
+{
+    this->createWorkerFrames();
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+    // Destroying a pool frees its command buffers
+    for (auto& workerFrame : this->workerFrames)
+        vkDestroyCommandPool(this->device.device(), workerFrame.commandPool, nullptr);
+}
+
+void
+ParallelRecorder::createWorkerFrames()
+{
+    const uint32_t frameCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
+    const uint32_t workers    = this->workers.getWorkerCount();
+
+    this->workerFrames.resize(frameCount * workers);
+    for (auto& workerFrame : this->workerFrames)
+    {
+        // Reset whole each frame rather than buffer by buffer
+        VkCommandPoolCreateInfo poolInfo = { };
+        poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex        = this->device.findPhysicalQueueFamilies().graphicsFamily;
+        poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+        if (vkCreateCommandPool(this->device.device(), &poolInfo, nullptr, &workerFrame.commandPool) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Create Worker Command Pool!");
+
+        VkCommandBufferAllocateInfo allocInfo = { };
+        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandPool                 = workerFrame.commandPool;
+        allocInfo.commandBufferCount          = 1;
+
+        if (vkAllocateCommandBuffers(this->device.device(), &allocInfo, &workerFrame.commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Allocate Secondary Command Buffer!");
+    }
+}
+
+void
+ParallelRecorder::record(VkCommandBuffer primaryCommandBuffer,
+                         uint32_t frameIndex,
+                         uint32_t jobCount,
+                         const RenderPassTarget& target,
+                         const std::function<void(uint32_t, VkCommandBuffer)>& record)
+{
+    const uint32_t workers = this->workers.getWorkerCount();
+    jobCount               = std::min(jobCount, workers);
+    if (jobCount == 0)
+        return;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo = { };
+    inheritanceInfo.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass                     = target.renderPass;
+    inheritanceInfo.subpass                        = 0;
+    inheritanceInfo.framebuffer                    = target.framebuffer;
+
+    this->workers.run(jobCount, [&](uint32_t worker) {
+        // The frame's fence has been waited on, so its pool's last submission is done
+        const WorkerFrame& workerFrame = this->workerFrames[frameIndex * workers + worker];
+        if (vkResetCommandPool(this->device.device(), workerFrame.commandPool, 0) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Reset Worker Command Pool!");
+
+        VkCommandBufferBeginInfo beginInfo = { };
+        beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        beginInfo.pInheritanceInfo         = &inheritanceInfo;
+
+        if (vkBeginCommandBuffer(workerFrame.commandBuffer, &beginInfo) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Begin Recording Secondary Command Buffer!");
+
+        // Dynamic state is not inherited from the primary
+        Renderer::setViewport(workerFrame.commandBuffer, target.extent);
+        record(worker, workerFrame.commandBuffer);
+
+        if (vkEndCommandBuffer(workerFrame.commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Record Secondary Command Buffer!");
+    });
+
+    this->recorded.clear();
+    for (uint32_t worker = 0; worker < jobCount; worker++)
+        this->recorded.push_back(this->workerFrames[frameIndex * workers + worker].commandBuffer);
+
+    vkCmdExecuteCommands(primaryCommandBuffer, jobCount, this->recorded.data());
+}
\ No newline at end of file
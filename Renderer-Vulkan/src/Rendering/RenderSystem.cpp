@@ -1,5 +1,10 @@
 #include <stdexcept>
 #include <array>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -7,38 +12,142 @@
 #include <glm/gtc/constants.hpp>
 
 #include <Rendering/RenderSystem.hpp>
+#include <Rendering/StateTracker.hpp>
+#include <SwapChain.hpp>
 
+// Only what changes per model; the camera and transforms come from the frame's descriptor set
 struct PushConstantData
 {
-    glm::mat4 transform = { };
-    alignas(16) glm::vec3 color;
+    // Model::VertexFormat::Quantized positions decode as positionOffset + position * positionScale
+    alignas(16) glm::vec3 positionOffset;
+    alignas(16) glm::vec3 positionScale;
 };
 
-RenderSystem::RenderSystem(Device& device, const VkRenderPass& renderPass)
-    : device(device)
+// Moves the depth attachment of target between the layout SwapChain::Pass::Early leaves it
+// in, which Late starts from, and the one the Hi-Z build samples it in
+static void
+transitionDepth(VkCommandBuffer commandBuffer, const RenderPassTarget& target, bool toSampled)
+{
+    const VkPipelineStageFlags attachmentStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+    VkImageMemoryBarrier barrier            = { };
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = target.depthImage;
+    barrier.subresourceRange.aspectMask     = target.depthAspect;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = 1;
+
+    if (toSampled)
+    {
+        // Early's depth writes, read after
+        barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+        vkCmdPipelineBarrier(commandBuffer, attachmentStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+    else
+    {
+        // Late tests and writes depth only once the build is done reading it
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        barrier.oldLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        barrier.newLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, attachmentStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
+
+// Adds what one worker recorded to the frame's stats
+static void
+addDrawStats(FrameStats& stats, const FrameStats& worker)
+{
+    if (stats.lodDraws.size() < worker.lodDraws.size())
+        stats.lodDraws.resize(worker.lodDraws.size(), 0);
+
+    for (size_t lod = 0; lod < worker.lodDraws.size(); lod++)
+        stats.lodDraws[lod] += worker.lodDraws[lod];
+
+    stats.objects             += worker.objects;
+    stats.geometryBinds       += worker.geometryBinds;
+    stats.stateBinds          += worker.stateBinds;
+    stats.bindsAvoided        += worker.bindsAvoided;
+    stats.drawCalls           += worker.drawCalls;
+    stats.triangles           += worker.triangles;
+    stats.fullDetailTriangles += worker.fullDetailTriangles;
+}
+
+RenderSystem::RenderSystem(Device& device, const VkRenderPass& renderPass, const ShaderFeatures& shaderFeatures)
+    : device(device), renderPass(renderPass), shaderFeatures(shaderFeatures)
 {
     this->createPiplineLayout();
-    this->createPipeline(renderPass);
+    this->createPipeline();
+    this->createFrameData();
+
+    if (this->device.supportsDrawIndirectCount())
+    {
+        std::vector<VkBuffer> cameraBuffers = { };
+        for (const auto& frame : this->frames)
+            cameraBuffers.push_back(frame.cameraBuffer);
+
+        this->gpuCulling = std::make_unique<GpuCulling>(this->device, this->frameSetLayout, cameraBuffers, sizeof(CameraData));
+    }
 }
 
 RenderSystem::~RenderSystem()
 {
+    this->gpuCulling = nullptr;
+
+    for (auto& frame : this->frames)
+    {
+        this->device.destroyBuffer(frame.cameraBuffer, frame.cameraMemory);
+
+        if (frame.objectBuffer != nullptr)
+            this->device.destroyBuffer(frame.objectBuffer, frame.objectMemory);
+    }
+
+    vkDestroyDescriptorPool(this->device.device(), this->descriptorPool, nullptr);
+    this->device.pipelines().releaseLayout(this->pipelineLayout);
     vkDestroyPipelineLayout(this->device.device(), this->pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(this->device.device(), this->frameSetLayout, nullptr);
 }
 
 void
 RenderSystem::createPiplineLayout()
 {
+    VkDescriptorSetLayoutBinding bindings[2] = { };
+    bindings[0].binding                      = 0;
+    bindings[0].descriptorType               = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    bindings[0].descriptorCount              = 1;
+    bindings[0].stageFlags                   = VK_SHADER_STAGE_VERTEX_BIT;
+
+    bindings[1].binding                      = 1;
+    bindings[1].descriptorType               = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount              = 1;
+    bindings[1].stageFlags                   = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = { };
+    setLayoutInfo.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount                    = 2;
+    setLayoutInfo.pBindings                       = bindings;
+
+    if (vkCreateDescriptorSetLayout(this->device.device(), &setLayoutInfo, nullptr, &this->frameSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Descriptor Set Layout!");
+
     VkPushConstantRange pushConstantRange         = { };
-    pushConstantRange.stageFlags                  =
-        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.stageFlags                  = VK_SHADER_STAGE_VERTEX_BIT;
     pushConstantRange.offset                      = 0;
     pushConstantRange.size                        = sizeof(PushConstantData);
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = VkPipelineLayoutCreateInfo();
     pipelineLayoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount             = 0;
-    pipelineLayoutInfo.pSetLayouts                = nullptr;
+    pipelineLayoutInfo.setLayoutCount             = 1;
+    pipelineLayoutInfo.pSetLayouts                = &this->frameSetLayout;
     pipelineLayoutInfo.pushConstantRangeCount     = 1;
     pipelineLayoutInfo.pPushConstantRanges        = &pushConstantRange;
 
@@ -47,45 +156,510 @@ RenderSystem::createPiplineLayout()
 }
 
 void
-RenderSystem::createPipeline(VkRenderPass renderPass)
+RenderSystem::createFrameData()
+{
+    const uint32_t frameCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+    VkDescriptorPoolSize poolSizes[2] = { };
+    poolSizes[0].type                 = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount      = frameCount;
+    poolSizes[1].type                 = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount      = frameCount;
+
+    VkDescriptorPoolCreateInfo poolInfo = { };
+    poolInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets                    = frameCount;
+    poolInfo.poolSizeCount              = 2;
+    poolInfo.pPoolSizes                 = poolSizes;
+
+    if (vkCreateDescriptorPool(this->device.device(), &poolInfo, nullptr, &this->descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Descriptor Pool!");
+
+    std::vector<VkDescriptorSetLayout> setLayouts(frameCount, this->frameSetLayout);
+    std::vector<VkDescriptorSet> sets(frameCount);
+
+    VkDescriptorSetAllocateInfo allocInfo = { };
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool              = this->descriptorPool;
+    allocInfo.descriptorSetCount          = frameCount;
+    allocInfo.pSetLayouts                 = setLayouts.data();
+
+    if (vkAllocateDescriptorSets(this->device.device(), &allocInfo, sets.data()) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Allocate Descriptor Sets!");
+
+    this->frames.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        FrameData& frame    = this->frames[i];
+        frame.descriptorSet = sets[i];
+
+        this->device.createBuffer(sizeof(CameraData),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.cameraBuffer,
+            frame.cameraMemory);
+
+        VkDescriptorBufferInfo cameraInfo = { frame.cameraBuffer, 0, sizeof(CameraData) };
+
+        VkWriteDescriptorSet write = { };
+        write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet               = frame.descriptorSet;
+        write.dstBinding           = 0;
+        write.descriptorCount      = 1;
+        write.descriptorType       = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        write.pBufferInfo          = &cameraInfo;
+
+        vkUpdateDescriptorSets(this->device.device(), 1, &write, 0, nullptr);
+
+        // Created up front, so the set is complete even for frames without objects
+        this->mapObjects(i, MIN_OBJECTS);
+    }
+}
+
+void
+RenderSystem::createPipeline()
 {
     assert(this->pipelineLayout != nullptr && "Cannot Create Pipeline Before Layout");
 
     PipelineConfigInfo config = PipelineConfigInfo();
     Pipeline::defaultPipelineConfig(config);
-    config.renderPass         = renderPass;
+    config.renderPass         = this->renderPass;
     config.pipelineLayout     = this->pipelineLayout;
-    this->pipeline            = std::make_unique<Pipeline>(this->device,
+
+    // constant_id of each feature in Vertex.vert and Fragment.frag
+    config.specialization.set(0, this->shaderFeatures.vertexColor);
+    config.specialization.set(1, this->shaderFeatures.lighting);
+    config.specialization.set(2, this->shaderFeatures.alphaTest);
+    config.specialization.set(3, this->shaderFeatures.alphaCutoff);
+
+    this->pipeline = std::make_unique<Pipeline>(this->device,
                                        "Assets/Shaders/Vertex.vert.spv",
                                        "Assets/Shaders/Fragment.frag.spv",
                                        config);
+
+    // Same shaders, with Vertex.vert compiled for Model::QuantizedVertex
+    config.bindingDescriptions   = Model::QuantizedVertex::getBindingDescriptions();
+    config.attributeDescriptions = Model::QuantizedVertex::getAttributeDescriptions();
+    this->quantizedPipeline      = std::make_unique<Pipeline>(this->device,
+                                       "Assets/Shaders/VertexQuantized.vert.spv",
+                                       "Assets/Shaders/Fragment.frag.spv",
+                                       config);
+}
+
+uint32_t
+RenderSystem::selectLod(const Model& model, const TransformComponent& transform, const glm::mat4& modelMatrix,
+                        const Camera& camera, float viewportHeight) const
+{
+    if (!this->lodSelection || model.getLodCount() == 1)
+        return 0;
+
+    // Bounding sphere in view space, with the error scaled as much as the transform scales anything
+    const Model::Bounds& bounds = model.getBounds();
+    const glm::vec3 scale       = glm::abs(transform.scale);
+    const float maxScale        = std::max({ scale.x, scale.y, scale.z });
+    const glm::vec4 center      = camera.getView() * (modelMatrix * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+    const float radius          = 0.5f * glm::length(bounds.max - bounds.min) * maxScale;
+
+    // Judge the whole object by its nearest point; full detail once the camera is inside the sphere
+    const float depth = center.z - radius;
+    if (depth <= 0.0f)
+        return 0;
+
+    const float pixelsPerUnit = camera.getPixelsPerUnit(depth, viewportHeight) * maxScale;
+    return model.selectLod(this->lodPixelError / pixelsPerUnit);
+}
+
+uint32_t
+RenderSystem::groupObjects(std::vector<Object>& objects, const Camera& camera, float viewportHeight)
+{
+    for (uint32_t i = 0; i < this->groupCount; i++)
+    {
+        for (auto& lod : this->groups[i].lods)
+            lod.clear();
+
+        for (auto& lod : this->groups[i].depths)
+            lod.clear();
+    }
+
+    this->groupCount = 0;
+    this->groupByModel.clear();
+
+    uint32_t objectCount = 0;
+    for (uint32_t i = 0; i < objects.size(); i++)
+    {
+        Object& object = objects[i];
+        if (!this->frustumCuller.isVisible(i))
+            continue;
+
+        // Still on its way through the transfer queue
+        if (!this->device.uploads().isAcquired(object.model->getUploadTicket()))
+        {
+            this->frameStats.streaming++;
+            continue;
+        }
+
+        auto found = this->groupByModel.emplace(object.model.get(), this->groupCount);
+        if (found.second)
+        {
+            if (this->groups.size() <= this->groupCount)
+                this->groups.emplace_back();
+
+            this->groups[this->groupCount].model = object.model.get();
+            this->groupCount++;
+        }
+
+        InstanceGroup& group = this->groups[found.first->second];
+
+        const auto modelMatrix = object.transform.mat4();
+        const uint32_t lod     = this->selectLod(*object.model, object.transform, modelMatrix, camera, viewportHeight);
+
+        if (group.lods.size() <= lod)
+        {
+            group.lods.resize(lod + 1);
+            group.depths.resize(lod + 1);
+        }
+
+        group.lods[lod].push_back({ modelMatrix, glm::vec4(object.color, object.alpha) });
+        group.depths[lod].push_back((camera.getView() * glm::vec4(object.transform.translation, 1.0f)).z);
+        objectCount++;
+    }
+
+    return objectCount;
+}
+
+void
+RenderSystem::setShaderFeatures(const ShaderFeatures& features, VkRenderPass renderPass)
+{
+    this->shaderFeatures = features;
+    this->renderPass     = renderPass;
+    this->createPipeline();
 }
 
 void
-RenderSystem::renderObjects(VkCommandBuffer commandBuffer, std::vector<Object>& objects, const Camera& camera)
+RenderSystem::setDrawPath(DrawPath drawPath)
 {
-    this->pipeline->bind(commandBuffer);
+    if (drawPath == DrawPath::GpuDriven && !this->supportsGpuDriven())
+        throw std::runtime_error("GPU-Driven Rendering Not Supported by Device!");
 
-    // TODO: Send `projectionView` Calculation to the GPU instead of CPU
-    auto projectionView = camera.getProjection() * camera.getView();
+    this->drawPath = drawPath;
+}
 
-    for (auto& object : objects)
+RenderSystem::ObjectData*
+RenderSystem::mapObjects(uint32_t frameIndex, uint32_t objectCount)
+{
+    // The frame's previous submission is done by now, so its buffer and set can be replaced
+    FrameData& frame = this->frames[frameIndex];
+    if (frame.objectCapacity < objectCount)
     {
-        PushConstantData push = { };
-        push.color            = object.color;
+        if (frame.objectBuffer != nullptr)
+            this->device.destroyBuffer(frame.objectBuffer, frame.objectMemory);
+
+        frame.objectCapacity = std::max({ objectCount, frame.objectCapacity * 2, MIN_OBJECTS });
+        this->device.createBuffer(frame.objectCapacity * sizeof(ObjectData),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            frame.objectBuffer,
+            frame.objectMemory);
+
+        VkDescriptorBufferInfo objectInfo = { frame.objectBuffer, 0, VK_WHOLE_SIZE };
 
-        // TODO: Send `transform` Calculation to the GPU instead of CPU
-        push.transform        = projectionView * object.transform.mat4();
+        VkWriteDescriptorSet write = { };
+        write.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet               = frame.descriptorSet;
+        write.dstBinding           = 1;
+        write.descriptorCount      = 1;
+        write.descriptorType       = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo          = &objectInfo;
+
+        vkUpdateDescriptorSets(this->device.device(), 1, &write, 0, nullptr);
+    }
+
+    return static_cast<ObjectData*>(frame.objectMemory.mapped);
+}
+
+uint32_t
+RenderSystem::planDraws()
+{
+    this->drawItems.clear();
+    this->drawQueue.clear();
+
+    // Objects have no materials yet, only per-instance colors
+    const uint32_t material = 0;
+    const bool instanced    = this->drawPath == DrawPath::Instanced;
+
+    uint32_t firstInstance = 0;
+    for (uint32_t i = 0; i < this->groupCount; i++)
+    {
+        const InstanceGroup& group = this->groups[i];
+        const uint32_t pipeline    = group.model->getVertexFormat() == Model::VertexFormat::Quantized ? 1 : 0;
+        const uint32_t model       = group.model->getGeometry();
+
+        for (uint32_t lod = 0; lod < group.lods.size(); lod++)
+        {
+            const uint32_t count = static_cast<uint32_t>(group.lods[lod].size());
+            if (count == 0)
+                continue;
+
+            const auto& depths = group.depths[lod];
+            if (instanced)
+            {
+                // Ordered by its nearest instance
+                const float depth = *std::min_element(depths.begin(), depths.end());
+                this->drawQueue.push(DrawQueue::makeKey(pipeline, material, model, depth), static_cast<uint32_t>(this->drawItems.size()));
+                this->drawItems.push_back({ i, lod, 0, firstInstance, count });
+            }
+            else
+            {
+                for (uint32_t instance = 0; instance < count; instance++)
+                {
+                    this->drawQueue.push(DrawQueue::makeKey(pipeline, material, model, depths[instance]), static_cast<uint32_t>(this->drawItems.size()));
+                    this->drawItems.push_back({ i, lod, instance, firstInstance + instance, 1 });
+                }
+            }
+
+            firstInstance += count;
+        }
+    }
+
+    this->drawQueue.sort();
+    return this->drawQueue.size();
+}
+
+void
+RenderSystem::recordDraws(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, ObjectData* objectData,
+                          uint32_t firstDraw, uint32_t lastDraw, FrameStats& stats) const
+{
+    // Both pipelines share the layout, so the descriptor set and push constants outlive pipeline
+    // binds. Models of one vertex format share the geometry pool's buffers
+    StateTracker state    = { commandBuffer, stats };
+    PushConstantData push = { };
+    uint32_t pushedGroup  = UINT32_MAX;
+
+    for (uint32_t i = firstDraw; i < lastDraw; i++)
+    {
+        const DrawItem& draw       = this->drawItems[this->drawQueue[i].draw];
+        const InstanceGroup& group = this->groups[draw.group];
+        Model& model               = *group.model;
+
+        const bool quantized = model.getVertexFormat() == Model::VertexFormat::Quantized;
+        state.bindPipeline(quantized ? *this->quantizedPipeline : *this->pipeline);
+        state.bindDescriptorSet(this->pipelineLayout, descriptorSet);
+        state.bindVertexBuffer(this->device.geometry().getVertexBuffer(model.getGeometry()));
+        state.bindIndexBuffer(this->device.geometry().getIndexBuffer());
+
+        // Draws of one model are next to each other in the queue
+        if (draw.group != pushedGroup)
+        {
+            push.positionOffset = model.getBounds().min;
+            push.positionScale  = model.getBounds().max - model.getBounds().min;
+            pushedGroup         = draw.group;
+
+            vkCmdPushConstants(
+                commandBuffer,
+                this->pipelineLayout,
+                VK_SHADER_STAGE_VERTEX_BIT,
+                0,
+                sizeof(PushConstantData),
+                &push);
+        }
+
+        const uint32_t lod = draw.lod;
+        memcpy(objectData + draw.firstInstance, group.lods[lod].data() + draw.first, draw.count * sizeof(ObjectData));
+
+        model.draw(commandBuffer, lod, draw.count, draw.firstInstance);
+
+        if (stats.lodDraws.size() <= lod)
+            stats.lodDraws.resize(lod + 1, 0);
+
+        stats.drawCalls++;
+        stats.objects             += draw.count;
+        stats.lodDraws[lod]       += draw.count;
+        stats.triangles           += static_cast<uint64_t>(draw.count) * (model.getLod(lod).indexCount / 3);
+        stats.fullDetailTriangles += static_cast<uint64_t>(draw.count) * (model.getLod(0).indexCount / 3);
+    }
+}
+
+void
+RenderSystem::setParallelRecording(bool enabled)
+{
+    if (enabled && this->parallelRecorder == nullptr)
+        this->parallelRecorder = std::make_unique<ParallelRecorder>(this->device);
+
+    this->parallelRecording = enabled;
+}
+
+uint32_t
+RenderSystem::getRecordingThreads() const
+{
+    return this->isRecordingParallel() ? this->parallelRecorder->getWorkerCount() : 1;
+}
+
+VkSubpassContents
+RenderSystem::getSubpassContents() const
+{
+    return this->isRecordingParallel() ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+}
+
+void
+RenderSystem::writeCamera(uint32_t frameIndex, const Camera& camera, float viewportHeight)
+{
+    CameraData cameraData     = { };
+    cameraData.projection     = camera.getProjection();
+    cameraData.view           = camera.getView();
+    cameraData.projectionView = cameraData.projection * cameraData.view;
+
+    const auto planes = camera.getFrustumPlanes();
+    std::copy(planes.begin(), planes.end(), cameraData.frustumPlanes);
+
+    cameraData.lod = glm::vec4(this->lodPixelError,
+                               camera.getPixelsPerUnit(1.0f, viewportHeight),
+                               camera.isPerspective() ? 1.0f : 0.0f,
+                               this->lodSelection ? 1.0f : 0.0f);
+
+    memcpy(this->frames[frameIndex].cameraMemory.mapped, &cameraData, sizeof(cameraData));
+}
+
+void
+RenderSystem::cullObjects(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<Object>& objects, const Camera& camera, const RenderPassTarget& target)
+{
+    if (this->drawPath != DrawPath::GpuDriven)
+        return;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    this->writeCamera(frameIndex, camera, static_cast<float>(target.extent.height));
+    this->gpuCulling->cull(commandBuffer,
+        frameIndex,
+        objects,
+        this->isOcclusionCulling() ? GpuCulling::Phase::Early : GpuCulling::Phase::All,
+        target.extent);
+
+    const auto end         = std::chrono::high_resolution_clock::now();
+    this->cullMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+RenderSystem::cullOccluded(VkCommandBuffer commandBuffer, uint32_t frameIndex, const RenderPassTarget& target)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    transitionDepth(commandBuffer, target, true);
+    this->gpuCulling->cullOccluded(commandBuffer, frameIndex, target.depthView);
+    transitionDepth(commandBuffer, target, false);
+
+    const auto end                    = std::chrono::high_resolution_clock::now();
+    this->frameStats.cpuMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+RenderSystem::renderOccluded(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // Late's draws in the same buffers, so the commands are those of the first pass
+    this->drawCulled(commandBuffer, frameIndex);
+
+    const auto end                    = std::chrono::high_resolution_clock::now();
+    this->frameStats.cpuMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+RenderSystem::drawCulled(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    const GpuCulling::Result& culled = this->gpuCulling->getResult(frameIndex);
+
+    // Cull.comp folds the decoding of quantized positions into each transform
+    PushConstantData push = { };
+    push.positionScale    = glm::vec3(1.0f);
+    StateTracker state    = { commandBuffer, this->frameStats };
+
+    Pipeline* pipelines[GpuCulling::PIPELINE_COUNT] = { this->pipeline.get(), this->quantizedPipeline.get() };
+    for (uint32_t i = 0; i < GpuCulling::PIPELINE_COUNT; i++)
+    {
+        if (culled.pipelineModels[i] == nullptr)
+            continue;
+
+        state.bindPipeline(*pipelines[i]);
+        state.bindDescriptorSet(this->pipelineLayout, culled.drawSet);
+        state.bindVertexBuffer(this->device.geometry().getVertexBuffer(culled.pipelineModels[i]->getGeometry()));
+        state.bindIndexBuffer(this->device.geometry().getIndexBuffer());
 
         vkCmdPushConstants(
             commandBuffer,
             this->pipelineLayout,
-            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            VK_SHADER_STAGE_VERTEX_BIT,
             0,
             sizeof(PushConstantData),
             &push);
 
-        object.model->bind(commandBuffer);
-        object.model->draw(commandBuffer);
+        this->gpuCulling->draw(commandBuffer, frameIndex, i);
+        this->frameStats.drawCalls++;
+    }
+}
+
+void
+RenderSystem::renderObjects(VkCommandBuffer commandBuffer, uint32_t frameIndex, std::vector<Object>& objects, const Camera& camera, const RenderPassTarget& target)
+{
+    const auto start           = std::chrono::high_resolution_clock::now();
+    const float viewportHeight = static_cast<float>(target.extent.height);
+    this->frameStats.reset();
+
+    if (this->drawPath == DrawPath::GpuDriven)
+    {
+        // Culled by cullObjects; the GPU decides what is drawn, at which LOD
+        const GpuCulling::Result& culled = this->gpuCulling->getResult(frameIndex);
+        this->frameStats.objects         = culled.objectCount;
+        this->frameStats.streaming       = culled.streaming;
+        this->frameStats.occluded        = culled.occluded;
+
+        this->drawCulled(commandBuffer, frameIndex);
+
+        const auto end                   = std::chrono::high_resolution_clock::now();
+        this->frameStats.cpuMilliseconds = this->cullMilliseconds + std::chrono::duration<double, std::milli>(end - start).count();
+        return;
     }
+
+    // Timed with the sync, which only reads the objects that are new or moved
+    const auto cullStart              = std::chrono::high_resolution_clock::now();
+    this->frustumCuller.sync(objects);
+    const uint32_t visible            = this->frustumCuller.cull(camera.getFrustumPlanes());
+    const auto cullEnd                = std::chrono::high_resolution_clock::now();
+    this->frameStats.culled           = static_cast<uint32_t>(objects.size()) - visible;
+    this->frameStats.cullMilliseconds = std::chrono::duration<double, std::milli>(cullEnd - cullStart).count();
+
+    const uint32_t objectCount = this->groupObjects(objects, camera, viewportHeight);
+    if (objectCount > 0)
+    {
+        ObjectData* objectData = this->mapObjects(frameIndex, objectCount);
+        FrameData& frame       = this->frames[frameIndex];
+
+        this->writeCamera(frameIndex, camera, viewportHeight);
+
+        const uint32_t drawCount = this->planDraws();
+        if (this->isRecordingParallel())
+        {
+            // Contiguous ranges of the sorted draws, so each worker's binds stay few
+            const uint32_t workers  = this->parallelRecorder->getWorkerCount();
+            const uint32_t jobCount = std::clamp((drawCount + MIN_DRAWS_PER_WORKER - 1) / MIN_DRAWS_PER_WORKER, 1u, workers);
+
+            this->workerStats.resize(jobCount);
+            for (auto& stats : this->workerStats)
+                stats.reset();
+
+            this->parallelRecorder->record(commandBuffer, frameIndex, jobCount, target, [&](uint32_t worker, VkCommandBuffer secondary) {
+                const uint32_t firstDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * worker / jobCount);
+                const uint32_t lastDraw  = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * (worker + 1) / jobCount);
+
+                this->recordDraws(secondary, frame.descriptorSet, objectData, firstDraw, lastDraw, this->workerStats[worker]);
+            });
+
+            for (const auto& stats : this->workerStats)
+                addDrawStats(this->frameStats, stats);
+        }
+        else
+            this->recordDraws(commandBuffer, frame.descriptorSet, objectData, 0, drawCount, this->frameStats);
+    }
+
+    const auto end                   = std::chrono::high_resolution_clock::now();
+    this->frameStats.cpuMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
 }
\ No newline at end of file
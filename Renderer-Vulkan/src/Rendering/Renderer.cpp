@@ -13,6 +13,7 @@ Renderer::Renderer(Window& window, Device& device)
 
 Renderer::~Renderer()
 {
+    this->capture.reset();
     freeCommandBuffers();
 }
 
@@ -42,7 +43,8 @@ Renderer::recreateSwapChain()
 {
     auto extent = this->window.getExtent();
 
-    while (extent.width == 0 || extent.height == 0)
+    // Minimized, so wait for a size; headless has a fixed one and no GLFW to wait on
+    while (!this->window.isHeadless() && (extent.width == 0 || extent.height == 0))
     {
         extent = this->window.getExtent();
         glfwWaitEvents();
@@ -50,11 +52,12 @@ Renderer::recreateSwapChain()
 
     vkDeviceWaitIdle(this->device.device());
     if (this->swapChain == nullptr)
-        this->swapChain = std::make_unique<SwapChain>(this->device, extent);
+        this->swapChain = std::make_unique<SwapChain>(this->device, extent, this->presentModes);
     else
     {
         std::shared_ptr<SwapChain> oldSwapChain = std::move(this->swapChain);
-        this->swapChain = std::make_unique<SwapChain>(this->device, extent, oldSwapChain);
+        this->swapChain = std::make_unique<SwapChain>(this->device, extent, this->presentModes, oldSwapChain);
+        this->swapChainRecreations++;
 
         if (!oldSwapChain->compareSwapFormat(*this->swapChain.get()))
             throw std::runtime_error("Swap Chain Image (or Depth) Format has Changed");
@@ -68,6 +71,10 @@ Renderer::beginFrame()
     
     auto result = this->swapChain->acquireNextImage(&this->currentImageIndex);
 
+    // The frame's fence has signalled, so its last capture can be read
+    if (this->capture)
+        this->capture->collect(this->currentFrameIndex);
+
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
         this->recreateSwapChain();
@@ -86,6 +93,9 @@ Renderer::beginFrame()
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
         throw std::runtime_error("Failed to Begin Recording Command Buffer!");
 
+    // Takes over buffers the transfer queue finished with, before any draw reads them
+    this->uploadWaitValue = this->device.uploads().acquire(commandBuffer);
+
     return commandBuffer;
 }
 
@@ -95,10 +105,20 @@ Renderer::endFrame()
     assert(this->isFrameStarted && "Can't Call endFrame While Frame is not in Progress");
     auto commandBuffer = this->getCurrentCommandBuffer();
 
+    if (this->capture)
+    {
+        this->capture->record(commandBuffer,
+            this->currentFrameIndex,
+            this->swapChain->getImage(this->currentImageIndex),
+            this->swapChain->getFinalLayout(),
+            this->swapChain->getSwapChainImageFormat(),
+            this->swapChain->getSwapChainExtent());
+    }
+
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
         throw std::runtime_error("Failed to Record Command Buffer!");
 
-    auto result = this->swapChain->submitCommandBuffers(&commandBuffer, &this->currentImageIndex);
+    auto result = this->swapChain->submitCommandBuffers(&commandBuffer, &this->currentImageIndex, this->uploadWaitValue);
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR ||
         result == VK_SUBOPTIMAL_KHR ||
@@ -115,7 +135,7 @@ Renderer::endFrame()
 }
 
 void
-Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer)
+Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents, SwapChain::Pass pass)
 {
     assert(this->isFrameStarted && "Can't Call beginSwapChainRenderPass if Frame is not in Progress");
     assert(commandBuffer == this->getCurrentCommandBuffer() &&
@@ -123,7 +143,7 @@ Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer)
 
     VkRenderPassBeginInfo renderPassInfo    = VkRenderPassBeginInfo();
     renderPassInfo.sType                    = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass               = this->swapChain->getRenderPass();
+    renderPassInfo.renderPass               = this->swapChain->getRenderPass(pass);
     renderPassInfo.framebuffer              = this->swapChain->getFrameBuffer(this->currentImageIndex);
     renderPassInfo.renderArea.offset        = { 0, 0 };
     renderPassInfo.renderArea.extent        = this->swapChain->getSwapChainExtent();
@@ -134,17 +154,24 @@ Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer)
     renderPassInfo.clearValueCount          = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues             = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+
+    if (contents == VK_SUBPASS_CONTENTS_INLINE)
+        setViewport(commandBuffer, this->swapChain->getSwapChainExtent());
+}
 
+void
+Renderer::setViewport(VkCommandBuffer commandBuffer, VkExtent2D extent)
+{
     VkViewport viewport = { };
     viewport.x          = 0.0f;
     viewport.y          = 0.0f;
-    viewport.width      = static_cast<float>(this->swapChain->getSwapChainExtent().width);
-    viewport.height     = static_cast<float>(this->swapChain->getSwapChainExtent().height);
+    viewport.width      = static_cast<float>(extent.width);
+    viewport.height     = static_cast<float>(extent.height);
     viewport.minDepth   = 0.0f;
     viewport.maxDepth   = 1.0f;
 
-    VkRect2D scissor    = { { 0, 0 }, this->swapChain->getSwapChainExtent() };
+    VkRect2D scissor    = { { 0, 0 }, extent };
 
     vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
@@ -166,12 +193,34 @@ Renderer::getSwapChainRenderPass() const
     return this->swapChain->getRenderPass();
 }
 
+RenderPassTarget
+Renderer::getRenderPassTarget() const
+{
+    assert(this->isFrameStarted && "Cannot Get Render Pass Target when Frame not in Progress");
+
+    RenderPassTarget target = { };
+    target.renderPass       = this->swapChain->getRenderPass();
+    target.framebuffer      = this->swapChain->getFrameBuffer(this->currentImageIndex);
+    target.extent           = this->swapChain->getSwapChainExtent();
+    target.depthImage       = this->swapChain->getDepthImage(this->currentImageIndex);
+    target.depthView        = this->swapChain->getDepthImageView(this->currentImageIndex);
+    target.depthAspect      = this->swapChain->getDepthAspect();
+
+    return target;
+}
+
 float
 Renderer::getAspectRatio() const
 {
     return this->swapChain->extentAspectRatio();
 }
 
+VkExtent2D
+Renderer::getSwapChainExtent() const
+{
+    return this->swapChain->getSwapChainExtent();
+}
+
 bool
 Renderer::isFrameInProgress() const
 {
@@ -190,4 +239,84 @@ uint32_t Renderer::getFrameIndex() const
 {
     assert(this->isFrameStarted && "Cannot Get Frame Index when Frame not in Progress");
     return this->currentFrameIndex;
+}
+
+void
+Renderer::startCapture(const std::string& directory, FrameCapture::Format format)
+{
+    assert(!this->isFrameStarted && "Can't Start Capturing While Frame is in Progress");
+
+    if (!this->swapChain->canCopyImages())
+        throw std::runtime_error("Swap Chain Images Cannot be Copied for Capture!");
+
+    this->capture = std::make_unique<FrameCapture>(this->device, directory, format, SwapChain::MAX_FRAMES_IN_FLIGHT);
+}
+
+CaptureStats
+Renderer::stopCapture()
+{
+    assert(!this->isFrameStarted && "Can't Stop Capturing While Frame is in Progress");
+
+    if (!this->capture)
+        return { };
+
+    this->capture->finish();
+    const CaptureStats stats = this->capture->getStats();
+    this->capture.reset();
+
+    return stats;
+}
+
+bool
+Renderer::isCapturing() const
+{
+    return this->capture != nullptr;
+}
+
+void
+Renderer::setPresentModes(const std::vector<VkPresentModeKHR>& modes)
+{
+    assert(!this->isFrameStarted && "Can't Change Present Mode While Frame is in Progress");
+
+    if (modes == this->presentModes)
+        return;
+
+    this->presentModes = modes;
+
+    // Offscreen images are never presented, so there is nothing to recreate
+    if (!this->device.isHeadless())
+        this->recreateSwapChain();
+}
+
+void
+Renderer::setPresentProfile(SwapChain::PresentProfile profile)
+{
+    this->setPresentModes(SwapChain::getPresentModes(profile));
+}
+
+VkPresentModeKHR
+Renderer::getPresentMode() const
+{
+    return this->swapChain->getPresentMode();
+}
+
+PresentStats
+Renderer::getPresentStats() const
+{
+    PresentStats stats = { };
+    stats.headless     = this->device.isHeadless();
+    stats.recreations  = this->swapChainRecreations;
+
+    if (stats.headless)
+        return stats;
+
+    stats.mode = SwapChain::getPresentModeName(this->swapChain->getPresentMode());
+
+    for (auto mode : this->presentModes)
+        stats.requested.push_back(SwapChain::getPresentModeName(mode));
+
+    for (auto mode : this->swapChain->getAvailablePresentModes())
+        stats.supported.push_back(SwapChain::getPresentModeName(mode));
+
+    return stats;
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include <Rendering/StateTracker.hpp>
+
+StateTracker::StateTracker(VkCommandBuffer commandBuffer, FrameStats& stats) :
+    commandBuffer(commandBuffer),
+    stats(stats)
+{ }
+
+void
+StateTracker::bindPipeline(Pipeline& pipeline)
+{
+    if (this->pipeline == &pipeline)
+    {
+        this->stats.bindsAvoided++;
+        return;
+    }
+
+    pipeline.bind(this->commandBuffer);
+    this->pipeline = &pipeline;
+    this->stats.stateBinds++;
+}
+
+void
+StateTracker::bindDescriptorSet(VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet)
+{
+    if (this->descriptorSet == descriptorSet)
+    {
+        this->stats.bindsAvoided++;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(this->commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        0, 1, &descriptorSet,
+        0, nullptr);
+
+    this->descriptorSet = descriptorSet;
+    this->stats.stateBinds++;
+}
+
+void
+StateTracker::bindVertexBuffer(VkBuffer vertexBuffer)
+{
+    if (this->vertexBuffer == vertexBuffer)
+    {
+        this->stats.bindsAvoided++;
+        return;
+    }
+
+    const VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(this->commandBuffer, 0, 1, &vertexBuffer, &offset);
+
+    this->vertexBuffer = vertexBuffer;
+    this->stats.stateBinds++;
+    this->stats.geometryBinds++;
+}
+
+void
+StateTracker::bindIndexBuffer(VkBuffer indexBuffer)
+{
+    // Models without indices draw with vkCmdDraw
+    if (indexBuffer == nullptr)
+        return;
+
+    if (this->indexBuffer == indexBuffer)
+    {
+        this->stats.bindsAvoided++;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(this->commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+    this->indexBuffer = indexBuffer;
+    this->stats.stateBinds++;
+    this->stats.geometryBinds++;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include <ShaderBenchmark.hpp>
+
+ShaderBenchmark::ShaderBenchmark(std::shared_ptr<Model> model) :
+    model(std::move(model))
+{ }
+
+std::vector<RenderSystem::ShaderFeatures>
+ShaderBenchmark::variants()
+{
+    // The bare variant first, each feature on its own, then all of them
+    std::vector<RenderSystem::ShaderFeatures> variants = { };
+
+    RenderSystem::ShaderFeatures features = { };
+    features.vertexColor                  = false;
+    variants.push_back(features);
+
+    features.vertexColor = true;
+    variants.push_back(features);
+
+    features.vertexColor = false;
+    features.lighting    = true;
+    variants.push_back(features);
+
+    features.lighting    = false;
+    features.alphaTest   = true;
+    variants.push_back(features);
+
+    features.vertexColor = true;
+    features.lighting    = true;
+    variants.push_back(features);
+
+    return variants;
+}
+
+void
+ShaderBenchmark::layoutObjects(std::vector<Object>& objects) const
+{
+    objects.clear();
+    objects.reserve(LAYERS);
+
+    const Model::Bounds& bounds = this->model->getBounds();
+    const float diagonal        = glm::length(bounds.max - bounds.min);
+    const float scale           = diagonal > 0.0f ? 4.0f / diagonal : 1.0f;
+    const glm::vec3 center      = (bounds.min + bounds.max) * 0.5f;
+
+    // Stacked along the view axis, each wider than the screen at its depth
+    for (uint32_t i = 0; i < LAYERS; i++)
+    {
+        auto object                  = Object::createObject();
+        object.model                 = this->model;
+        object.color                 = { 0.1f, 0.8f, 0.1f };
+        object.alpha                 = i % 2 == 0 ? CUTOUT_ALPHA : 1.0f;
+        object.transform.scale       = { scale, scale, scale };
+        object.transform.translation = glm::vec3(0.0f, 0.0f, 1.0f + static_cast<float>(i) * LAYER_SPACING) - center * scale;
+
+        objects.push_back(std::move(object));
+    }
+}
+
+void
+ShaderBenchmark::beginStep(const RenderSystem::ShaderFeatures& features, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    renderSystem.setShaderFeatures(features, renderPass);
+
+    this->current          = { };
+    this->current.features = features;
+    this->elapsed          = 0.0f;
+}
+
+void
+ShaderBenchmark::begin(std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->steps.clear();
+
+    renderSystem.setDrawPath(RenderSystem::DrawPath::Instanced);
+    renderSystem.setLodSelection(false);
+    this->beginStep(variants().front(), renderSystem, renderPass);
+    this->layoutObjects(objects);
+}
+
+bool
+ShaderBenchmark::update(float frameTime, const FrameStats& stats, std::vector<Object>& objects, RenderSystem& renderSystem, VkRenderPass renderPass)
+{
+    this->elapsed += frameTime;
+    if (this->elapsed > WARMUP_SECONDS)
+    {
+        this->current.frames++;
+        this->current.seconds += frameTime;
+    }
+
+    if (this->elapsed < WARMUP_SECONDS + MEASURE_SECONDS)
+        return true;
+
+    this->steps.push_back(this->current);
+
+    const std::vector<RenderSystem::ShaderFeatures> all = variants();
+    if (this->steps.size() == all.size())
+        return false;
+
+    this->beginStep(all[this->steps.size()], renderSystem, renderPass);
+    return true;
+}
+
+void
+ShaderBenchmark::setCamera(Camera& camera, float aspect) const
+{
+    camera.setViewTarget(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    camera.setPerspectiveProjection(glm::radians(55.0f), aspect, 0.1f, 2.0f + LAYERS * LAYER_SPACING);
+}
+
+std::string
+ShaderBenchmark::stepName(const Step& step)
+{
+    std::string name = { };
+    if (step.features.vertexColor)
+        name += " vertex color";
+
+    if (step.features.lighting)
+        name += " lighting";
+
+    if (step.features.alphaTest)
+        name += " alpha test";
+
+    return name.empty() ? "bare" : name.substr(1);
+}
+
+void
+ShaderBenchmark::print(std::ostream& out) const
+{
+    out << "Shader benchmark:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    const double bare = this->steps.empty() ? 0.0 : 1000.0 * this->steps[0].seconds / std::max(this->steps[0].frames, 1u);
+    for (const auto& step : this->steps)
+    {
+        const double milliseconds = 1000.0 * step.seconds / std::max(step.frames, 1u);
+
+        out << "\t" << LAYERS << " layers, " << stepName(step) << ": " << milliseconds << " ms/frame";
+        if (bare > 0.0 && &step != &this->steps.front())
+            out << ", " << 100.0 * (milliseconds - bare) / bare << "% over bare";
+
+        out << std::endl;
+    }
+
+    out << std::defaultfloat;
+}
\ No newline at end of file
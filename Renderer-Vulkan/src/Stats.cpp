@@ -0,0 +1,204 @@
+#include <iomanip>
+
+#include <Stats.hpp>
+
+void
+FrameStats::reset()
+{
+    this->objects             = 0;
+    this->streaming           = 0;
+    this->culled              = 0;
+    this->occluded            = 0;
+    this->geometryBinds       = 0;
+    this->stateBinds          = 0;
+    this->bindsAvoided        = 0;
+    this->drawCalls           = 0;
+    this->cpuMilliseconds     = 0.0;
+    this->cullMilliseconds    = 0.0;
+    this->triangles           = 0;
+    this->fullDetailTriangles = 0;
+    this->lodDraws.clear();
+}
+
+void
+StartupStats::print(std::ostream& out) const
+{
+    double coldMilliseconds = 0.0;
+    double warmMilliseconds = 0.0;
+    size_t warmCount        = 0;
+
+    out << "Startup stats:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    for (const auto& load : this->modelLoads)
+    {
+        out << "\tmodel " << load.filePath << ": " << (load.streamed ? "streamed" : load.warm ? "warm" : "cold")
+            << " " << load.milliseconds << " ms" << std::endl;
+
+        out << "\t\tvertices " << load.vertexBytes / 1024.0 << " KiB " << (load.quantized ? "quantized" : "float") << std::endl;
+
+        if (load.optimized)
+        {
+            out << "\t\tvertex cache ACMR " << load.cacheBefore.acmr << " -> " << load.cacheAfter.acmr
+                << ", ATVR " << load.cacheBefore.atvr << " -> " << load.cacheAfter.atvr << std::endl;
+        }
+
+        if (load.lodTriangles.size() > 1)
+        {
+            out << "\t\tLODs";
+            for (const auto triangles : load.lodTriangles)
+                out << " " << triangles;
+
+            out << " triangles, coarsest error " << std::setprecision(4) << load.lodError << std::setprecision(2) << std::endl;
+        }
+
+        if (load.warm)
+        {
+            warmMilliseconds += load.milliseconds;
+            warmCount++;
+        }
+        else
+            coldMilliseconds += load.milliseconds;
+    }
+
+    out << "\tmodels cold: " << this->modelLoads.size() - warmCount << " in " << coldMilliseconds << " ms, "
+        << "warm: " << warmCount << " in " << warmMilliseconds << " ms" << std::endl;
+
+    coldMilliseconds = 0.0;
+    warmMilliseconds = 0.0;
+    warmCount        = 0;
+
+    for (const auto& creation : this->pipelineCreations)
+    {
+        out << "\tpipeline " << creation.shaderPath << ": " << (creation.warm ? "warm" : "cold")
+            << " " << creation.milliseconds << " ms" << std::endl;
+
+        if (creation.warm)
+        {
+            warmMilliseconds += creation.milliseconds;
+            warmCount++;
+        }
+        else
+            coldMilliseconds += creation.milliseconds;
+    }
+
+    if (!this->pipelineCreations.empty())
+    {
+        out << "\tpipelines cold: " << this->pipelineCreations.size() - warmCount << " in " << coldMilliseconds << " ms, "
+            << "warm: " << warmCount << " in " << warmMilliseconds << " ms" << std::endl;
+
+        out << "\tpipelines " << this->pipelineRequests << " requested, " << this->pipelineCreations.size() << " created on "
+            << this->pipelineThreads << " threads, ready in " << this->pipelineMilliseconds << " ms" << std::endl;
+    }
+
+    out << std::defaultfloat;
+}
+
+void
+MemoryStats::print(std::ostream& out) const
+{
+    constexpr double MIB = 1024.0 * 1024.0;
+
+    out << "Memory stats:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    for (size_t i = 0; i < this->heaps.size(); i++)
+    {
+        const Heap& heap = this->heaps[i];
+        if (heap.blockCount == 0 && heap.dedicatedCount == 0)
+            continue;
+
+        out << "\theap " << i << (heap.deviceLocal ? " (device local)" : "") << ": "
+            << heap.usedBytes / MIB << " of " << heap.blockBytes / MIB << " MiB used in " << heap.blockCount << " blocks, "
+            << heap.dedicatedBytes / MIB << " MiB in " << heap.dedicatedCount << " dedicated, heap " << heap.size / MIB << " MiB" << std::endl;
+    }
+
+    out << "\tallocations: " << this->allocationCount << " live of " << this->maxAllocationCount << ", "
+        << this->allocateCalls << " vkAllocateMemory calls" << std::endl;
+
+    out << std::defaultfloat;
+}
+
+void
+UploadStats::print(std::ostream& out) const
+{
+    constexpr double MIB = 1024.0 * 1024.0;
+
+    out << "Upload stats:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    out << "\t" << this->uploads << " uploads, " << this->bytes / MIB << " MiB in "
+        << this->regions << " copy regions over " << this->batches << " submissions on the "
+        << (this->dedicatedQueue ? "dedicated transfer" : "graphics") << " queue" << std::endl;
+
+    if (this->dedicatedQueue)
+        out << "\t" << this->ownershipTransfers << " buffers released to the graphics queue family" << std::endl;
+
+    out << "\t" << this->stalls << " ring stalls, " << this->waits << " ticket waits" << std::endl;
+
+    out << std::defaultfloat;
+}
+
+void
+GeometryStats::print(std::ostream& out) const
+{
+    constexpr double MIB = 1024.0 * 1024.0;
+
+    out << "Geometry stats:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    for (const auto& arena : this->arenas)
+    {
+        if (arena.capacity == 0)
+            continue;
+
+        out << "\t" << (arena.indices ? "indices" : "vertices") << " (" << arena.stride << " bytes): "
+            << arena.used / MIB << " of " << arena.capacity / MIB << " MiB used" << std::endl;
+    }
+
+    out << "\t" << this->liveRanges << " models in one pool, " << this->compactions << " compactions" << std::endl;
+
+    out << std::defaultfloat;
+}
+
+void
+CaptureStats::print(std::ostream& out) const
+{
+    constexpr double MIB = 1024.0 * 1024.0;
+
+    out << "Capture stats:" << std::endl;
+    out << std::fixed << std::setprecision(2);
+
+    out << "\t" << this->frames << " frames, " << this->bytes / MIB << " MiB read back, "
+        << this->written << " written" << std::endl;
+
+    const double perFrame = this->frames > 0 ? this->renderMilliseconds / this->frames : 0.0;
+    out << "\t" << this->renderMilliseconds << " ms on the render thread (" << perFrame << " ms per frame), "
+        << this->writeMilliseconds << " ms writing, " << this->stalls << " stalls" << std::endl;
+
+    out << std::defaultfloat;
+}
+
+void
+PresentStats::print(std::ostream& out) const
+{
+    out << "Present stats:" << std::endl;
+
+    if (this->headless)
+    {
+        out << "\theadless, rendering offscreen" << std::endl;
+        return;
+    }
+
+    auto join = [](const std::vector<std::string>& names)
+    {
+        std::string joined = "";
+        for (const auto& name : names)
+            joined += (joined.empty() ? "" : ", ") + name;
+
+        return joined;
+    };
+
+    out << "\t" << this->mode << " (requested " << join(this->requested) << "; supported " << join(this->supported) << ")" << std::endl;
+    out << "\t" << this->recreations << " swap chain recreations" << std::endl;
+}
\ No newline at end of file
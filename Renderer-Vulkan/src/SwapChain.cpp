@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <cstring>
@@ -8,14 +9,14 @@
 
 #include <SwapChain.hpp>
 
-SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent)
-    : device(deviceRef), windowExtent(extent)
+SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent, const std::vector<VkPresentModeKHR>& presentModes)
+    : presentModes(presentModes), device(deviceRef), windowExtent(extent)
 {
     this->init();
 }
 
-SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent, std::shared_ptr<SwapChain> previous)
-    : device(deviceRef), windowExtent(extent), oldSwapChain(previous)
+SwapChain::SwapChain(Device& deviceRef, VkExtent2D extent, const std::vector<VkPresentModeKHR>& presentModes, std::shared_ptr<SwapChain> previous)
+    : presentModes(presentModes), device(deviceRef), windowExtent(extent), oldSwapChain(previous)
 {
     this->init();
 
@@ -35,17 +36,23 @@ SwapChain::~SwapChain()
         swapChain = nullptr;
     }
 
+    for (int i = 0; i < offscreenMemorys.size(); i++)
+        device.destroyImage(swapChainImages[i], offscreenMemorys[i]);
+
     for (int i = 0; i < depthImages.size(); i++)
     {
         vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-        vkDestroyImage(device.device(), depthImages[i], nullptr);
-        vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+        device.destroyImage(depthImages[i], depthImageMemorys[i]);
     }
 
     for (auto framebuffer : swapChainFramebuffers)
         vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
 
-    vkDestroyRenderPass(device.device(), renderPass, nullptr);
+    for (auto renderPass : renderPasses)
+    {
+        device.pipelines().removeRenderPass(renderPass);
+        vkDestroyRenderPass(device.device(), renderPass, nullptr);
+    }
 
     // cleanup synchronization objects
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
@@ -66,6 +73,13 @@ SwapChain::acquireNextImage(uint32_t* imageIndex)
         VK_TRUE,
         std::numeric_limits<uint64_t>::max());
 
+    // Offscreen there is an image per frame in flight, which the fence above has freed
+    if (device.isHeadless())
+    {
+        *imageIndex = static_cast<uint32_t>(currentFrame);
+        return VK_SUCCESS;
+    }
+
     return vkAcquireNextImageKHR(
         device.device(),
         swapChain,
@@ -76,7 +90,7 @@ SwapChain::acquireNextImage(uint32_t* imageIndex)
 }
 
 VkResult
-SwapChain::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex)
+SwapChain::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex, uint64_t uploadWaitValue)
 {
     if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE)
         vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
@@ -86,23 +100,41 @@ SwapChain::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageI
     VkSubmitInfo submitInfo           = { };
     submitInfo.sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[]      = { imageAvailableSemaphores[currentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount     = 1;
-    submitInfo.pWaitSemaphores        = waitSemaphores;
-    submitInfo.pWaitDstStageMask      = waitStages;
+    // Headless, nothing was acquired and nothing is presented, so only uploads are waited for
+    const bool headless               = device.isHeadless();
+    const uint32_t firstWait          = headless ? 1 : 0;
+
+    VkSemaphore waitSemaphores[]      = { imageAvailableSemaphores[currentFrame], device.uploads().timelineSemaphore() };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
+    submitInfo.waitSemaphoreCount     = (uploadWaitValue > 0 ? 2 : 1) - firstWait;
+    submitInfo.pWaitSemaphores        = waitSemaphores + firstWait;
+    submitInfo.pWaitDstStageMask      = waitStages + firstWait;
+
+    // Binary semaphores ignore their value
+    const uint64_t waitValues[]                = { 0, uploadWaitValue };
+    VkTimelineSemaphoreSubmitInfo timelineInfo = { };
+    timelineInfo.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount       = submitInfo.waitSemaphoreCount;
+    timelineInfo.pWaitSemaphoreValues          = waitValues + firstWait;
+    submitInfo.pNext                           = uploadWaitValue > 0 ? &timelineInfo : nullptr;
 
     submitInfo.commandBufferCount     = 1;
     submitInfo.pCommandBuffers        = buffers;
 
     VkSemaphore signalSemaphores[]    = { renderFinishedSemaphores[currentFrame] };
-    submitInfo.signalSemaphoreCount   = 1;
+    submitInfo.signalSemaphoreCount   = headless ? 0 : 1;
     submitInfo.pSignalSemaphores      = signalSemaphores;
 
     vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
     if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS)
         throw std::runtime_error("failed to submit draw command buffer!");
 
+    if (headless)
+    {
+        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        return VK_SUCCESS;
+    }
+
     VkPresentInfoKHR presentInfo   = { };
     presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
@@ -119,6 +151,13 @@ SwapChain::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageI
     return vkQueuePresentKHR(device.presentQueue(), &presentInfo);
 }
 
+VkImageLayout
+SwapChain::getFinalLayout() const
+{
+    // Offscreen images are left ready to be copied out instead
+    return device.isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
 bool SwapChain::compareSwapFormat(const SwapChain& swapChain) const
 {
     return swapChain.swapChainDepthFormat == this->swapChainDepthFormat &&
@@ -128,7 +167,11 @@ bool SwapChain::compareSwapFormat(const SwapChain& swapChain) const
 void
 SwapChain::init()
 {
-    this->createSwapChain();
+    if (device.isHeadless())
+        this->createOffscreenImages();
+    else
+        this->createSwapChain();
+
     this->createImageViews();
     this->createRenderPass();
     this->createDepthResources();
@@ -141,7 +184,8 @@ SwapChain::createSwapChain()
 {
     SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
     VkSurfaceFormatKHR surfaceFormat         = chooseSwapSurfaceFormat(swapChainSupport.formats);
-    VkPresentModeKHR presentMode             = chooseSwapPresentMode(swapChainSupport.presentModes);
+    availablePresentModes                    = swapChainSupport.presentModes;
+    presentMode                              = chooseSwapPresentMode(swapChainSupport.presentModes);
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
     uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
@@ -157,7 +201,9 @@ SwapChain::createSwapChain()
     createInfo.imageColorSpace           = surfaceFormat.colorSpace;
     createInfo.imageExtent               = extent;
     createInfo.imageArrayLayers          = 1;
-    createInfo.imageUsage                = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Copied out by FrameCapture, where the surface allows it
+    createInfo.imageUsage                = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+        (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
 
     QueueFamilyIndices indices           = device.findPhysicalQueueFamilies();
     uint32_t queueFamilyIndices[]        = { indices.graphicsFamily, indices.presentFamily };
@@ -195,9 +241,50 @@ SwapChain::createSwapChain()
     vkGetSwapchainImagesKHR(device.device(), swapChain, &imageCount, swapChainImages.data());
 
     swapChainImageFormat = surfaceFormat.format;
+    swapChainImageUsage  = createInfo.imageUsage;
     swapChainExtent      = extent;
 }
 
+void
+SwapChain::createOffscreenImages()
+{
+    // The same format a surface would most likely get, so pipelines behave as they do windowed
+    VkFormat format = device.findSupportedFormat(
+        { VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB },
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+
+    swapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    offscreenMemorys.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < swapChainImages.size(); i++)
+    {
+        VkImageCreateInfo imageInfo = { };
+        imageInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType         = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width      = windowExtent.width;
+        imageInfo.extent.height     = windowExtent.height;
+        imageInfo.extent.depth      = 1;
+        imageInfo.mipLevels         = 1;
+        imageInfo.arrayLayers       = 1;
+        imageInfo.format            = format;
+        imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage             = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.flags             = 0;
+
+        device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, swapChainImages[i], offscreenMemorys[i]);
+    }
+
+    swapChainImageFormat = format;
+    swapChainImageUsage  = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    swapChainExtent      = windowExtent;
+
+    std::cout << "Headless: " << swapChainExtent.width << "x" << swapChainExtent.height << " offscreen" << std::endl;
+}
+
 void
 SwapChain::createImageViews()
 {
@@ -221,15 +308,29 @@ SwapChain::createImageViews()
 }
 
 void
-SwapChain::createRenderPass() {
+SwapChain::createRenderPass()
+{
+    for (size_t i = 0; i < static_cast<size_t>(Pass::Count); i++)
+        renderPasses[i] = createRenderPass(static_cast<Pass>(i));
+}
+
+VkRenderPass
+SwapChain::createRenderPass(Pass pass)
+{
+    // Early and Late only differ from Whole in load and store ops and layouts, so the passes
+    // stay compatible and share framebuffers and pipelines. Anything else differing, even a
+    // dependency, breaks that; the Hi-Z build between them syncs with barriers of its own
+    const bool early = pass == Pass::Early;
+    const bool late  = pass == Pass::Late;
+
     VkAttachmentDescription depthAttachment  = { };
     depthAttachment.format                   = findDepthFormat();
     depthAttachment.samples                  = VK_SAMPLE_COUNT_1_BIT;
-    depthAttachment.loadOp                   = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depthAttachment.storeOp                  = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.loadOp                   = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp                  = early ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
     depthAttachment.stencilLoadOp            = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp           = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout            = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.initialLayout            = late ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
     depthAttachment.finalLayout              = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference depthAttachmentRef = { };
@@ -239,12 +340,12 @@ SwapChain::createRenderPass() {
     VkAttachmentDescription colorAttachment  = { };
     colorAttachment.format                   = getSwapChainImageFormat();
     colorAttachment.samples                  = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp                   = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.loadOp                   = late ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
     colorAttachment.storeOp                  = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilStoreOp           = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.stencilLoadOp            = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.initialLayout            = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout              = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.initialLayout            = late ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+    colorAttachment.finalLayout              = early ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : getFinalLayout();
 
     VkAttachmentReference colorAttachmentRef = { };
     colorAttachmentRef.attachment            = 0;
@@ -256,16 +357,20 @@ SwapChain::createRenderPass() {
     subpass.pColorAttachments                = &colorAttachmentRef;
     subpass.pDepthStencilAttachment          = &depthAttachmentRef;
 
-    VkSubpassDependency dependency           = { };
-    dependency.srcSubpass                    = VK_SUBPASS_EXTERNAL;
-    dependency.srcAccessMask                 = 0;
-    dependency.srcStageMask                  =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstSubpass                    = 0;
-    dependency.dstStageMask                  =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask                 =
+    // The same for every pass: enough for Late to draw over what Early drew, and harmless
+    // for the others, whose attachments start out cleared
+    VkSubpassDependency dependency = { };
+    dependency.srcSubpass          = VK_SUBPASS_EXTERNAL;
+    dependency.srcStageMask        =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.srcAccessMask       =
         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependency.dstSubpass          = 0;
+    dependency.dstStageMask        =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependency.dstAccessMask       =
+        VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
     std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
     VkRenderPassCreateInfo renderPassInfo              = { };
@@ -277,8 +382,12 @@ SwapChain::createRenderPass() {
     renderPassInfo.dependencyCount                     = 1;
     renderPassInfo.pDependencies                       = &dependency;
 
+    VkRenderPass renderPass = nullptr;
     if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
         throw std::runtime_error("failed to create render pass!");
+
+    device.pipelines().addRenderPass(renderPass, renderPassInfo);
+    return renderPass;
 }
 
 void
@@ -292,7 +401,7 @@ SwapChain::createFramebuffers()
         VkExtent2D swapChainExtent              = getSwapChainExtent();
         VkFramebufferCreateInfo framebufferInfo = { };
         framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass              = renderPass;
+        framebufferInfo.renderPass              = getRenderPass();
         framebufferInfo.attachmentCount         = static_cast<uint32_t>(attachments.size());
         framebufferInfo.pAttachments            = attachments.data();
         framebufferInfo.width                   = swapChainExtent.width;
@@ -328,7 +437,7 @@ SwapChain::createDepthResources()
         imageInfo.format            = depthFormat;
         imageInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
         imageInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageInfo.usage             = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        imageInfo.usage             = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
         imageInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
         imageInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.flags             = 0;
@@ -392,30 +501,45 @@ SwapChain::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availa
 VkPresentModeKHR
 SwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
 {
-    for (const auto& availablePresentMode : availablePresentModes)
+    for (const auto& requestedPresentMode : presentModes)
     {
-        if (availablePresentMode == VK_PRESENT_MODE_FIFO_KHR) {
-            std::cout << "Present mode: V-Sync" << std::endl;
-            return availablePresentMode;
-        }
-        //if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-        //{
-        //    std::cout << "Present mode: Mailbox" << std::endl;
-        //    return availablePresentMode;
-        //}
+        if (std::find(availablePresentModes.begin(), availablePresentModes.end(), requestedPresentMode) != availablePresentModes.end())
+            return requestedPresentMode;
     }
 
-    // for (const auto &availablePresentMode : availablePresentModes) {
-    //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-    //     std::cout << "Present mode: Immediate" << std::endl;
-    //     return availablePresentMode;
-    //   }
-    // }
-
-    std::cout << "Present mode: V-Sync" << std::endl;
+    // Always supported
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+std::vector<VkPresentModeKHR>
+SwapChain::getPresentModes(PresentProfile profile)
+{
+    switch (profile)
+    {
+    case PresentProfile::Adaptive:
+        return { VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    case PresentProfile::LowLatency:
+        return { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    case PresentProfile::Uncapped:
+        return { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR };
+    default:
+        return { VK_PRESENT_MODE_FIFO_KHR };
+    }
+}
+
+const char*
+SwapChain::getPresentModeName(VkPresentModeKHR mode)
+{
+    switch (mode)
+    {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:    return "Immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:      return "Mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:         return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO Relaxed";
+    default:                               return "Other";
+    }
+}
+
 VkExtent2D
 SwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
 {
@@ -435,11 +559,20 @@ SwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
     }
 }
 
+VkImageAspectFlags
+SwapChain::getDepthAspect() const
+{
+    if (swapChainDepthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT || swapChainDepthFormat == VK_FORMAT_D24_UNORM_S8_UINT)
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+
+    return VK_IMAGE_ASPECT_DEPTH_BIT;
+}
+
 VkFormat
 SwapChain::findDepthFormat()
 {
     return device.findSupportedFormat(
         { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
         VK_IMAGE_TILING_OPTIMAL,
-        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
 }
\ No newline at end of file
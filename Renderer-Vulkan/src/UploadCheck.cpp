@@ -0,0 +1,214 @@
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <UploadCheck.hpp>
+
+// Where the renderer reads uploaded buffers, the stages UploadManager hands them over to
+static constexpr VkPipelineStageFlags GRAPHICS_READ_STAGES =
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+static constexpr uint8_t SENTINEL = 0xCD;
+
+UploadCheck::UploadCheck(Device& device) :
+    device(device)
+{
+    VkCommandBufferAllocateInfo allocInfo = { };
+    allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool                 = this->device.getCommandPool();
+    allocInfo.commandBufferCount          = 1;
+
+    if (vkAllocateCommandBuffers(this->device.device(), &allocInfo, &this->commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Allocate Upload Check Command Buffer!");
+
+    VkFenceCreateInfo fenceInfo = { };
+    fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    if (vkCreateFence(this->device.device(), &fenceInfo, nullptr, &this->fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Upload Check Fence!");
+
+    this->device.createBuffer(BYTES,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        this->readback,
+        this->readbackMemory);
+}
+
+UploadCheck::~UploadCheck()
+{
+    vkDeviceWaitIdle(this->device.device());
+
+    this->device.destroyBuffer(this->readback, this->readbackMemory);
+    vkDestroyFence(this->device.device(), this->fence, nullptr);
+    vkFreeCommandBuffers(this->device.device(), this->device.getCommandPool(), 1, &this->commandBuffer);
+}
+
+void
+UploadCheck::beginRead()
+{
+    vkResetCommandBuffer(this->commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = { };
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(this->commandBuffer, &beginInfo);
+}
+
+void
+UploadCheck::submitRead(VkBuffer buffer, uint64_t waitValue)
+{
+    // Upload batches and acquires only make their writes visible to the graphics read
+    // stages, so the copy is chained behind those like any draw would be
+    VkMemoryBarrier toTransfer = { };
+    toTransfer.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask   = 0;
+    toTransfer.dstAccessMask   = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(this->commandBuffer, GRAPHICS_READ_STAGES, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &toTransfer, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy region = { };
+    region.size         = BYTES;
+    vkCmdCopyBuffer(this->commandBuffer, buffer, this->readback, 1, &region);
+
+    // The fence makes the copy visible to the host
+    VkMemoryBarrier toHost = { };
+    toHost.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    toHost.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toHost.dstAccessMask   = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(this->commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &toHost, 0, nullptr, 0, nullptr);
+
+    if (vkEndCommandBuffer(this->commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Record Upload Check Command Buffer!");
+
+    const VkSemaphore timeline           = this->device.uploads().timelineSemaphore();
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = { };
+    timelineInfo.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount       = 1;
+    timelineInfo.pWaitSemaphoreValues          = &waitValue;
+
+    VkSubmitInfo submitInfo                    = { };
+    submitInfo.sType                           = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                           = waitValue > 0 ? &timelineInfo : nullptr;
+    submitInfo.waitSemaphoreCount              = waitValue > 0 ? 1 : 0;
+    submitInfo.pWaitSemaphores                 = &timeline;
+    submitInfo.pWaitDstStageMask               = &waitStage;
+    submitInfo.commandBufferCount              = 1;
+    submitInfo.pCommandBuffers                 = &this->commandBuffer;
+
+    if (vkQueueSubmit(this->device.graphicsQueue(), 1, &submitInfo, this->fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Submit Upload Check Command Buffer!");
+}
+
+void
+UploadCheck::round(uint32_t index, bool shared)
+{
+    UploadManager& uploads = this->device.uploads();
+
+    VkBuffer buffer         = nullptr;
+    MemoryAllocation memory = { };
+    this->device.createBuffer(BYTES,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        buffer,
+        memory,
+        shared);
+
+    std::vector<uint32_t> pattern(static_cast<size_t>(BYTES / sizeof(uint32_t)));
+    for (size_t i = 0; i < pattern.size(); i++)
+        pattern[i] = (index + 1) * 0x9E3779B9u ^ static_cast<uint32_t>(i);
+
+    memset(this->readbackMemory.mapped, SENTINEL, static_cast<size_t>(BYTES));
+
+    const UploadTicket ticket = uploads.upload(buffer, 0, pattern.data(), BYTES, !shared);
+
+    if (shared)
+    {
+        // Submitted ahead of its upload, the read may only run once the batch signals. On a
+        // single queue that would wait on a later submission of its own queue, so it is skipped
+        const bool separateQueues = this->device.graphicsQueue() != this->device.transferQueue();
+
+        this->beginRead();
+        if (separateQueues)
+        {
+            this->submitRead(buffer, ticket);
+            std::this_thread::sleep_for(std::chrono::milliseconds(BLOCKED_WAIT));
+
+            this->blockedChecks++;
+            if (vkGetFenceStatus(this->device.device(), this->fence) != VK_NOT_READY)
+                this->early++;
+
+            uploads.flush();
+        }
+        else
+        {
+            uploads.flush();
+            this->submitRead(buffer, ticket);
+        }
+    }
+    else
+    {
+        // A handed over buffer is acquired once its batch is done, then read behind the
+        // value acquire() returns, as a frame would
+        uploads.wait(ticket);
+
+        this->beginRead();
+        this->submitRead(buffer, uploads.acquire(this->commandBuffer));
+    }
+
+    vkWaitForFences(this->device.device(), 1, &this->fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(this->device.device(), 1, &this->fence);
+
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(this->device.device(), uploads.timelineSemaphore(), &value);
+    if (value < ticket)
+        this->early++;
+
+    const uint32_t* read = static_cast<const uint32_t*>(this->readbackMemory.mapped);
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (read[i] == pattern[i])
+            continue;
+
+        this->stale++;
+        this->report += "\tRound " + std::to_string(index) + (shared ? " (shared)" : " (handed over)") +
+            ": word " + std::to_string(i) + " is " + std::to_string(read[i]) +
+            ", expected " + std::to_string(pattern[i]) + "\n";
+        break;
+    }
+
+    this->device.destroyBuffer(buffer, memory);
+}
+
+void
+UploadCheck::run()
+{
+    this->stale         = 0;
+    this->early         = 0;
+    this->blockedChecks = 0;
+    this->report        = "";
+
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        this->round(i, i % 2 == 0);
+}
+
+void
+UploadCheck::print(std::ostream& out) const
+{
+    const bool separateQueues = this->device.graphicsQueue() != this->device.transferQueue();
+
+    out << "Upload ordering check: " << this->device.properties.deviceName << ", " << ROUNDS << " rounds of "
+        << BYTES / 1024 << " KiB, " << (separateQueues ? "separate transfer queue" : "transfer on the graphics queue") << std::endl;
+    out << "\t" << this->stale << " stale reads, " << this->early << " reads before their timeline value";
+
+    if (separateQueues)
+        out << ", " << this->blockedChecks << " reads submitted ahead of their upload";
+
+    out << std::endl << this->report;
+}
\ No newline at end of file
@@ -0,0 +1,478 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+#include <Device.hpp>
+#include <UploadManager.hpp>
+
+// Where uploaded buffers are read on the graphics queue
+static constexpr VkPipelineStageFlags GRAPHICS_READ_STAGES =
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+static constexpr VkAccessFlags GRAPHICS_READ_ACCESS =
+    VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+static VkBufferMemoryBarrier
+ownershipBarrier(VkBuffer buffer, uint32_t srcFamily, uint32_t dstFamily, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+{
+    VkBufferMemoryBarrier barrier = { };
+    barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask         = srcAccess;
+    barrier.dstAccessMask         = dstAccess;
+    barrier.srcQueueFamilyIndex   = srcFamily;
+    barrier.dstQueueFamilyIndex   = dstFamily;
+    barrier.buffer                = buffer;
+    barrier.offset                = 0;
+    barrier.size                  = VK_WHOLE_SIZE;
+
+    return barrier;
+}
+
+static void
+transferBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    VkMemoryBarrier barrier = { };
+    barrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask   = dstAccess;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+UploadManager::UploadManager(Device& device, VkDeviceSize ringSize) :
+    device(device),
+    ringSize(ringSize),
+    transferFamily(device.findPhysicalQueueFamilies().transferFamily),
+    graphicsFamily(device.findPhysicalQueueFamilies().graphicsFamily),
+    ownershipTransfer(transferFamily != graphicsFamily)
+{
+    assert(this->ringSize % STAGING_ALIGN == 0 && "Ring Size Must be a Multiple of STAGING_ALIGN");
+
+    this->device.createBuffer(this->ringSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        this->ringBuffer,
+        this->ringMemory);
+
+    this->ring = static_cast<char*>(this->ringMemory.mapped);
+
+    VkCommandPoolCreateInfo poolInfo = { };
+    poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex        = this->transferFamily;
+    poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+    if (vkCreateCommandPool(this->device.device(), &poolInfo, nullptr, &this->commandPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Upload Command Pool!");
+
+    VkSemaphoreTypeCreateInfo typeInfo = { };
+    typeInfo.sType                     = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue              = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = { };
+    semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext                 = &typeInfo;
+
+    if (vkCreateSemaphore(this->device.device(), &semaphoreInfo, nullptr, &this->timeline) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Create Upload Timeline Semaphore!");
+
+    this->stats.dedicatedQueue = this->ownershipTransfer;
+}
+
+UploadManager::~UploadManager()
+{
+    this->waitIdle();
+
+    // Frees the command buffers with it
+    vkDestroyCommandPool(this->device.device(), this->commandPool, nullptr);
+    vkDestroySemaphore(this->device.device(), this->timeline, nullptr);
+    this->device.destroyBuffer(this->ringBuffer, this->ringMemory);
+}
+
+void
+UploadManager::beginBatch()
+{
+    if (this->open.commandBuffer != nullptr)
+        return;
+
+    if (!this->spare.empty())
+    {
+        this->open = std::move(this->spare.back());
+        this->spare.pop_back();
+    }
+    else
+    {
+        VkCommandBufferAllocateInfo allocInfo = { };
+        allocInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool                 = this->commandPool;
+        allocInfo.commandBufferCount          = 1;
+
+        if (vkAllocateCommandBuffers(this->device.device(), &allocInfo, &this->open.commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("Failed to Allocate Upload Command Buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo = { };
+    beginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(this->open.commandBuffer, &beginInfo);
+    this->open.ticket = this->nextTicket++;
+}
+
+void
+UploadManager::recordPending()
+{
+    if (this->pending.empty())
+        return;
+
+    vkCmdCopyBuffer(this->open.commandBuffer,
+        this->ringBuffer,
+        this->pendingBuffer,
+        static_cast<uint32_t>(this->pending.size()),
+        this->pending.data());
+
+    this->stats.regions += this->pending.size();
+    this->pending.clear();
+    this->pendingBuffer = nullptr;
+}
+
+void
+UploadManager::submitOpen()
+{
+    if (this->open.commandBuffer == nullptr)
+        return;
+
+    this->recordPending();
+
+    if (this->ownershipTransfer)
+    {
+        // Release half of each queue family ownership transfer; acquire() records the other
+        std::vector<VkBufferMemoryBarrier> barriers = { };
+        for (const auto buffer : this->open.handOvers)
+            barriers.push_back(ownershipBarrier(buffer, this->transferFamily, this->graphicsFamily, VK_ACCESS_TRANSFER_WRITE_BIT, 0));
+
+        if (!barriers.empty())
+        {
+            vkCmdPipelineBarrier(this->open.commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0, 0, nullptr,
+                static_cast<uint32_t>(barriers.size()), barriers.data(),
+                0, nullptr);
+        }
+
+        this->stats.ownershipTransfers += barriers.size();
+    }
+    else
+        transferBarrier(this->open.commandBuffer, GRAPHICS_READ_STAGES, GRAPHICS_READ_ACCESS);
+
+    if (vkEndCommandBuffer(this->open.commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Record Upload Command Buffer!");
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo = { };
+    timelineInfo.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount     = 1;
+    timelineInfo.pSignalSemaphoreValues        = &this->open.ticket;
+
+    VkSubmitInfo submitInfo                    = { };
+    submitInfo.sType                           = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext                           = &timelineInfo;
+    submitInfo.commandBufferCount              = 1;
+    submitInfo.pCommandBuffers                 = &this->open.commandBuffer;
+    submitInfo.signalSemaphoreCount            = 1;
+    submitInfo.pSignalSemaphores               = &this->timeline;
+
+    if (vkQueueSubmit(this->device.transferQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("Failed to Submit Upload Command Buffer!");
+
+    this->open.ringEnd = this->head;
+    this->inFlight.push_back(std::move(this->open));
+    this->open         = { };
+    this->stats.batches++;
+}
+
+void
+UploadManager::retire(UploadTicket waitFor)
+{
+    if (waitFor > this->completed)
+    {
+        VkSemaphoreWaitInfo waitInfo = { };
+        waitInfo.sType               = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount      = 1;
+        waitInfo.pSemaphores         = &this->timeline;
+        waitInfo.pValues             = &waitFor;
+
+        vkWaitSemaphores(this->device.device(), &waitInfo, UINT64_MAX);
+    }
+
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(this->device.device(), this->timeline, &value);
+
+    while (!this->inFlight.empty() && this->inFlight.front().ticket <= value)
+    {
+        Batch batch = std::move(this->inFlight.front());
+        this->inFlight.pop_front();
+
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+
+        this->acquirable.insert(this->acquirable.end(), batch.handOvers.begin(), batch.handOvers.end());
+        this->acquirableTicket = batch.ticket;
+        this->tail             = batch.ringEnd;
+        this->completed        = batch.ticket;
+
+        batch.handOvers.clear();
+        this->spare.push_back(std::move(batch));
+    }
+}
+
+VkDeviceSize
+UploadManager::reserve(VkDeviceSize size)
+{
+    size = (size + STAGING_ALIGN - 1) & ~(STAGING_ALIGN - 1);
+    assert(size <= this->ringSize && "Reservation Larger than the Ring");
+
+    while (true)
+    {
+        // A reservation never wraps; the end of the ring is skipped instead
+        const VkDeviceSize offset = this->head % this->ringSize;
+        const VkDeviceSize skip   = offset + size > this->ringSize ? this->ringSize - offset : 0;
+
+        if (this->head + skip + size - this->tail <= this->ringSize)
+        {
+            this->head += skip + size;
+            return (offset + skip) % this->ringSize;
+        }
+
+        // Everything in flight is still in use; the open batch must go first
+        if (this->inFlight.empty())
+        {
+            this->submitOpen();
+            continue;
+        }
+
+        this->stats.stalls++;
+        this->retire(this->inFlight.front().ticket);
+    }
+}
+
+void
+UploadManager::addCopy(VkBuffer dst, VkDeviceSize srcOffset, VkDeviceSize dstOffset, VkDeviceSize size)
+{
+    this->beginBatch();
+
+    if (dst != this->pendingBuffer)
+        this->recordPending();
+
+    this->pendingBuffer = dst;
+
+    if (!this->pending.empty())
+    {
+        VkBufferCopy& last = this->pending.back();
+        if (last.srcOffset + last.size == srcOffset && last.dstOffset + last.size == dstOffset)
+        {
+            last.size += size;
+            return;
+        }
+    }
+
+    VkBufferCopy region = { };
+    region.srcOffset    = srcOffset;
+    region.dstOffset    = dstOffset;
+    region.size         = size;
+    this->pending.push_back(region);
+}
+
+void
+UploadManager::addHandOver(VkBuffer buffer)
+{
+    if (!this->ownershipTransfer)
+        return;
+
+    this->beginBatch();
+
+    // Pieces of one upload land in the same batch back to back
+    if (this->open.handOvers.empty() || this->open.handOvers.back() != buffer)
+        this->open.handOvers.push_back(buffer);
+}
+
+UploadTicket
+UploadManager::upload(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, bool handOver)
+{
+    const char* source = static_cast<const char*>(data);
+
+    return this->upload(dst, dstOffset, size, 1,
+        [source](void* staging, VkDeviceSize offset, VkDeviceSize bytes) { memcpy(staging, source + offset, static_cast<size_t>(bytes)); },
+        handOver);
+}
+
+UploadTicket
+UploadManager::upload(VkBuffer dst, VkDeviceSize dstOffset, VkDeviceSize size, VkDeviceSize stride, const Fill& fill, bool handOver)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    const VkDeviceSize largest = std::max(this->ringSize / 2 / stride, VkDeviceSize(1)) * stride;
+    VkDeviceSize written       = 0;
+    UploadTicket ticket        = 0;
+
+    this->stats.uploads++;
+    this->stats.bytes += size;
+
+    while (written < size)
+    {
+        const VkDeviceSize piece  = std::min(size - written, largest);
+        const VkDeviceSize offset = this->reserve(piece);
+
+        fill(this->ring + offset, written, piece);
+        this->addCopy(dst, offset, dstOffset + written, piece);
+        ticket = this->open.ticket;
+
+        written += piece;
+    }
+
+    // Only once the last piece is in, since a released buffer is no longer the transfer queue's
+    if (handOver && ticket != 0)
+        this->addHandOver(dst);
+
+    return ticket;
+}
+
+UploadTicket
+UploadManager::copy(VkBuffer src, VkBuffer dst, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset, bool handOver)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->beginBatch();
+    this->recordPending();
+
+    VkBufferCopy region = { };
+    region.srcOffset    = srcOffset;
+    region.dstOffset    = dstOffset;
+    region.size         = size;
+
+    // Earlier writes to src land first, and later ones to dst wait for the copy
+    transferBarrier(this->open.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+    vkCmdCopyBuffer(this->open.commandBuffer, src, dst, 1, &region);
+    transferBarrier(this->open.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    this->stats.regions++;
+
+    if (handOver)
+        this->addHandOver(dst);
+
+    return this->open.ticket;
+}
+
+UploadTicket
+UploadManager::handOver(VkBuffer buffer)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->addHandOver(buffer);
+    return this->open.ticket;
+}
+
+UploadTicket
+UploadManager::flush()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->submitOpen();
+    this->retire(0);
+
+    return this->nextTicket - 1;
+}
+
+uint64_t
+UploadManager::acquire(VkCommandBuffer commandBuffer)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->submitOpen();
+    this->retire(0);
+
+    // Same queue as the frame: submission order and the barrier ending each batch suffice
+    if (!this->ownershipTransfer)
+    {
+        this->acquired = this->nextTicket - 1;
+        return 0;
+    }
+
+    // Buffers shared with the transfer family need no acquire, only the timeline wait
+    if (this->completed <= this->acquired)
+        return 0;
+
+    std::vector<VkBufferMemoryBarrier> barriers = { };
+    for (const auto buffer : this->acquirable)
+        barriers.push_back(ownershipBarrier(buffer, this->transferFamily, this->graphicsFamily, 0, GRAPHICS_READ_ACCESS));
+
+    if (!barriers.empty())
+    {
+        // The frame waits on the timeline at vertex input, so the acquire starts from there
+        vkCmdPipelineBarrier(commandBuffer,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            GRAPHICS_READ_STAGES,
+            0, 0, nullptr,
+            static_cast<uint32_t>(barriers.size()), barriers.data(),
+            0, nullptr);
+    }
+
+    this->acquirable.clear();
+    this->acquired = this->completed;
+
+    // Already reached, so the wait only orders the frame after the batches' writes
+    return this->acquired;
+}
+
+bool
+UploadManager::isAcquired(UploadTicket ticket)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return ticket <= this->acquired;
+}
+
+bool
+UploadManager::isComplete(UploadTicket ticket)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    if (ticket <= this->completed)
+        return true;
+
+    if (ticket == this->open.ticket)
+        this->submitOpen();
+
+    this->retire(0);
+    return ticket <= this->completed;
+}
+
+void
+UploadManager::wait(UploadTicket ticket)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    if (ticket <= this->completed)
+        return;
+
+    if (ticket == this->open.ticket)
+        this->submitOpen();
+
+    this->stats.waits++;
+    this->retire(ticket);
+}
+
+void
+UploadManager::waitIdle()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    this->submitOpen();
+    this->retire(this->nextTicket - 1);
+}
+
+UploadStats
+UploadManager::getStats()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include <cassert>
+
+#include <Utilities.hpp>
+#include <VertexWelder.hpp>
+
+static size_t
+tableCapacity(size_t count)
+{
+    // Keep linear probing at or below half load
+    size_t capacity = 64;
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    return capacity;
+}
+
+VertexWelder::VertexWelder(std::vector<Model::Vertex>& vertices, size_t expectedVertices) :
+    vertices(&vertices)
+{
+    assert(this->vertices->empty() && "Welded Vertices Must Start Out Empty");
+
+    this->sourceSlots.resize(tableCapacity(expectedVertices));
+    this->vertexSlots.resize(tableCapacity(expectedVertices));
+}
+
+VertexWelder::VertexWelder(size_t expectedVertices)
+{
+    this->sourceSlots.resize(tableCapacity(expectedVertices));
+}
+
+uint64_t
+VertexWelder::hashSource(const SourceKey& key)
+{
+    return hashBytes(&key, sizeof(SourceKey));
+}
+
+uint64_t
+VertexWelder::hashVertex(const Model::Vertex& vertex)
+{
+    // Adding 0.0f folds -0.0f into 0.0f, which compare equal in Vertex::operator==
+    const float values[] = {
+        vertex.position.x + 0.0f, vertex.position.y + 0.0f, vertex.position.z + 0.0f,
+        vertex.color.x    + 0.0f, vertex.color.y    + 0.0f, vertex.color.z    + 0.0f,
+        vertex.normal.x   + 0.0f, vertex.normal.y   + 0.0f, vertex.normal.z   + 0.0f,
+        vertex.uv.x       + 0.0f, vertex.uv.y       + 0.0f,
+    };
+
+    return hashBytes(values, sizeof(values));
+}
+
+uint32_t
+VertexWelder::find(const SourceKey& key) const
+{
+    const size_t mask = this->sourceSlots.size() - 1;
+    for (size_t slot = hashSource(key) & mask; ; slot = (slot + 1) & mask)
+    {
+        const SourceSlot& entry = this->sourceSlots[slot];
+        if (entry.index == NOT_FOUND)
+            return NOT_FOUND;
+
+        if (entry.key.vertexIndex   == key.vertexIndex   &&
+            entry.key.normalIndex   == key.normalIndex   &&
+            entry.key.texcoordIndex == key.texcoordIndex &&
+            entry.key.group         == key.group)
+            return entry.index;
+    }
+}
+
+uint32_t
+VertexWelder::weld(const SourceKey& key, const Model::Vertex& vertex)
+{
+    assert(this->vertices != nullptr && "Welding by Value Needs a Vertex Array");
+
+    const uint64_t hash = hashVertex(vertex);
+    const size_t mask   = this->vertexSlots.size() - 1;
+
+    size_t slot = hash & mask;
+    for (; this->vertexSlots[slot].index != NOT_FOUND; slot = (slot + 1) & mask)
+    {
+        const VertexSlot& entry = this->vertexSlots[slot];
+        if (entry.hash == static_cast<uint32_t>(hash >> 32) && (*this->vertices)[entry.index] == vertex)
+        {
+            this->insert(key, entry.index);
+            return entry.index;
+        }
+    }
+
+    const uint32_t index          = static_cast<uint32_t>(this->vertices->size());
+    this->vertexSlots[slot].hash  = static_cast<uint32_t>(hash >> 32);
+    this->vertexSlots[slot].index = index;
+    this->vertices->push_back(vertex);
+
+    if (this->vertices->size() * 2 > this->vertexSlots.size())
+        this->rehashVertices(this->vertexSlots.size() * 2);
+
+    this->insert(key, index);
+    return index;
+}
+
+void
+VertexWelder::insert(const SourceKey& key, uint32_t index)
+{
+    const size_t mask = this->sourceSlots.size() - 1;
+
+    size_t slot = hashSource(key) & mask;
+    while (this->sourceSlots[slot].index != NOT_FOUND)
+        slot = (slot + 1) & mask;
+
+    this->sourceSlots[slot].key   = key;
+    this->sourceSlots[slot].index = index;
+
+    if (++this->sourceCount * 2 > this->sourceSlots.size())
+        this->rehashSource(this->sourceSlots.size() * 2);
+}
+
+void
+VertexWelder::rehashSource(size_t capacity)
+{
+    std::vector<SourceSlot> previous = std::move(this->sourceSlots);
+    this->sourceSlots.assign(capacity, SourceSlot());
+
+    const size_t mask = capacity - 1;
+    for (const auto& entry : previous)
+    {
+        if (entry.index == NOT_FOUND)
+            continue;
+
+        size_t slot = hashSource(entry.key) & mask;
+        while (this->sourceSlots[slot].index != NOT_FOUND)
+            slot = (slot + 1) & mask;
+
+        this->sourceSlots[slot] = entry;
+    }
+}
+
+void
+VertexWelder::rehashVertices(size_t capacity)
+{
+    std::vector<VertexSlot> previous = std::move(this->vertexSlots);
+    this->vertexSlots.assign(capacity, VertexSlot());
+
+    // Only the upper half of the hash is kept as a tag, so re-derive the slot from the vertex
+    const size_t mask = capacity - 1;
+    for (const auto& entry : previous)
+    {
+        if (entry.index == NOT_FOUND)
+            continue;
+
+        const uint64_t hash = hashVertex((*this->vertices)[entry.index]);
+
+        size_t slot = hash & mask;
+        while (this->vertexSlots[slot].index != NOT_FOUND)
+            slot = (slot + 1) & mask;
+
+        this->vertexSlots[slot].hash  = static_cast<uint32_t>(hash >> 32);
+        this->vertexSlots[slot].index = entry.index;
+    }
+}
\ No newline at end of file
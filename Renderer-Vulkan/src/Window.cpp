@@ -11,9 +11,18 @@ void Window::frameBufferResizedCallback(GLFWwindow* window_, int width, int heig
     window->height             = height;
 }
 
-Window::Window(const uint32_t& width, const uint32_t& height, const std::string& name) :
-    width(width), height(height), name(name)
+Window::Window(const uint32_t& width, const uint32_t& height, const std::string& name, bool headless) :
+    width(width), height(height), name(name), headless(headless)
 {
+    // Without a display glfwInit fails, so headless never touches GLFW
+    if (this->headless)
+    {
+        if (this->width == 0 || this->height == 0)
+            throw std::runtime_error("Headless Extent Must not be Empty!");
+
+        return;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -25,6 +34,9 @@ Window::Window(const uint32_t& width, const uint32_t& height, const std::string&
 
 Window::~Window()
 {
+    if (this->headless)
+        return;
+
     glfwDestroyWindow(this->window);
     glfwTerminate();
 }
@@ -32,7 +44,14 @@ Window::~Window()
 bool
 Window::shouldClose()
 {
-    return glfwWindowShouldClose(this->window);
+    return !this->headless && glfwWindowShouldClose(this->window);
+}
+
+void
+Window::pollEvents()
+{
+    if (!this->headless)
+        glfwPollEvents();
 }
 
 void
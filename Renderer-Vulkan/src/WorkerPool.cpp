@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cassert>
+
+#include <WorkerPool.hpp>
+
+WorkerPool::WorkerPool(uint32_t workerCount)
+{
+    if (workerCount == 0)
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (uint32_t worker = 1; worker < workerCount; worker++)
+        this->threads.emplace_back(&WorkerPool::work, this, worker);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+
+    this->started.notify_all();
+    for (auto& thread : this->threads)
+        thread.join();
+}
+
+void
+WorkerPool::work(uint32_t worker)
+{
+    uint64_t seen = 0;
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true)
+    {
+        this->started.wait(lock, [&]() { return this->stopping || this->generation != seen || !this->tasks.empty(); });
+
+        // A packaged_task, which keeps what it throws for its future
+        if (!this->tasks.empty())
+        {
+            std::function<void()> task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+            continue;
+        }
+
+        if (this->stopping)
+            return;
+
+        // Left out of this run
+        seen = this->generation;
+        if (worker >= this->jobCount)
+            continue;
+
+        const auto& job = *this->job;
+        lock.unlock();
+
+        std::exception_ptr thrown = nullptr;
+        try
+        {
+            job(worker);
+        }
+        catch (...)
+        {
+            thrown = std::current_exception();
+        }
+
+        lock.lock();
+        if (thrown != nullptr && this->error == nullptr)
+            this->error = thrown;
+
+        if (--this->pending == 0)
+            this->finished.notify_one();
+    }
+}
+
+void
+WorkerPool::enqueue(std::function<void()> task)
+{
+    if (this->threads.empty())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push_back(std::move(task));
+    }
+
+    this->started.notify_one();
+}
+
+void
+WorkerPool::run(uint32_t jobCount, const std::function<void(uint32_t)>& job)
+{
+    assert(jobCount <= this->getWorkerCount() && "More Jobs than Workers");
+    if (jobCount == 0)
+        return;
+
+    if (jobCount > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->job      = &job;
+            this->jobCount = jobCount;
+            this->pending  = jobCount - 1;
+            this->error    = nullptr;
+            this->generation++;
+        }
+
+        this->started.notify_all();
+    }
+
+    std::exception_ptr thrown = nullptr;
+    try
+    {
+        job(0);
+    }
+    catch (...)
+    {
+        thrown = std::current_exception();
+    }
+
+    if (jobCount > 1)
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->finished.wait(lock, [&]() { return this->pending == 0; });
+
+        if (thrown == nullptr)
+            thrown = this->error;
+    }
+
+    if (thrown != nullptr)
+        std::rethrow_exception(thrown);
+}
\ No newline at end of file